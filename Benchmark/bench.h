@@ -0,0 +1,26 @@
+#ifndef BENCHMARK_BENCH_H
+#define BENCHMARK_BENCH_H
+
+#include <chrono>
+#include <cstdio>
+
+// build: g++ -std=c++17 -O2 -pthread <name>.cpp -o <name>
+
+// defeat dead code elimination of benchmark results
+template <typename T>
+inline void do_not_optimize(const T& value){
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// run f once and print the elapsed time in milliseconds
+template <typename F>
+double bench(const char* name, F f){
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    std::printf("%-48s %10.2f ms\n", name, ms);
+    return ms;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include "bench.h"
+#include "../TinySTL/concurrent_ordered_map.h"
+#include "../TinySTL/map.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+const int kRoutes = 100000;
+const int kLookupsPerReader = 1000000;
+// far more often than a routing table changes, so the writer is not idle during the run
+const auto kWritePeriod = std::chrono::milliseconds(1);
+
+struct rwlock_map{
+    mutable std::shared_mutex m;
+    hstl::map<long long, long long> map;
+
+    bool find(long long k, long long& v) const{
+        std::shared_lock<std::shared_mutex> lock(m);
+        auto it = map.find(k);
+        if(it == map.end()){
+            return false;
+        }
+        v = it->second;
+        return true;
+    }
+    void insert_or_assign(long long k, long long v){
+        std::unique_lock<std::shared_mutex> lock(m);
+        map[k] = v;
+    }
+};
+
+struct lock_free_map{
+    hstl::concurrent_ordered_map<long long, long long> map;
+
+    bool find(long long k, long long& v) const{ return map.find(k, v); }
+    void insert_or_assign(long long k, long long v){ map.insert_or_assign(k, v); }
+};
+
+// readers do kLookupsPerReader lookups each while one writer updates a route every
+// kWritePeriod; returns million lookups per second over all readers
+template <typename Map>
+double run(int readers, int& writes){
+    Map m;
+    for(int k = 0; k < kRoutes; ++k){
+        m.insert_or_assign(2 * k, k);
+    }
+    std::atomic<bool> done(false);
+    std::atomic<long long> hits(0);
+    writes = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::thread writer([&]{
+        std::mt19937_64 gen(49);
+        while(!done.load(std::memory_order_relaxed)){
+            m.insert_or_assign(static_cast<long long>(gen() % (2 * kRoutes)), writes);
+            ++writes;
+            std::this_thread::sleep_for(kWritePeriod);
+        }
+    });
+    std::vector<std::thread> pool;
+    for(int r = 0; r < readers; ++r){
+        pool.emplace_back([&, r]{
+            std::mt19937_64 gen(r);
+            long long local = 0, v = 0;
+            for(int i = 0; i < kLookupsPerReader; ++i){
+                local += m.find(static_cast<long long>(gen() % (2 * kRoutes)), v);
+            }
+            hits += local;
+        });
+    }
+    for(auto& t : pool){
+        t.join();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    done = true;
+    writer.join();
+    do_not_optimize(hits.load());
+    const double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    return static_cast<double>(readers) * kLookupsPerReader / ms / 1000.0;
+}
+
+int main(){
+    std::printf("%8s %22s %22s   (%u hardware threads)\n", "readers", "concurrent Mlookup/s", "shared_mutex Mlookup/s",
+        std::thread::hardware_concurrency());
+    for(int readers = 1; readers <= 64; readers *= 2){
+        int lock_free_writes = 0, locked_writes = 0;
+        double lock_free = run<lock_free_map>(readers, lock_free_writes);
+        double locked = run<rwlock_map>(readers, locked_writes);
+        std::printf("%8d %22.2f %22.2f   (%d / %d writes)\n", readers, lock_free, locked, lock_free_writes, locked_writes);
+    }
+    return 0;
+}
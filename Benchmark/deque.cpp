@@ -0,0 +1,97 @@
+#include "bench.h"
+#include "../TinySTL/deque.h"
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+// count calls into the global allocator. The replacements are kept out of line: inlined,
+// gcc sees the malloc in new and the free in delete at one call site and flags the pair
+// with -Wmismatched-new-delete although they match
+static std::size_t g_allocs = 0;
+
+__attribute__((noinline)) void* operator new(std::size_t n){
+    ++g_allocs;
+    if(void* p = std::malloc(n)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept{ std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept{ std::free(p); }
+
+const int kWindow = 1000;
+const int kOps = 20000000;
+
+// steady-state queue: a fixed-size window slides through the deque
+template <typename Deque>
+void steady_queue(const char* name){
+    Deque d;
+    for(int i = 0; i < kWindow; ++i){
+        d.push_back(i);
+    }
+    std::size_t allocs = g_allocs;
+    long long sum = 0;
+    bench(name, [&]{
+        for(int i = 0; i < kOps; ++i){
+            d.push_back(i);
+            sum += d.front();
+            d.pop_front();
+        }
+    });
+    do_not_optimize(sum);
+    std::printf("%-48s %10zu allocations\n", "", g_allocs - allocs);
+}
+
+// push/pop pairs straddling a buffer boundary
+template <typename Deque>
+void boundary_ping_pong(const char* name){
+    Deque d;
+    while(d.size() < 4095){
+        d.push_back(0);
+    }
+    std::size_t allocs = g_allocs;
+    bench(name, [&]{
+        for(int i = 0; i < kOps; ++i){
+            d.push_back(i);
+            d.push_back(i);
+            d.pop_back();
+            d.pop_back();
+        }
+    });
+    do_not_optimize(d.size());
+    std::printf("%-48s %10zu allocations\n", "", g_allocs - allocs);
+}
+
+// std:: algorithms step the deque iterator element by element, hstl:: ones walk buffers
+void segmented_algorithms(){
+    const int n = 50000000;
+    hstl::deque<int> d;
+    for(int i = 0; i < n; ++i){
+        d.push_back(i);
+    }
+    std::vector<int> src(n, 1), out(n);
+    bench("std::copy over hstl::deque", [&]{ std::copy(d.begin(), d.end(), out.begin()); });
+    bench("hstl::copy over hstl::deque", [&]{ hstl::copy(d.begin(), d.end(), out.begin()); });
+    bench("std::copy over std::vector", [&]{ std::copy(src.begin(), src.end(), out.begin()); });
+    bench("std::find over hstl::deque", [&]{ do_not_optimize(*std::find(d.begin(), d.end(), n - 1)); });
+    bench("hstl::find over hstl::deque", [&]{ do_not_optimize(*hstl::find(d.begin(), d.end(), n - 1)); });
+    long long sum = 0;
+    bench("std::for_each over hstl::deque", [&]{ std::for_each(d.begin(), d.end(), [&](int x){ sum += x; }); });
+    bench("hstl::for_each over hstl::deque", [&]{ hstl::for_each(d.begin(), d.end(), [&](int x){ sum += x; }); });
+    bench("std::fill over hstl::deque", [&]{ std::fill(d.begin(), d.end(), 1); });
+    bench("hstl::fill over hstl::deque", [&]{ hstl::fill(d.begin(), d.end(), 2); });
+    do_not_optimize(sum);
+    do_not_optimize(out[n / 2]);
+}
+
+int main(){
+    steady_queue<hstl::deque<int>>("hstl::deque steady queue");
+    steady_queue<hstl::deque<int, 64>>("hstl::deque<int, 64> steady queue");
+    steady_queue<std::deque<int>>("std::deque steady queue");
+    boundary_ping_pong<hstl::deque<int>>("hstl::deque boundary ping-pong");
+    boundary_ping_pong<std::deque<int>>("std::deque boundary ping-pong");
+    segmented_algorithms();
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "bench.h"
+#include "../TinySTL/heap.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+const int kElements = 10000000;
+
+std::vector<int> random_keys(){
+    std::mt19937 gen(42);
+    std::vector<int> keys(kElements);
+    for(int& k : keys){
+        k = static_cast<int>(gen());
+    }
+    return keys;
+}
+
+// the heap lives in storage placed so that first + 1 starts a cache line plus skew elements:
+// with skew 0 every d-ary child group of a power-of-two size up to a line sits in one line
+int* place_heap(std::vector<int>& storage, std::size_t skew){
+    storage.assign(kElements + 64, 0);
+    int* first = storage.data();
+    while(reinterpret_cast<std::uintptr_t>(first + 1) % 64 != 0){
+        ++first;
+    }
+    return first + skew;
+}
+
+// push every key, then pop them all, then run a pop / push mix at full size; PushHeap / PopHeap are the binary or d-ary functions
+template <typename PushHeap, typename PopHeap>
+void push_pop(const char* name, const std::vector<int>& keys, std::size_t skew, PushHeap push, PopHeap pop){
+    std::vector<int> storage;
+    int* const first = place_heap(storage, skew);
+    int* const last = first + keys.size();
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%s push 10M", name);
+    bench(buf, [&]{
+        int* end = first;
+        for(int k : keys){
+            *end++ = k;
+            push(first, end);
+        }
+    });
+    std::snprintf(buf, sizeof(buf), "%s pop 10M", name);
+    bench(buf, [&]{
+        for(int* end = last; end != first; --end){
+            pop(first, end);
+        }
+    });
+    do_not_optimize(*first);
+
+    // steady state of a priority queue: pop the top and push a new key, size stays at 10M
+    std::copy(keys.begin(), keys.end(), first);
+    for(int* end = first + 1; end <= last; ++end){
+        push(first, end);
+    }
+    std::snprintf(buf, sizeof(buf), "%s pop+push 10M", name);
+    bench(buf, [&]{
+        unsigned x = 12345;
+        for(int i = 0; i < kElements; ++i){
+            pop(first, last);
+            x = x * 1664525u + 1013904223u;
+            *(last - 1) = static_cast<int>(x);
+            push(first, last);
+        }
+    });
+    do_not_optimize(*first);
+}
+
+int main(){
+    const std::vector<int> keys = random_keys();
+    typedef int* iter;
+    push_pop("std binary", keys, 0,
+        [](iter f, iter l){ std::push_heap(f, l); }, [](iter f, iter l){ std::pop_heap(f, l); });
+    push_pop("hstl binary", keys, 0,
+        [](iter f, iter l){ hstl::push_heap(f, l); }, [](iter f, iter l){ hstl::pop_heap(f, l); });
+    push_pop("hstl 4-ary", keys, 0,
+        [](iter f, iter l){ hstl::dary_push_heap<4>(f, l); }, [](iter f, iter l){ hstl::dary_pop_heap<4>(f, l); });
+    push_pop("hstl 8-ary", keys, 0,
+        [](iter f, iter l){ hstl::dary_push_heap<8>(f, l); }, [](iter f, iter l){ hstl::dary_pop_heap<8>(f, l); });
+    push_pop("hstl 4-ary min-heap", keys, 0,
+        [](iter f, iter l){ hstl::dary_push_heap<4>(f, l, std::greater<int>()); },
+        [](iter f, iter l){ hstl::dary_pop_heap<4>(f, l, std::greater<int>()); });
+    // groups moved off the line boundary: one in four 4-ary groups and one in two 8-ary
+    // groups straddle two lines
+    push_pop("hstl 4-ary misaligned", keys, 2,
+        [](iter f, iter l){ hstl::dary_push_heap<4>(f, l); }, [](iter f, iter l){ hstl::dary_pop_heap<4>(f, l); });
+    push_pop("hstl 8-ary misaligned", keys, 4,
+        [](iter f, iter l){ hstl::dary_push_heap<8>(f, l); }, [](iter f, iter l){ hstl::dary_pop_heap<8>(f, l); });
+    return 0;
+}
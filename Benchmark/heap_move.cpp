@@ -0,0 +1,140 @@
+#include "bench.h"
+#include "../TinySTL/heap.h"
+#include <random>
+#include <string>
+#include <vector>
+
+// the heap core before it moved elements: value by value and a copy per level
+namespace copying{
+
+template <class RandomAccessIterator, class Distance, class T>
+void push_heap(RandomAccessIterator first, Distance holeIndex, Distance topIndex, T value){
+    Distance parent = (holeIndex - 1) / 2;
+    while(holeIndex > topIndex && *(first + parent) < value){
+        *(first + holeIndex) = *(first + parent);
+        holeIndex = parent;
+        parent = (holeIndex - 1) / 2;
+    }
+    *(first + holeIndex) = value;
+}
+
+template <class RandomAccessIterator, class Distance, class T>
+void adjust_heap(RandomAccessIterator first, Distance holeIndex, Distance len, T value){
+    Distance topIndex = holeIndex;
+    Distance secondChild = 2 * holeIndex + 2;
+    while(secondChild < len){
+        if(*(first + secondChild) < *(first + (secondChild - 1))){
+            secondChild--;
+        }
+        *(first + holeIndex) = *(first + secondChild);
+        holeIndex = secondChild;
+        secondChild = 2 * (secondChild + 1);
+    }
+    if(secondChild == len){
+        *(first + holeIndex) = *(first + (secondChild - 1));
+        holeIndex = secondChild - 1;
+    }
+    copying::push_heap(first, holeIndex, topIndex, value);
+}
+
+template <class RandomAccessIterator>
+void push_heap(RandomAccessIterator first, RandomAccessIterator last){
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type Distance;
+    copying::push_heap(first, Distance((last - first) - 1), Distance(0), T(*(last - 1)));
+}
+
+template <class RandomAccessIterator>
+void pop_heap(RandomAccessIterator first, RandomAccessIterator last){
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type Distance;
+    T value(*(last - 1));
+    *(last - 1) = *first;
+    copying::adjust_heap(first, Distance(0), Distance((last - first) - 1), value);
+}
+
+}
+
+// textbook pop: sift value down from the root, two comparisons per level
+namespace top_down{
+
+template <class RandomAccessIterator, class Compare>
+void pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type Distance;
+    T value = std::move(*(last - 1));
+    *(last - 1) = std::move(*first);
+    const Distance len = (last - first) - 1;
+    Distance hole = 0;
+    for(Distance child = 1; child < len; child = 2 * hole + 1){
+        if(child + 1 < len && comp(*(first + child), *(first + (child + 1)))){
+            ++child;
+        }
+        if(!comp(value, *(first + child))){
+            break;
+        }
+        *(first + hole) = std::move(*(first + child));
+        hole = child;
+    }
+    *(first + hole) = std::move(value);
+}
+
+}
+
+const int kElements = 1000000;
+
+struct counting_less{
+    long long* count;
+    bool operator()(const std::string& a, const std::string& b) const { ++*count; return a < b; }
+};
+
+int main(){
+    std::mt19937 gen(7);
+    std::vector<std::string> keys(kElements);
+    for(std::string& k : keys){
+        // long enough to defeat the small string buffer
+        k = "key-" + std::to_string(gen()) + "-padding-padding";
+    }
+
+    std::vector<std::string> heap;
+    heap.reserve(kElements);
+    bench("copying push+pop 1M strings", [&]{
+        for(const std::string& k : keys){
+            heap.push_back(k);
+            copying::push_heap(heap.begin(), heap.end());
+        }
+        for(auto last = heap.end(); last - heap.begin() > 1; --last){
+            copying::pop_heap(heap.begin(), last);
+        }
+    });
+    do_not_optimize(heap.front());
+    heap.clear();
+    bench("moving push+pop 1M strings", [&]{
+        for(const std::string& k : keys){
+            heap.push_back(k);
+            hstl::push_heap(heap.begin(), heap.end());
+        }
+        for(auto last = heap.end(); last - heap.begin() > 1; --last){
+            hstl::pop_heap(heap.begin(), last);
+        }
+    });
+    do_not_optimize(heap.front());
+
+    long long floyd = 0, classic = 0;
+    heap.assign(keys.begin(), keys.end());
+    hstl::make_heap(heap.begin(), heap.end());
+    bench("bottom-up pop 1M strings", [&]{
+        for(auto last = heap.end(); last - heap.begin() > 1; --last){
+            hstl::pop_heap(heap.begin(), last, counting_less{&floyd});
+        }
+    });
+    heap.assign(keys.begin(), keys.end());
+    hstl::make_heap(heap.begin(), heap.end());
+    bench("top-down pop 1M strings", [&]{
+        for(auto last = heap.end(); last - heap.begin() > 1; --last){
+            top_down::pop_heap(heap.begin(), last, counting_less{&classic});
+        }
+    });
+    std::printf("comparisons: bottom-up %lld, top-down %lld\n", floyd, classic);
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "bench.h"
+#include "../TinySTL/heap.h"
+#include "../TinySTL/parallel_heap.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+const int kElements = 50000000;
+const int kTop = 1000;
+
+int main(){
+    std::mt19937 gen(1);
+    std::vector<unsigned> data(kElements);
+    for(unsigned& x : data){
+        x = gen();
+    }
+    std::vector<unsigned> top(kTop);
+
+    // top 1000 of 50M
+    bench("hstl::top_k, bounded heap", [&]{
+        hstl::top_k(data.begin(), data.end(), top.begin(), top.end());
+    });
+    do_not_optimize(top[0]);
+    {
+        std::vector<unsigned> v = data;
+        bench("hstl::partial_sort", [&]{
+            hstl::partial_sort(v.begin(), v.begin() + kTop, v.end(), std::greater<unsigned>());
+        });
+        do_not_optimize(v[0]);
+    }
+    {
+        std::vector<unsigned> v = data;
+        bench("std::partial_sort", [&]{
+            std::partial_sort(v.begin(), v.begin() + kTop, v.end(), std::greater<unsigned>());
+        });
+        do_not_optimize(v[0]);
+    }
+    {
+        std::vector<unsigned> v = data;
+        bench("hstl::nth_element + sort of the top", [&]{
+            hstl::nth_element(v.begin(), v.begin() + kTop, v.end(), std::greater<unsigned>());
+            std::sort(v.begin(), v.begin() + kTop, std::greater<unsigned>());
+        });
+        do_not_optimize(v[0]);
+    }
+    {
+        std::vector<unsigned> v = data;
+        bench("std::nth_element + sort of the top", [&]{
+            std::nth_element(v.begin(), v.begin() + kTop, v.end(), std::greater<unsigned>());
+            std::sort(v.begin(), v.begin() + kTop, std::greater<unsigned>());
+        });
+        do_not_optimize(v[0]);
+    }
+
+    const unsigned hw = std::thread::hardware_concurrency();
+    hstl::thread_pool pool(hw == 0 ? 1 : hw);
+    std::printf("pool of %u threads\n", static_cast<unsigned>(pool.size()));
+    bench("hstl::parallel_top_k", [&]{
+        hstl::parallel_top_k(pool, data.begin(), data.end(), top.begin(), top.end());
+    });
+    do_not_optimize(top[0]);
+    {
+        std::vector<unsigned> v = data;
+        bench("hstl::make_heap 50M", [&]{
+            hstl::make_heap(v.begin(), v.end());
+        });
+        do_not_optimize(v[0]);
+    }
+    {
+        std::vector<unsigned> v = data;
+        bench("hstl::parallel_make_heap 50M", [&]{
+            hstl::parallel_make_heap(pool, v.begin(), v.end());
+        });
+        do_not_optimize(v[0]);
+    }
+    return 0;
+}
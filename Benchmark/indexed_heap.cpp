@@ -0,0 +1,103 @@
+#include "bench.h"
+#include "../TinySTL/indexed_heap.h"
+#include "../TinySTL/heap.h"
+#include "../TinySTL/vector.h"
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+const int kVertices = 1000000;
+const int kDegree = 8;
+const long long kInf = -1ULL >> 1;
+
+// compressed adjacency of a random directed graph
+struct graph{
+    std::vector<int> offset;
+    std::vector<int> target;
+    std::vector<int> weight;
+};
+
+graph random_graph(){
+    std::mt19937 gen(11);
+    graph g;
+    g.offset.resize(kVertices + 1);
+    for(int v = 0; v < kVertices; ++v){
+        g.offset[v] = v * kDegree;
+        for(int e = 0; e < kDegree; ++e){
+            g.target.push_back(static_cast<int>(gen() % kVertices));
+            g.weight.push_back(static_cast<int>(gen() % 1000) + 1);
+        }
+    }
+    g.offset[kVertices] = kVertices * kDegree;
+    return g;
+}
+
+template <std::size_t D>
+long long dijkstra_indexed(const graph& g){
+    std::vector<long long> dist(kVertices, kInf);
+    hstl::indexed_heap<int, long long, std::less<long long>, D> h(kVertices);
+    dist[0] = 0;
+    h.push(0, 0);
+    while(!h.empty()){
+        const int u = h.top_key();
+        h.pop();
+        for(int e = g.offset[u]; e < g.offset[u + 1]; ++e){
+            const int v = g.target[e];
+            const long long d = dist[u] + g.weight[e];
+            if(d < dist[v]){
+                dist[v] = d;
+                h.push_or_decrease(v, d);
+            }
+        }
+    }
+    long long sum = 0;
+    for(long long d : dist){
+        sum += d == kInf ? 0 : d;
+    }
+    return sum;
+}
+
+// the usual workaround: push duplicates and skip the stale ones on pop
+long long dijkstra_lazy(const graph& g){
+    typedef std::pair<long long, int> item;
+    std::vector<long long> dist(kVertices, kInf);
+    hstl::vector<item> heap;
+    std::greater<item> comp;
+    dist[0] = 0;
+    heap.push_back(item(0, 0));
+    while(!heap.empty()){
+        hstl::pop_heap(heap.begin(), heap.end(), comp);
+        const item top = *(heap.end() - 1);
+        heap.pop_back();
+        const int u = top.second;
+        if(top.first != dist[u]){
+            continue;
+        }
+        for(int e = g.offset[u]; e < g.offset[u + 1]; ++e){
+            const int v = g.target[e];
+            const long long d = dist[u] + g.weight[e];
+            if(d < dist[v]){
+                dist[v] = d;
+                heap.push_back(item(d, v));
+                hstl::push_heap(heap.begin(), heap.end(), comp);
+            }
+        }
+    }
+    long long sum = 0;
+    for(long long d : dist){
+        sum += d == kInf ? 0 : d;
+    }
+    return sum;
+}
+
+int main(){
+    const graph g = random_graph();
+    long long a = 0, b = 0, c = 0, d = 0;
+    bench("dijkstra, lazy binary heap", [&]{ a = dijkstra_lazy(g); });
+    bench("dijkstra, indexed_heap D=2", [&]{ b = dijkstra_indexed<2>(g); });
+    bench("dijkstra, indexed_heap D=4", [&]{ c = dijkstra_indexed<4>(g); });
+    bench("dijkstra, indexed_heap D=8", [&]{ d = dijkstra_indexed<8>(g); });
+    std::printf("checksums %s\n", a == b && b == c && c == d ? "match" : "DIFFER");
+    return 0;
+}
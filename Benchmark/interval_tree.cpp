@@ -0,0 +1,95 @@
+#include "bench.h"
+#include "../TinySTL/interval_tree.h"
+#include "../TinySTL/rb_tree.h"
+#include <functional>
+#include <random>
+#include <vector>
+
+const int kIntervals = 1000000;
+const int kQueries = 2000;
+const int kSpace = 100000000;
+
+struct sum_monoid{
+    typedef long long summary_type;
+
+    static summary_type identity(){ return 0; }
+    static summary_type lift(int x){ return x; }
+    static summary_type combine(summary_type a, summary_type b){ return a + b; }
+};
+
+// counts what is written to it
+struct counter{
+    long long* n;
+
+    counter& operator*(){ return *this; }
+    counter& operator++(){ return *this; }
+    template <typename T>
+    counter& operator=(const T&){ ++*n; return *this; }
+};
+
+int main(){
+    std::mt19937 gen(46);
+    std::vector<hstl::interval<int>> all;
+    for(int i = 0; i < kIntervals; ++i){
+        int lo = static_cast<int>(gen() % kSpace);
+        // mostly short, a few long ones
+        int len = i % 100 == 0 ? static_cast<int>(gen() % 1000000) : static_cast<int>(gen() % 1000);
+        all.push_back(hstl::interval<int>(lo, lo + len));
+    }
+    std::vector<int> points(kQueries);
+    for(int& p : points){
+        p = static_cast<int>(gen() % kSpace);
+    }
+
+    hstl::interval_tree<int> tree;
+    bench("interval_tree insert, 1M intervals", [&]{
+        for(const auto& x : all){
+            tree.insert(x);
+        }
+    });
+    long long tree_hits = 0;
+    bench("interval_tree stab, 2k queries", [&]{
+        counter out{&tree_hits};
+        for(int p : points){
+            tree.stab(p, out);
+        }
+        do_not_optimize(tree_hits);
+    });
+    long long scan_hits = 0;
+    bench("linear scan stab, 2k queries", [&]{
+        for(int p : points){
+            for(const auto& x : all){
+                scan_hits += x.low <= p && p <= x.high;
+            }
+        }
+        do_not_optimize(scan_hits);
+    });
+    std::printf("hits: tree %lld, scan %lld\n", tree_hits, scan_hits);
+
+    // range sums over keys
+    std::vector<int> keys(kIntervals);
+    for(int& k : keys){
+        k = static_cast<int>(gen() % kSpace);
+    }
+    hstl::rb_tree<int, std::less<int>, hstl::identity<int>, hstl::rb_tree_monoid_augment<sum_monoid>> sums;
+    for(int k : keys){
+        sums.insert_equal(k);
+    }
+    bench("rb_tree fold, 2k range sums", [&]{
+        long long total = 0;
+        for(int p : points){
+            total += sums.fold(p, p + kSpace / 10);
+        }
+        do_not_optimize(total);
+    });
+    bench("linear scan, 2k range sums", [&]{
+        long long total = 0;
+        for(int p : points){
+            for(int k : keys){
+                total += (p <= k && k < p + kSpace / 10) ? k : 0;
+            }
+        }
+        do_not_optimize(total);
+    });
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "bench.h"
+#include "../TinySTL/mpmc_queue.h"
+#include "../TinySTL/deque.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const int kItems = 4000000;
+
+struct locked_deque{
+    std::mutex m;
+    hstl::deque<int> d;
+
+    explicit locked_deque(std::size_t){}
+
+    bool try_push(int v){
+        std::lock_guard<std::mutex> lock(m);
+        d.push_back(v);
+        return true;
+    }
+    bool try_pop(int& v){
+        std::lock_guard<std::mutex> lock(m);
+        if(d.empty()){
+            return false;
+        }
+        v = d.front();
+        d.pop_front();
+        return true;
+    }
+};
+
+// threads / 2 producers and threads / 2 consumers move kItems in total,
+// a single thread alternates push and pop
+template <typename Queue>
+double run(int threads){
+    Queue q(1024);
+    std::atomic<long long> sum(0);
+    std::atomic<int> remaining(kItems);
+    auto start = std::chrono::steady_clock::now();
+    if(threads == 1){
+        int v;
+        long long local = 0;
+        for(int i = 0; i < kItems; ++i){
+            if(q.try_push(i) && q.try_pop(v)){
+                local += v;
+            }
+        }
+        sum += local;
+    }else{
+        const int producers = threads / 2;
+        const int consumers = threads - producers;
+        std::vector<std::thread> pool;
+        for(int p = 0; p < producers; ++p){
+            pool.emplace_back([&, p]{
+                for(int i = p; i < kItems; i += producers){
+                    while(!q.try_push(i)){
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for(int c = 0; c < consumers; ++c){
+            pool.emplace_back([&]{
+                int v;
+                long long local = 0;
+                while(remaining.load(std::memory_order_relaxed) > 0){
+                    if(q.try_pop(v)){
+                        local += v;
+                        remaining.fetch_sub(1, std::memory_order_relaxed);
+                    }else{
+                        std::this_thread::yield();
+                    }
+                }
+                sum += local;
+            });
+        }
+        for(auto& t : pool){
+            t.join();
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    do_not_optimize(sum.load());
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main(){
+    std::printf("%8s %18s %18s   (%u hardware threads)\n", "threads", "mpmc_queue ms", "mutex+deque ms",
+        std::thread::hardware_concurrency());
+    for(int threads = 1; threads <= 64; threads *= 2){
+        double lock_free = run<hstl::mpmc_queue<int>>(threads);
+        double locked = run<locked_deque>(threads);
+        std::printf("%8d %18.2f %18.2f\n", threads, lock_free, locked);
+    }
+    return 0;
+}
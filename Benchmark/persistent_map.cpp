@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "../TinySTL/map.h"
+#include "../TinySTL/persistent_map.h"
+#include <deque>
+#include <random>
+#include <vector>
+
+const int kEntries = 100000;
+const int kCopiedVersions = 200;
+const int kVersions = 100000;
+const int kLive = 100;          // snapshots still held by requests in flight
+const int kLookups = 1000000;
+
+// a configuration of kEntries keys, one key changes per version and the last kLive
+// versions stay alive: a whole copy of hstl::map per version against path copying
+int main(){
+    std::mt19937_64 gen(50);
+    std::vector<long long> keys(kEntries);
+    for(long long& k : keys){
+        k = static_cast<long long>(gen() % (1ULL << 40));
+    }
+
+    hstl::map<long long, long long> config;
+    for(long long k : keys){
+        config[k] = k;
+    }
+    bench("hstl::map copy per version, 200 versions", [&]{
+        std::deque<hstl::map<long long, long long>> live;
+        live.push_back(config);
+        for(int i = 0; i < kCopiedVersions; ++i){
+            hstl::map<long long, long long> next(live.back());
+            next[keys[gen() % kEntries]] = i;
+            live.push_back(std::move(next));
+            if(live.size() > kLive){
+                live.pop_front();
+            }
+        }
+        do_not_optimize(live.back().size());
+    });
+
+    hstl::persistent_map<long long, long long> base;
+    bench("persistent_map build in place, 100k", [&]{
+        for(long long k : keys){
+            base = std::move(base).insert_or_assign(k, k);
+        }
+        do_not_optimize(base.size());
+    });
+    bench("persistent_map per version, 100k versions", [&]{
+        std::deque<hstl::persistent_map<long long, long long>> live;
+        live.push_back(base);
+        for(int i = 0; i < kVersions; ++i){
+            live.push_back(live.back().insert_or_assign(keys[gen() % kEntries], i));
+            if(live.size() > kLive){
+                live.pop_front();
+            }
+        }
+        do_not_optimize(live.back().size());
+    });
+    bench("persistent_map erase + insert per version, 100k", [&]{
+        std::deque<hstl::persistent_map<long long, long long>> live;
+        live.push_back(base);
+        for(int i = 0; i < kVersions; ++i){
+            const long long k = keys[gen() % kEntries];
+            live.push_back(live.back().erase(k).insert_or_assign(k, i));
+            if(live.size() > kLive){
+                live.pop_front();
+            }
+        }
+        do_not_optimize(live.back().size());
+    });
+
+    std::vector<long long> probes(kLookups);
+    for(long long& p : probes){
+        p = keys[gen() % kEntries];
+    }
+    bench("hstl::map find, 1M", [&]{
+        long long sum = 0;
+        for(long long p : probes){
+            sum += config.find(p)->second;
+        }
+        do_not_optimize(sum);
+    });
+    bench("persistent_map find, 1M", [&]{
+        long long sum = 0;
+        for(long long p : probes){
+            sum += base.find(p)->second;
+        }
+        do_not_optimize(sum);
+    });
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "../TinySTL/priority_queue.h"
+#include <queue>
+#include <random>
+#include <vector>
+
+const int kSize = 1000000;
+const int kOps = 5000000;
+
+int main(){
+    std::mt19937 gen(3);
+    std::vector<int> keys(kSize);
+    for(int& k : keys){
+        k = static_cast<int>(gen() >> 1);
+    }
+
+    // scheduler loop: take the next deadline and requeue it later
+    {
+        std::priority_queue<int> q(keys.begin(), keys.end());
+        bench("std::priority_queue pop + push", [&]{
+            for(int i = 0; i < kOps; ++i){
+                int t = q.top();
+                q.pop();
+                q.push(t - static_cast<int>(gen() & 0xffff));
+            }
+        });
+        do_not_optimize(q.top());
+    }
+    {
+        hstl::priority_queue<int> q(keys.begin(), keys.end());
+        bench("hstl::priority_queue pop + push", [&]{
+            for(int i = 0; i < kOps; ++i){
+                int t = q.top();
+                q.pop();
+                q.push(t - static_cast<int>(gen() & 0xffff));
+            }
+        });
+        do_not_optimize(q.top());
+    }
+    {
+        hstl::priority_queue<int> q(keys.begin(), keys.end());
+        bench("hstl::priority_queue replace_top", [&]{
+            for(int i = 0; i < kOps; ++i){
+                q.replace_top(q.top() - static_cast<int>(gen() & 0xffff));
+            }
+        });
+        do_not_optimize(q.top());
+    }
+
+    // a large batch arriving at a small queue
+    {
+        std::priority_queue<int> q(keys.begin(), keys.begin() + 1000);
+        bench("std::priority_queue push 1M one by one", [&]{
+            for(int k : keys){
+                q.push(k);
+            }
+        });
+        do_not_optimize(q.top());
+    }
+    {
+        hstl::priority_queue<int> q(keys.begin(), keys.begin() + 1000);
+        bench("hstl::priority_queue push_range 1M", [&]{
+            q.push_range(keys.begin(), keys.end());
+        });
+        do_not_optimize(q.top());
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "bench.h"
+#include "../TinySTL/radix_heap.h"
+#include "../TinySTL/priority_queue.h"
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+const int kVertices = 1000000;
+const int kDegree = 8;
+const int kTimers = 100000;
+const int kFirings = 10000000;
+const std::uint64_t kInf = ~std::uint64_t(0);
+
+struct graph{
+    std::vector<int> offset;
+    std::vector<int> target;
+    std::vector<std::uint32_t> weight;
+};
+
+graph random_graph(){
+    std::mt19937 gen(11);
+    graph g;
+    g.offset.resize(kVertices + 1);
+    for(int v = 0; v < kVertices; ++v){
+        g.offset[v] = v * kDegree;
+        for(int e = 0; e < kDegree; ++e){
+            g.target.push_back(static_cast<int>(gen() % kVertices));
+            g.weight.push_back(gen() % 1000 + 1);
+        }
+    }
+    g.offset[kVertices] = kVertices * kDegree;
+    return g;
+}
+
+// lazy deletion in both: push on every improvement, skip stale entries on pop
+std::uint64_t dijkstra_radix(const graph& g){
+    std::vector<std::uint64_t> dist(kVertices, kInf);
+    hstl::radix_heap<std::uint64_t, int> h;
+    dist[0] = 0;
+    h.push(0, 0);
+    while(!h.empty()){
+        const std::uint64_t d = h.top_key();
+        const int u = h.top_value();
+        h.pop();
+        if(d != dist[u]){
+            continue;
+        }
+        for(int e = g.offset[u]; e < g.offset[u + 1]; ++e){
+            const int v = g.target[e];
+            if(d + g.weight[e] < dist[v]){
+                dist[v] = d + g.weight[e];
+                h.push(dist[v], v);
+            }
+        }
+    }
+    std::uint64_t sum = 0;
+    for(std::uint64_t d : dist){
+        sum += d == kInf ? 0 : d;
+    }
+    return sum;
+}
+
+std::uint64_t dijkstra_binary(const graph& g){
+    typedef std::pair<std::uint64_t, int> item;
+    std::vector<std::uint64_t> dist(kVertices, kInf);
+    hstl::priority_queue<item, hstl::vector<item>, std::greater<item>> h;
+    dist[0] = 0;
+    h.push(item(0, 0));
+    while(!h.empty()){
+        const item top = h.top();
+        h.pop();
+        const int u = top.second;
+        if(top.first != dist[u]){
+            continue;
+        }
+        for(int e = g.offset[u]; e < g.offset[u + 1]; ++e){
+            const int v = g.target[e];
+            if(top.first + g.weight[e] < dist[v]){
+                dist[v] = top.first + g.weight[e];
+                h.push(item(dist[v], v));
+            }
+        }
+    }
+    std::uint64_t sum = 0;
+    for(std::uint64_t d : dist){
+        sum += d == kInf ? 0 : d;
+    }
+    return sum;
+}
+
+
+int main(){
+    const graph g = random_graph();
+    std::uint64_t a = 0, b = 0;
+    bench("dijkstra, hstl::priority_queue", [&]{ a = dijkstra_binary(g); });
+    bench("dijkstra, radix_heap", [&]{ b = dijkstra_radix(g); });
+    std::printf("checksums %s\n", a == b ? "match" : "DIFFER");
+
+    // timers: fire the earliest and rearm it a random delay later
+    {
+        typedef std::pair<std::uint64_t, int> item;
+        hstl::priority_queue<item, hstl::vector<item>, std::greater<item>> q;
+        std::mt19937 gen(5);
+        for(int i = 0; i < kTimers; ++i){
+            q.push(item(gen() % 100000, i));
+        }
+        bench("10M timer firings, hstl::priority_queue", [&]{
+            for(int i = 0; i < kFirings; ++i){
+                item t = q.top();
+                t.first += gen() % 100000;
+                q.replace_top(t);
+            }
+        });
+        do_not_optimize(q.top());
+    }
+    {
+        hstl::radix_heap<std::uint64_t, int> q;
+        std::mt19937 gen(5);
+        for(int i = 0; i < kTimers; ++i){
+            q.push(gen() % 100000, i);
+        }
+        bench("10M timer firings, radix_heap", [&]{
+            for(int i = 0; i < kFirings; ++i){
+                const std::uint64_t t = q.top_key() + gen() % 100000;
+                const int id = q.top_value();
+                q.pop();
+                q.push(t, id);
+            }
+        });
+        do_not_optimize(q.top_key());
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "bench.h"
+#include "../TinySTL/rb_tree.h"
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+const int kSize = 1000000;
+const int kLookups = 1000000;
+const int kScanSize = 10000;
+const int kScanLookups = 2000;
+
+// the only lookup there was before find: walk the iterators
+template <typename Tree>
+bool linear_find(const Tree& t, int k){
+    for(auto it = t.begin(); it != t.end(); ++it){
+        if(*it == k){
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(){
+    std::mt19937 gen(41);
+    std::vector<int> keys(kSize);
+    for(int& k : keys){
+        k = static_cast<int>(gen() % (2 * kSize));
+    }
+    std::vector<int> probes(kLookups);
+    for(int& k : probes){
+        k = static_cast<int>(gen() % (2 * kSize));
+    }
+
+    hstl::rb_tree<int, std::less<int>> tree;
+    std::multiset<int> ref;
+    for(int k : keys){
+        tree.insert_equal(k);
+        ref.insert(k);
+    }
+
+    bench("hstl::rb_tree find, 1M keys", [&]{
+        int hits = 0;
+        for(int k : probes){
+            hits += tree.find(k) != tree.end();
+        }
+        do_not_optimize(hits);
+    });
+    bench("std::multiset find, 1M keys", [&]{
+        int hits = 0;
+        for(int k : probes){
+            hits += ref.find(k) != ref.end();
+        }
+        do_not_optimize(hits);
+    });
+    bench("hstl::rb_tree lower_bound, 1M keys", [&]{
+        long long sum = 0;
+        for(int k : probes){
+            auto it = tree.lower_bound(k);
+            sum += it != tree.end() ? *it : 0;
+        }
+        do_not_optimize(sum);
+    });
+    bench("hstl::rb_tree equal_range, 1M keys", [&]{
+        long long sum = 0;
+        for(int k : probes){
+            auto range = tree.equal_range(k);
+            sum += range.first != range.second;
+        }
+        do_not_optimize(sum);
+    });
+
+    hstl::rb_tree<int, std::less<int>> small;
+    for(int i = 0; i < kScanSize; ++i){
+        small.insert_equal(keys[i]);
+    }
+    bench("linear walk, 10k keys x 2k lookups", [&]{
+        int hits = 0;
+        for(int i = 0; i < kScanLookups; ++i){
+            hits += linear_find(small, probes[i]);
+        }
+        do_not_optimize(hits);
+    });
+    bench("hstl::rb_tree find, 10k keys x 2k lookups", [&]{
+        int hits = 0;
+        for(int i = 0; i < kScanLookups; ++i){
+            hits += small.find(probes[i]) != small.end();
+        }
+        do_not_optimize(hits);
+    });
+
+    // string keys looked up by string_view: std::less<std::string> has to build a
+    // temporary string per probe, std::less<> compares in place
+    std::vector<std::string> words;
+    for(int i = 0; i < kSize / 4; ++i){
+        words.push_back("routing-table-entry-" + std::to_string(gen()));
+    }
+    hstl::rb_tree<std::string, std::less<std::string>> plain;
+    hstl::rb_tree<std::string, std::less<>> transparent;
+    for(const std::string& w : words){
+        plain.insert_equal(w);
+        transparent.insert_equal(w);
+    }
+    std::vector<std::string_view> views;
+    for(int i = 0; i < kLookups; ++i){
+        views.push_back(words[gen() % words.size()]);
+    }
+    bench("string keys, std::less<string> + temporary", [&]{
+        int hits = 0;
+        for(std::string_view v : views){
+            hits += plain.find(std::string(v)) != plain.end();
+        }
+        do_not_optimize(hits);
+    });
+    bench("string keys, std::less<> by string_view", [&]{
+        int hits = 0;
+        for(std::string_view v : views){
+            hits += transparent.find(v) != transparent.end();
+        }
+        do_not_optimize(hits);
+    });
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "bench.h"
+#include "../TinySTL/rb_tree.h"
+#include <functional>
+#include <set>
+#include <vector>
+
+const int kSize = 5000000;
+
+// loading a sorted snapshot: one descent per row, hinted appends, the O(n) bulk build
+int main(){
+    std::vector<long long> rows(kSize);
+    for(int i = 0; i < kSize; ++i){
+        rows[i] = 3LL * i;
+    }
+
+    bench("insert_equal, 5M sorted", [&]{
+        hstl::rb_tree<long long, std::less<long long>> tree;
+        for(long long r : rows){
+            tree.insert_equal(r);
+        }
+        do_not_optimize(tree.size());
+    });
+    bench("insert_hint(end()), 5M sorted", [&]{
+        hstl::rb_tree<long long, std::less<long long>> tree;
+        for(long long r : rows){
+            tree.insert_hint(tree.end(), r);
+        }
+        do_not_optimize(tree.size());
+    });
+    bench("sorted_range constructor, 5M sorted", [&]{
+        hstl::rb_tree<long long, std::less<long long>> tree(hstl::sorted_range_tag(), rows.begin(), rows.end());
+        do_not_optimize(tree.size());
+    });
+    bench("std::multiset insert(end()), 5M sorted", [&]{
+        std::multiset<long long> ref;
+        for(long long r : rows){
+            ref.insert(ref.end(), r);
+        }
+        do_not_optimize(ref.size());
+    });
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "bench.h"
+#include "../TinySTL/rb_tree.h"
+#include "../TinySTL/functional.h"
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <malloc.h>
+#include <random>
+#include <utility>
+#include <vector>
+
+const int kSize = 4000000;
+const int kLookups = 4000000;
+
+// bytes the heap hands out per element, allocator rounding and chunk headers included
+template <typename Fill>
+double heap_bytes_per_node(Fill fill){
+    const std::size_t before = mallinfo2().uordblks;
+    const std::size_t n = fill();
+    return static_cast<double>(mallinfo2().uordblks - before) / static_cast<double>(n);
+}
+
+template <typename Tree, typename Make>
+void run(const char* label, const std::vector<long long>& keys, const std::vector<long long>& probes, Make make){
+    std::printf("%s: sizeof(node) %zu\n", label, sizeof(typename Tree::node_type));
+    Tree tree;
+    double bytes = 0;
+    char name[96];
+    std::snprintf(name, sizeof(name), "%s insert_unique, 4M random", label);
+    bench(name, [&]{
+        bytes = heap_bytes_per_node([&]{
+            for(long long k : keys){
+                tree.insert_unique(make(k));
+            }
+            return tree.size();
+        });
+    });
+    std::printf("%s: %.1f heap bytes per element\n", label, bytes);
+    std::snprintf(name, sizeof(name), "%s find, 4M probes", label);
+    bench(name, [&]{
+        int hits = 0;
+        for(long long k : probes){
+            hits += tree.find(k) != tree.end();
+        }
+        do_not_optimize(hits);
+    });
+    std::snprintf(name, sizeof(name), "%s in-order walk", label);
+    bench(name, [&]{
+        std::uintptr_t sum = 0;
+        for(auto it = tree.begin(); it != tree.end(); ++it){
+            sum += reinterpret_cast<std::uintptr_t>(&*it);
+        }
+        do_not_optimize(sum);
+    });
+}
+
+int main(){
+    std::mt19937_64 gen(48);
+    std::vector<long long> keys(kSize);
+    for(long long& k : keys){
+        k = static_cast<long long>(gen() % (4ULL * kSize));
+    }
+    std::vector<long long> probes(kLookups);
+    for(long long& k : probes){
+        k = static_cast<long long>(gen() % (4ULL * kSize));
+    }
+
+    typedef std::pair<long long, long long> entry;
+    typedef hstl::identity<long long> key_of;
+    typedef hstl::select1st<entry> first_of;
+    typedef hstl::rb_tree_no_augment none;
+    run<hstl::rb_tree<long long, std::less<long long>, key_of, none, hstl::rb_tree_node_base>>("plain 8-byte keys", keys, probes,
+        [](long long k){ return k; });
+    run<hstl::rb_tree<long long, std::less<long long>, key_of, none, hstl::rb_tree_compact_node_base>>("compact 8-byte keys", keys, probes,
+        [](long long k){ return k; });
+    run<hstl::rb_tree<entry, std::less<long long>, first_of, none, hstl::rb_tree_node_base>>("plain 16-byte entries", keys, probes,
+        [](long long k){ return entry(k, k); });
+    run<hstl::rb_tree<entry, std::less<long long>, first_of, none, hstl::rb_tree_compact_node_base>>("compact 16-byte entries", keys, probes,
+        [](long long k){ return entry(k, k); });
+    return 0;
+}
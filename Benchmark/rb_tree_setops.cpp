@@ -0,0 +1,114 @@
+#include "bench.h"
+#include "../TinySTL/rb_tree.h"
+#include "../TinySTL/thread_pool.h"
+#include <functional>
+#include <random>
+#include <vector>
+
+typedef hstl::rb_tree<long long, std::less<long long>> tree;
+
+const int kShards = 16;
+const int kShardSize = 100000;
+const int kBase = 1000000;
+const int kDelta = 1000;
+
+tree random_tree(std::mt19937_64& gen, int n){
+    tree t;
+    for(int i = 0; i < n; ++i){
+        t.insert_unique(static_cast<long long>(gen() % (1ULL << 40)));
+    }
+    return t;
+}
+
+// merging shards: one insert per element against union by split and join, and a small
+// delta against a large base, where union only touches O(m log(n / m)) nodes
+int main(){
+    std::mt19937_64 gen(47);
+    std::vector<tree> shards;
+    for(int s = 0; s < kShards; ++s){
+        shards.push_back(random_tree(gen, kShardSize));
+    }
+    hstl::thread_pool pool;
+
+    {
+        std::vector<tree> in(shards);
+        bench("insert_equal loop, 16 shards x 100k", [&]{
+            tree all;
+            for(const tree& s : in){
+                for(long long k : s){
+                    all.insert_equal(k);
+                }
+            }
+            do_not_optimize(all.size());
+        });
+    }
+    {
+        std::vector<tree> in(shards);
+        bench("union_with, 16 shards x 100k", [&]{
+            tree all;
+            for(tree& s : in){
+                all.union_with(s);
+            }
+            do_not_optimize(all.size());
+        });
+    }
+    {
+        // pairwise rounds, so the late unions are of equal sized trees
+        std::vector<tree> in(shards);
+        bench("union_with pairwise on the pool, 16 x 100k", [&]{
+            for(int step = 1; step < kShards; step *= 2){
+                pool.parallel_for(0, kShards / (2 * step), 1, [&](int i){
+                    in[2 * step * i].union_with(in[2 * step * i + step], pool);
+                });
+            }
+            do_not_optimize(in[0].size());
+        });
+    }
+
+    tree base = random_tree(gen, kBase);
+    tree delta = random_tree(gen, kDelta);
+    {
+        tree a(base);
+        bench("insert_equal loop, 1M + 1k", [&]{
+            for(long long k : delta){
+                a.insert_equal(k);
+            }
+            do_not_optimize(a.size());
+        });
+    }
+    {
+        tree a(base);
+        tree b(delta);
+        bench("union_with, 1M + 1k", [&]{
+            a.union_with(b);
+            do_not_optimize(a.size());
+        });
+    }
+    {
+        tree a(base);
+        tree b(base);
+        tree c(delta);
+        tree d(delta);
+        bench("intersect_with, 1k and 1M (frees the 1M)", [&]{
+            c.intersect_with(a);
+            do_not_optimize(c.size());
+        });
+        bench("difference_with, 1M minus 1k", [&]{
+            b.difference_with(d);
+            do_not_optimize(b.size());
+        });
+    }
+    {
+        // with the order statistic summary split knows the size of its result in O(1)
+        typedef hstl::rb_tree<long long, std::less<long long>, hstl::identity<long long>, hstl::rb_tree_order_statistic> counted;
+        counted a(hstl::sorted_range_tag(), base.begin(), base.end());
+        bench("split + join, 1M order statistic, 1000 times", [&]{
+            for(int i = 0; i < 1000; ++i){
+                counted right = a.split(static_cast<long long>(gen() % (1ULL << 40)));
+                a.join(right);
+            }
+            do_not_optimize(a.size());
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "bench.h"
+#include "../TinySTL/ring_buffer.h"
+#include "../TinySTL/deque.h"
+
+const int kOps = 50000000;
+
+// bounded queue kept between half and completely full
+template <typename Queue>
+void bounded_queue(const char* name, Queue& q, std::size_t bound){
+    long long sum = 0;
+    bench(name, [&]{
+        for(int i = 0; i < kOps; ++i){
+            if(q.size() == bound){
+                for(std::size_t k = 0; k < bound / 2; ++k){
+                    sum += q.front();
+                    q.pop_front();
+                }
+            }
+            q.push_back(i);
+        }
+    });
+    do_not_optimize(sum);
+}
+
+int main(){
+    const std::size_t sizes[] = {64, 4096, 1 << 20};
+    for(std::size_t bound : sizes){
+        std::printf("bound = %zu\n", bound);
+        hstl::ring_buffer<int> r(bound);
+        bounded_queue("  hstl::ring_buffer", r, bound);
+        hstl::deque<int> d;
+        bounded_queue("  hstl::deque", d, bound);
+    }
+
+    // overwrite mode: keep only the newest elements, no size check on the caller side
+    hstl::ring_buffer<int> last(1024, true);
+    bench("hstl::ring_buffer overwrite push_back", [&]{
+        for(int i = 0; i < kOps; ++i){
+            last.push_back(i);
+        }
+    });
+    do_not_optimize(last.back());
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "bench.h"
+#include "../TinySTL/spsc_queue.h"
+#include "../TinySTL/deque.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+const int kItems = 20000000;
+const int kRoundTrips = 1000000;
+
+// keep producer and consumer on different cores; the spin loops yield so that the
+// numbers stay meaningful on machines with fewer cores than threads
+void pin_to_core(std::thread& t, int core){
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+    (void)t;
+    (void)core;
+#endif
+}
+
+struct locked_deque{
+    std::mutex m;
+    hstl::deque<int> d;
+
+    bool try_push(int v){
+        std::lock_guard<std::mutex> lock(m);
+        d.push_back(v);
+        return true;
+    }
+    bool try_pop(int& v){
+        std::lock_guard<std::mutex> lock(m);
+        if(d.empty()){
+            return false;
+        }
+        v = d.front();
+        d.pop_front();
+        return true;
+    }
+};
+
+template <typename Queue>
+void throughput(const char* name, Queue& q){
+    long long sum = 0;
+    bench(name, [&]{
+        std::thread consumer([&]{
+            int v;
+            for(int i = 0; i < kItems; ++i){
+                while(!q.try_pop(v)){ std::this_thread::yield(); }
+                sum += v;
+            }
+        });
+        pin_to_core(consumer, 1);
+        for(int i = 0; i < kItems; ++i){
+            while(!q.try_push(i)){ std::this_thread::yield(); }
+        }
+        consumer.join();
+    });
+    do_not_optimize(sum);
+}
+
+void batch_throughput(){
+    hstl::spsc_queue<int> q(4096);
+    long long sum = 0;
+    bench("spsc_queue try_push_n/try_pop_n (64)", [&]{
+        std::thread consumer([&]{
+            int buf[64];
+            for(int got = 0; got < kItems; ){
+                int n = static_cast<int>(q.try_pop_n(buf, 64));
+                if(n == 0){
+                    std::this_thread::yield();
+                }
+                for(int k = 0; k < n; ++k){
+                    sum += buf[k];
+                }
+                got += n;
+            }
+        });
+        pin_to_core(consumer, 1);
+        int buf[64];
+        for(int sent = 0; sent < kItems; ){
+            int n = std::min(64, kItems - sent);
+            for(int k = 0; k < n; ++k){
+                buf[k] = sent + k;
+            }
+            int pushed = static_cast<int>(q.try_push_n(buf, n));
+            if(pushed == 0){
+                std::this_thread::yield();
+            }
+            sent += pushed;
+        }
+        consumer.join();
+    });
+    do_not_optimize(sum);
+}
+
+// one item bounces between two threads, report the median round trip
+template <typename Queue>
+void latency(const char* name){
+    Queue ping(1024), pong(1024);
+    std::vector<double> samples;
+    samples.reserve(kRoundTrips);
+    std::thread echo([&]{
+        int v;
+        for(int i = 0; i < kRoundTrips; ++i){
+            while(!ping.try_pop(v)){ std::this_thread::yield(); }
+            while(!pong.try_push(v)){ std::this_thread::yield(); }
+        }
+    });
+    pin_to_core(echo, 1);
+    for(int i = 0; i < kRoundTrips; ++i){
+        int v;
+        auto start = std::chrono::steady_clock::now();
+        while(!ping.try_push(i)){ std::this_thread::yield(); }
+        while(!pong.try_pop(v)){ std::this_thread::yield(); }
+        auto stop = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    echo.join();
+    std::sort(samples.begin(), samples.end());
+    std::printf("%-48s %10.0f ns p50 %10.0f ns p99\n", name, samples[samples.size() / 2], samples[samples.size() * 99 / 100]);
+}
+
+struct locked_deque_sized : locked_deque{
+    explicit locked_deque_sized(std::size_t){}
+};
+
+int main(){
+    {
+        hstl::spsc_queue<int> q(4096);
+        throughput("spsc_queue throughput", q);
+    }
+    batch_throughput();
+    {
+        locked_deque q;
+        throughput("mutex + hstl::deque throughput", q);
+    }
+    latency<hstl::spsc_queue<int>>("spsc_queue round trip");
+    latency<locked_deque_sized>("mutex + hstl::deque round trip");
+    return 0;
+}
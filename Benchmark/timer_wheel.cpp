@@ -0,0 +1,158 @@
+#include "bench.h"
+#include "../TinySTL/timer_wheel.h"
+#include "../TinySTL/heap.h"
+#include "../TinySTL/indexed_heap.h"
+#include "../TinySTL/vector.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+// RPC timeouts: every tick kPerTick calls start with a timeout of 1-30k ticks,
+// 90% of them complete (cancel their timer) a few hundred ticks later
+const int kTicks = 20000;
+const int kPerTick = 100;
+
+struct wheel_timers{
+    hstl::timer_wheel<int> wheel;
+    std::vector<hstl::timer_wheel<int>::handle> handle;
+
+    void schedule(int id, std::uint64_t when){
+        if(static_cast<int>(handle.size()) <= id){
+            handle.resize(id + 1);
+        }
+        handle[id] = wheel.schedule(when, id);
+    }
+    void cancel(int id){
+        wheel.cancel(handle[id]);
+    }
+    long long advance(std::uint64_t now){
+        struct counter{
+            long long* n;
+            counter& operator*(){ return *this; }
+            counter& operator++(){ return *this; }
+            counter& operator=(int){ ++*n; return *this; }
+        };
+        long long n = 0;
+        wheel.advance(now, counter{&n});
+        return n;
+    }
+};
+
+// binary heap of (expiry, id); cancel leaves a tombstone that is skipped when it surfaces
+struct lazy_heap_timers{
+    typedef std::pair<std::uint64_t, int> item;
+    hstl::vector<item> heap;
+    std::vector<char> cancelled;
+    std::greater<item> comp;
+
+    void schedule(int id, std::uint64_t when){
+        if(static_cast<int>(cancelled.size()) <= id){
+            cancelled.resize(id + 1);
+        }
+        heap.push_back(item(when, id));
+        hstl::push_heap(heap.begin(), heap.end(), comp);
+    }
+    void cancel(int id){
+        cancelled[id] = 1;
+    }
+    long long advance(std::uint64_t now){
+        long long n = 0;
+        while(!heap.empty() && heap.begin()->first <= now){
+            n += !cancelled[heap.begin()->second];
+            hstl::pop_heap(heap.begin(), heap.end(), comp);
+            heap.pop_back();
+        }
+        return n;
+    }
+};
+
+// binary heap that really removes a cancelled timer: find it, then fix the heap, O(n)
+struct eager_heap_timers{
+    typedef std::pair<std::uint64_t, int> item;
+    hstl::vector<item> heap;
+    std::greater<item> comp;
+
+    void schedule(int id, std::uint64_t when){
+        heap.push_back(item(when, id));
+        hstl::push_heap(heap.begin(), heap.end(), comp);
+    }
+    void cancel(int id){
+        for(auto it = heap.begin(); it != heap.end(); ++it){
+            if(it->second == id){
+                *it = *(heap.end() - 1);
+                heap.pop_back();
+                hstl::make_heap(heap.begin(), heap.end(), comp);
+                return;
+            }
+        }
+    }
+    long long advance(std::uint64_t now){
+        long long n = 0;
+        while(!heap.empty() && heap.begin()->first <= now){
+            ++n;
+            hstl::pop_heap(heap.begin(), heap.end(), comp);
+            heap.pop_back();
+        }
+        return n;
+    }
+};
+
+struct indexed_heap_timers{
+    hstl::indexed_heap<int, std::uint64_t> heap;
+
+    void schedule(int id, std::uint64_t when){
+        heap.push(id, when);
+    }
+    void cancel(int id){
+        heap.erase(id);
+    }
+    long long advance(std::uint64_t now){
+        long long n = 0;
+        while(!heap.empty() && heap.top_priority() <= now){
+            ++n;
+            heap.pop();
+        }
+        return n;
+    }
+};
+
+template <typename Timers>
+void run(const char* name, int ticks){
+    Timers timers;
+    std::mt19937 gen(17);
+    // (completion tick, id) of the calls that will complete before their timeout
+    std::vector<std::pair<int, int>> completions;
+    long long fired = 0;
+    int next_id = 0;
+    bench(name, [&]{
+        for(int t = 0; t < ticks; ++t){
+            for(int k = 0; k < kPerTick; ++k){
+                const int id = next_id++;
+                timers.schedule(id, t + 1000 + gen() % 29000);
+                if(gen() % 10 != 0){
+                    completions.push_back(std::make_pair(t + 1 + static_cast<int>(gen() % 500), id));
+                    std::push_heap(completions.begin(), completions.end(), std::greater<std::pair<int, int>>());
+                }
+            }
+            while(!completions.empty() && completions.front().first <= t){
+                timers.cancel(completions.front().second);
+                std::pop_heap(completions.begin(), completions.end(), std::greater<std::pair<int, int>>());
+                completions.pop_back();
+            }
+            fired += timers.advance(t);
+        }
+    });
+    do_not_optimize(fired);
+}
+
+int main(){
+    run<wheel_timers>("timer_wheel, 2M timers", kTicks);
+    run<lazy_heap_timers>("heap + tombstones, 2M timers", kTicks);
+    run<indexed_heap_timers>("indexed_heap, 2M timers", kTicks);
+    run<wheel_timers>("timer_wheel, 50k timers", kTicks / 40);
+    run<eager_heap_timers>("heap + linear cancel, 50k timers", kTicks / 40);
+    return 0;
+}
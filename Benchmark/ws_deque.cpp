@@ -0,0 +1,80 @@
+#include "bench.h"
+#include "../TinySTL/ws_deque.h"
+#include "../TinySTL/thread_pool.h"
+#include "../TinySTL/deque.h"
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const int kItems = 4000000;
+
+struct locked_deque{
+    std::mutex m;
+    hstl::deque<int> d;
+
+    void push(int v){
+        std::lock_guard<std::mutex> lock(m);
+        d.push_back(v);
+    }
+    bool pop(int& v){
+        std::lock_guard<std::mutex> lock(m);
+        if(d.empty()){
+            return false;
+        }
+        v = d.back();
+        d.pop_back();
+        return true;
+    }
+};
+
+// the owner's side is the hot path of a scheduler: push a task, pop it back
+template <typename Queue>
+void owner_only(){
+    Queue q;
+    long long sum = 0;
+    int v;
+    for(int i = 0; i < kItems; ++i){
+        q.push(i);
+        if(i % 4 == 3){
+            while(q.pop(v)){
+                sum += v;
+            }
+        }
+    }
+    do_not_optimize(sum);
+}
+
+// naive parallel sum of heavy-ish chunks; compare one thread with the pool
+long long chunk(long lo, long hi){
+    long long s = 0;
+    for(long i = lo; i < hi; ++i){
+        s += i * i % 7;
+    }
+    return s;
+}
+
+int main(){
+    bench("ws_deque<int> owner push/pop", owner_only<hstl::ws_deque<int>>);
+    bench("locked hstl::deque<int> owner push/pop", owner_only<locked_deque>);
+
+    const long n = 40000000;
+    bench("serial sum", [&]{ do_not_optimize(chunk(0, n)); });
+    const unsigned hw = std::thread::hardware_concurrency();
+    for(unsigned threads = 1; threads <= (hw == 0 ? 1 : hw); threads *= 2){
+        hstl::thread_pool pool(threads);
+        std::vector<long long> part(n / 100000);
+        char name[64];
+        std::snprintf(name, sizeof(name), "thread_pool parallel_for sum, %u threads", threads);
+        bench(name, [&]{
+            pool.parallel_for(0L, static_cast<long>(part.size()), 1L, [&](long k){
+                part[k] = chunk(k * 100000, (k + 1) * 100000);
+            });
+            long long s = 0;
+            for(long long p : part){
+                s += p;
+            }
+            do_not_optimize(s);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,9 @@
+#include "concurrent_ordered_map.h"
+
+int main(){
+    test_1();
+    test_2();
+    test_3();
+    test_4();
+    return 0;
+}
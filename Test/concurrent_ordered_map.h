@@ -0,0 +1,212 @@
+#ifndef TEST_CONCURRENT_ORDERED_MAP_H
+#define TEST_CONCURRENT_ORDERED_MAP_H
+
+#include "../TinySTL/concurrent_ordered_map.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+void test_1(){
+    hstl::concurrent_ordered_map<int, std::string> m;
+    std::map<int, std::string> ref;
+    std::mt19937 gen(49);
+    for(int i = 0; i < 20000; ++i){
+        const int k = static_cast<int>(gen() % 500);
+        const std::string v = std::to_string(gen());
+        switch(gen() % 3){
+        case 0:
+            assert(m.insert(k, v) == ref.emplace(k, v).second);
+            break;
+        case 1:
+            assert(m.insert_or_assign(k, v) == (ref.count(k) == 0));
+            ref[k] = v;
+            break;
+        default:
+            assert(m.erase(k) == (ref.erase(k) == 1));
+            break;
+        }
+        assert(m.size() == ref.size());
+    }
+    assert(m.snapshot().is_balanced());
+    std::string v;
+    for(int k = 0; k < 500; ++k){
+        auto it = ref.find(k);
+        assert(m.contains(k) == (it != ref.end()));
+        assert(m.find(k, v) == (it != ref.end()));
+        assert(it == ref.end() || v == it->second);
+    }
+    typedef std::vector<std::pair<int, std::string>> entries;
+    entries all, range;
+    m.for_each([&](const std::pair<const int, std::string>& e){ all.emplace_back(e.first, e.second); });
+    assert(all == entries(ref.begin(), ref.end()));
+    m.for_each(100, 200, [&](const std::pair<const int, std::string>& e){ range.emplace_back(e.first, e.second); });
+    assert(range == entries(ref.lower_bound(100), ref.lower_bound(200)));
+    assert(m.visit(all.front().first, [&](const std::pair<const int, std::string>& e){ assert(e.second == all.front().second); }));
+    assert(!m.visit(-1, [](const std::pair<const int, std::string>&){ assert(false); }));
+    std::cout << "concurrent_ordered_map test 1 passed" << std::endl;
+}
+
+typedef hstl::persistent_rb_tree<int, std::less<int>> int_tree;
+
+// every node reachable from the root, with its links and color as raw bytes
+void node_bytes(int_tree::link_type x, std::vector<std::pair<int_tree::link_type, std::string>>& out){
+    if(x != nullptr){
+        out.emplace_back(x, std::string(reinterpret_cast<const char*>(static_cast<hstl::rb_tree_node_base*>(x)), sizeof(hstl::rb_tree_node_base)));
+        node_bytes(static_cast<int_tree::link_type>(x->left), out);
+        node_bytes(static_cast<int_tree::link_type>(x->right), out);
+    }
+}
+
+// updates leave the old version alone, down to the links and colors of its nodes
+void test_2(){
+    std::mt19937 gen(50);
+    for(int round = 0; round < 50; ++round){
+        const int range = 4 + round * 20;
+        int_tree t;
+        std::map<int, int> ref;
+        std::vector<std::pair<int_tree, std::vector<int>>> versions;
+        for(int i = 0; i < 400; ++i){
+            const int k = static_cast<int>(gen() % range);
+            std::vector<std::pair<int_tree::link_type, std::string>> before, after;
+            node_bytes(t.root_node(), before);
+            const bool erase = gen() % 3 == 0;
+            int_tree next = erase ? t.erase(k) : t.insert(k);
+            node_bytes(t.root_node(), after);
+            assert(before == after);
+            if(erase){
+                ref.erase(k);
+            }else{
+                ref.emplace(k, k);
+            }
+            assert(next.size() == ref.size() && next.is_balanced());
+            assert((next.find(k) != nullptr) == !erase);
+            if(i % 25 == 0){
+                std::vector<int> keys;
+                for(auto& e : ref){
+                    keys.push_back(e.first);
+                }
+                versions.emplace_back(next, keys);
+            }
+            t = std::move(next);
+        }
+        for(auto& v : versions){
+            std::vector<int> keys;
+            v.first.for_each([&](int x){ keys.push_back(x); });
+            assert(keys == v.second && v.first.is_balanced());
+        }
+    }
+    std::cout << "concurrent_ordered_map test 2 passed" << std::endl;
+}
+
+struct tracked{
+    static std::atomic<int> live;
+    static bool fail;
+    int x;
+    explicit tracked(int v) : x(v){ ++live; }
+    tracked(const tracked& rhs) : x(rhs.x){
+        if(fail){
+            throw std::runtime_error("copy");
+        }
+        ++live;
+    }
+    tracked& operator=(const tracked& rhs){ x = rhs.x; return *this; }
+    ~tracked(){ --live; }
+};
+std::atomic<int> tracked::live(0);
+bool tracked::fail = false;
+
+// a copy that throws halfway leaves the map as it was, and nothing leaks
+void test_3(){
+    {
+        hstl::concurrent_ordered_map<int, tracked> m;
+        for(int i = 0; i < 1000; ++i){
+            m.insert(i, tracked(i));
+        }
+        tracked::fail = true;
+        bool thrown = false;
+        try{
+            m.insert_or_assign(500, tracked(-1));
+        }catch(const std::runtime_error&){
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try{
+            m.erase(250);
+        }catch(const std::runtime_error&){
+            thrown = true;
+        }
+        assert(thrown);
+        tracked::fail = false;
+        assert(m.size() == 1000 && m.snapshot().is_balanced());
+        for(int i = 0; i < 1000; ++i){
+            assert(m.visit(i, [&](const std::pair<const int, tracked>& e){ assert(e.second.x == i); }));
+        }
+        for(int i = 0; i < 1000; i += 2){
+            m.erase(i);
+        }
+        m.collect();
+        m.collect();
+        assert(tracked::live == 500);
+    }
+    assert(tracked::live == 0);
+    std::cout << "concurrent_ordered_map test 3 passed" << std::endl;
+}
+
+// readers never block and always see whole versions: a value carries its key, and a
+// walk sees ordered keys while the writer churns
+void test_4(){
+    {
+        const int keys = 2000, readers = 4, writes = 20000;
+        hstl::concurrent_ordered_map<int, tracked> m;
+        for(int k = 0; k < keys; k += 2){
+            m.insert(k, tracked(k * 1000));
+        }
+        std::atomic<bool> done(false);
+        std::vector<std::thread> threads;
+        for(int r = 0; r < readers; ++r){
+            threads.emplace_back([&, r]{
+                std::mt19937 gen(r);
+                while(!done.load()){
+                    const int k = static_cast<int>(gen() % keys);
+                    m.visit(k, [&](const std::pair<const int, tracked>& e){ assert(e.second.x / 1000 == k); });
+                    if(gen() % 64 == 0){
+                        int prev = -1;
+                        m.for_each(k, k + 200, [&](const std::pair<const int, tracked>& e){
+                            assert(e.first > prev && e.first >= k && e.second.x / 1000 == e.first);
+                            prev = e.first;
+                        });
+                    }
+                }
+            });
+        }
+        std::mt19937 gen(51);
+        for(int i = 0; i < writes; ++i){
+            const int k = static_cast<int>(gen() % keys);
+            if(gen() % 2 == 0){
+                m.insert_or_assign(k, tracked(k * 1000 + i % 1000));
+            }else{
+                m.erase(k);
+            }
+        }
+        done = true;
+        for(auto& t : threads){
+            t.join();
+        }
+        m.collect();
+        m.collect();
+        assert(tracked::live == static_cast<int>(m.size()));
+    }
+    assert(tracked::live == 0);
+    std::cout << "concurrent_ordered_map test 4 passed" << std::endl;
+}
+
+#endif
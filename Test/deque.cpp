@@ -9,6 +9,14 @@ int main(){
     test_6();
     test_7();
     test_8();
+    test_9();
+    test_10();
+    test_11();
+    test_12();
+    test_13();
+    test_14();
+    test_15();
+    test_16();
 
     
     return 0;
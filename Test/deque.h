@@ -5,6 +5,11 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
+#include <deque>
+#include <string>
+#include <stdexcept>
+#include <sstream>
+#include <iterator>
 
 
 void test_1(){
@@ -108,4 +113,198 @@ void test_8(){
     std::cout << "deque test 8 passed" << std::endl;
 }
 
+void test_9(){
+    hstl::deque<int> d;
+    for(int i = 0; i < 10000; ++i){
+        d.push_back(i);
+    }
+    for(int i = 0; i < 10000; ++i){
+        assert(d[i] == i);
+        assert(d.at(i) == i);
+    }
+    bool thrown = false;
+    try{
+        d.at(10000);
+    }catch(const std::out_of_range&){
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "deque test 9 passed" << std::endl;
+}
+
+void test_10(){
+    hstl::deque<int> d;
+    std::deque<int> ref;
+    for(int i = 0; i < 3000; ++i){
+        d.push_back(i);
+        ref.push_back(i);
+    }
+    // insert near the front and near the back so both shift directions run
+    for(int i = 0; i < 1000; ++i){
+        size_t pos = (i * 7919) % (ref.size() + 1);
+        auto it = d.insert(d.begin() + pos, -i);
+        ref.insert(ref.begin() + pos, -i);
+        assert(*it == -i);
+    }
+    assert(d.size() == ref.size());
+    for(size_t i = 0; i < ref.size(); ++i){
+        assert(d[i] == ref[i]);
+    }
+    d.insert(d.begin() + 10, 5000, 7);
+    ref.insert(ref.begin() + 10, 5000, 7);
+    d.insert(d.end() - 10, 5000, 8);
+    ref.insert(ref.end() - 10, 5000, 8);
+    d.insert(d.begin() + 1, 3, 9);
+    ref.insert(ref.begin() + 1, 3, 9);
+    assert(d.size() == ref.size());
+    for(size_t i = 0; i < ref.size(); ++i){
+        assert(d[i] == ref[i]);
+    }
+    std::cout << "deque test 10 passed" << std::endl;
+}
+
+void test_11(){
+    hstl::deque<int> d;
+    std::deque<int> ref;
+    for(int i = 0; i < 20000; ++i){
+        d.push_back(i);
+        ref.push_back(i);
+    }
+    for(int i = 0; i < 1000; ++i){
+        size_t pos = (i * 7919) % ref.size();
+        auto it = d.erase(d.begin() + pos);
+        auto rit = ref.erase(ref.begin() + pos);
+        assert(rit == ref.end() || *it == *rit);
+    }
+    d.erase(d.begin() + 5, d.begin() + 5000);
+    ref.erase(ref.begin() + 5, ref.begin() + 5000);
+    d.erase(d.end() - 5000, d.end() - 5);
+    ref.erase(ref.end() - 5000, ref.end() - 5);
+    assert(d.size() == ref.size());
+    for(size_t i = 0; i < ref.size(); ++i){
+        assert(d[i] == ref[i]);
+    }
+    d.erase(d.begin(), d.end());
+    assert(d.empty());
+
+    // an empty range erases nothing, the elements before it are left alone
+    hstl::deque<std::vector<int>> v;
+    for(int i = 0; i < 10; ++i){
+        v.push_back(std::vector<int>(3, i));
+    }
+    assert(v.erase(v.begin() + 2, v.begin() + 2) == v.begin() + 2);
+    assert(v.erase(v.end() - 2, v.end() - 2) == v.end() - 2);
+    assert(v.size() == 10);
+    for(int i = 0; i < 10; ++i){
+        assert(v[i] == std::vector<int>(3, i));
+    }
+    std::cout << "deque test 11 passed" << std::endl;
+}
+
+void test_12(){
+    hstl::deque<std::string> d(10, "x");
+    d.resize(5000, "y");
+    assert(d.size() == 5000);
+    assert(d[9] == "x" && d[10] == "y" && d.back() == "y");
+    d.resize(3);
+    assert(d.size() == 3);
+    d.shrink_to_fit();
+    assert(d.size() == 3 && d.front() == "x");
+
+    hstl::deque<std::string> copy(d);
+    hstl::deque<std::string> moved(std::move(copy));
+    assert(moved.size() == 3 && copy.empty());
+    copy.push_back("z");
+    d = copy;
+    assert(d.size() == 1 && d.front() == "z");
+    std::cout << "deque test 12 passed" << std::endl;
+}
+
+void test_13(){
+    // tiny buffers so almost every operation crosses a buffer boundary
+    hstl::deque<int, 4> d;
+    std::deque<int> ref;
+    for(int i = 0; i < 20000; ++i){
+        switch(i % 7){
+        case 0: case 1: case 2: d.push_back(i); ref.push_back(i); break;
+        case 3: case 4: d.push_front(i); ref.push_front(i); break;
+        case 5: if(!ref.empty()){ d.pop_front(); ref.pop_front(); } break;
+        default: if(!ref.empty()){ d.pop_back(); ref.pop_back(); } break;
+        }
+    }
+    assert((hstl::deque<int, 4>::buffer_size == 4));
+    assert(d.size() == ref.size());
+    for(size_t i = 0; i < ref.size(); ++i){
+        assert(d[i] == ref[i]);
+    }
+    // ping-pong around a buffer boundary
+    for(int i = 0; i < 1000; ++i){
+        d.push_back(i);
+        d.push_back(i);
+        d.pop_back();
+        d.pop_back();
+    }
+    assert(d.size() == ref.size());
+    d.shrink_to_fit();
+    std::cout << "deque test 13 passed" << std::endl;
+}
+
+void test_14(){
+    std::vector<std::string> batch;
+    for(int i = 0; i < 5000; ++i){
+        batch.push_back(std::to_string(i));
+    }
+    hstl::deque<std::string> d;
+    d.push_back("mid");
+    d.append(batch.begin(), batch.end());
+    d.prepend(batch.begin(), batch.begin() + 3000);
+    assert(d.size() == 8001);
+    assert(d[0] == "0" && d[2999] == "2999" && d[3000] == "mid" && d[3001] == "0" && d.back() == "4999");
+
+    std::vector<std::string> out;
+    d.pop_front_n(3001, std::back_inserter(out));
+    assert(out.size() == 3001 && out[0] == "0" && out[3000] == "mid");
+    assert(d.size() == 5000 && d.front() == "0");
+    out.clear();
+    d.pop_back_n(4000, std::back_inserter(out));
+    assert(out.size() == 4000 && out[0] == "1000" && out[3999] == "4999");
+    assert(d.size() == 1000 && d.back() == "999");
+    d.pop_front_n(1000, std::back_inserter(out));
+    assert(d.empty());
+    std::cout << "deque test 14 passed" << std::endl;
+}
+
+void test_15(){
+    std::istringstream in("1 2 3 4 5");
+    hstl::deque<int> d{std::istream_iterator<int>(in), std::istream_iterator<int>()};
+    assert(d.size() == 5 && d.front() == 1 && d.back() == 5);
+    std::istringstream in2("-3 -2 -1");
+    d.prepend(std::istream_iterator<int>(in2), std::istream_iterator<int>());
+    assert(d.size() == 8 && d[0] == -3 && d[2] == -1 && d[3] == 1);
+    std::cout << "deque test 15 passed" << std::endl;
+}
+
+void test_16(){
+    hstl::deque<int, 16> d;
+    for(int i = 0; i < 1000; ++i){
+        d.push_back(i);
+    }
+    const hstl::deque<int, 16>& cd = d;
+    std::vector<int> v(1000);
+    hstl::copy(cd.begin() + 3, cd.end(), v.begin());
+    assert(v[0] == 3 && v[996] == 999);
+    assert(*hstl::find(d.begin(), d.end(), 517) == 517);
+    assert(hstl::find(d.begin() + 5, d.begin() + 9, 517) == d.begin() + 9);
+    long long sum = 0;
+    hstl::for_each(cd.begin(), cd.end(), [&](int x){ sum += x; });
+    assert(sum == 999 * 1000 / 2);
+    hstl::fill(d.begin() + 10, d.end() - 10, -1);
+    assert(d[9] == 9 && d[10] == -1 && d[989] == -1 && d[990] == 990);
+
+    hstl::deque<std::string, 16> s(100, "a");
+    hstl::deque<std::string, 16> t(s.begin() + 1, s.end());
+    assert(t.size() == 99 && t.back() == "a");
+    std::cout << "deque test 16 passed" << std::endl;
+}
+
 #endif
\ No newline at end of file
@@ -7,6 +7,10 @@ int main(){
     test_3();
     test_4();
     test_5();
+    test_6();
+    test_7();
+    test_8();
+    test_9();
     return 0;
 
 
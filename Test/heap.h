@@ -7,6 +7,10 @@
 
 #include <cassert>
 #include <vector>
+#include <functional>
+#include <cstdlib>
+#include <memory>
+#include <string>
 #include "../TinySTL/heap.h"
 
 
@@ -65,4 +69,156 @@ void test_5() {
     
 }
 
+void test_6() {
+    // min-heap through the Compare overloads
+    std::vector<int> v = {9,8,7,5,43,32,665,762,43,67,32,768,878};
+    std::vector<int> v2 = v;
+    hstl::make_heap(v.begin(), v.end(), std::greater<int>());
+    assert(std::is_heap(v.begin(), v.end(), std::greater<int>()));
+    v.push_back(-1);
+    hstl::push_heap(v.begin(), v.end(), std::greater<int>());
+    assert(v[0] == -1);
+    hstl::pop_heap(v.begin(), v.end(), std::greater<int>());
+    assert(v.back() == -1);
+    v.pop_back();
+    hstl::sort_heap(v.begin(), v.end(), std::greater<int>());
+    std::sort(v2.begin(), v2.end(), std::greater<int>());
+    assert(v == v2);
+    std::cout << "heap test 6 passed" << std::endl;
+}
+
+template <std::size_t D>
+void check_dary_heap(int n) {
+    std::vector<int> v;
+    for(int i = 0; i < n; ++i){
+        v.push_back(std::rand() % 1000);
+        hstl::dary_push_heap<D>(v.begin(), v.end());
+    }
+    std::vector<int> sorted = v;
+    std::sort(sorted.begin(), sorted.end());
+    for(int i = n - 1; i >= 0; --i){
+        hstl::dary_pop_heap<D>(v.begin(), v.end());
+        assert(v.back() == sorted[i]);
+        v.pop_back();
+    }
+
+    for(int i = 0; i < n; ++i){
+        v.push_back(std::rand() % 1000);
+    }
+    sorted = v;
+    std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+    hstl::dary_make_heap<D>(v.begin(), v.end(), std::greater<int>());
+    hstl::dary_sort_heap<D>(v.begin(), v.end(), std::greater<int>());
+    assert(v == sorted);
+}
+
+void test_7() {
+    for(int n = 0; n < 40; ++n){
+        check_dary_heap<2>(n);
+        check_dary_heap<3>(n);
+        check_dary_heap<4>(n);
+        check_dary_heap<8>(n);
+    }
+    check_dary_heap<4>(5000);
+    check_dary_heap<8>(5000);
+    std::cout << "heap test 7 passed" << std::endl;
+}
+
+struct copy_counter{
+    static int copies;
+    std::string s;
+    explicit copy_counter(const std::string& v) : s(v){}
+    copy_counter(const copy_counter& rhs) : s(rhs.s){ ++copies; }
+    copy_counter(copy_counter&&) = default;
+    copy_counter& operator=(const copy_counter& rhs){ s = rhs.s; ++copies; return *this; }
+    copy_counter& operator=(copy_counter&&) = default;
+    bool operator<(const copy_counter& rhs) const { return s < rhs.s; }
+};
+int copy_counter::copies = 0;
+
+void test_8() {
+    // the heap algorithms only move elements
+    std::vector<copy_counter> v;
+    std::vector<std::string> expect;
+    for(int i = 0; i < 200; ++i){
+        std::string key = std::to_string(std::rand() % 1000) + std::string(20, 'x');
+        expect.push_back(key);
+        v.emplace_back(key);
+    }
+    copy_counter::copies = 0;
+    hstl::make_heap(v.begin(), v.begin() + 100);
+    for(auto it = v.begin() + 101; it <= v.end(); ++it){
+        hstl::push_heap(v.begin(), it);
+    }
+    hstl::pop_heap(v.begin(), v.end());
+    hstl::push_heap(v.begin(), v.end());
+    hstl::sort_heap(v.begin(), v.end());
+    hstl::dary_make_heap<4>(v.begin(), v.end());
+    hstl::dary_sort_heap<4>(v.begin(), v.end());
+    assert(copy_counter::copies == 0);
+    std::sort(expect.begin(), expect.end());
+    for(std::size_t i = 0; i < v.size(); ++i){
+        assert(v[i].s == expect[i]);
+    }
+
+    // and so work on move-only types
+    std::vector<std::unique_ptr<int>> p;
+    auto less = [](const std::unique_ptr<int>& a, const std::unique_ptr<int>& b){ return *a < *b; };
+    for(int i = 0; i < 50; ++i){
+        p.emplace_back(new int((i * 37) % 50));
+        hstl::push_heap(p.begin(), p.end(), less);
+    }
+    for(int i = 49; i >= 0; --i){
+        hstl::pop_heap(p.begin(), p.end(), less);
+        assert(*p.back() == i);
+        p.pop_back();
+    }
+    std::cout << "heap test 8 passed" << std::endl;
+}
+
+void test_9() {
+    // partial_sort, partial_sort_copy, top_k and nth_element against a full sort
+    for(int n = 0; n < 300; n += 7){
+        std::vector<int> v(n);
+        for(int& x : v){
+            x = std::rand() % 50;
+        }
+        std::vector<int> sorted = v;
+        std::sort(sorted.begin(), sorted.end());
+        for(int k = 0; k <= n; k += 5){
+            std::vector<int> p = v;
+            hstl::partial_sort(p.begin(), p.begin() + k, p.end());
+            assert(std::equal(p.begin(), p.begin() + k, sorted.begin()));
+
+            std::vector<int> out(k + 3);
+            auto end = hstl::partial_sort_copy(v.begin(), v.end(), out.begin(), out.begin() + k);
+            assert(end - out.begin() == std::min(k, n));
+            assert(std::equal(out.begin(), end, sorted.begin()));
+
+            end = hstl::top_k(v.begin(), v.end(), out.begin(), out.begin() + k);
+            assert(std::equal(out.begin(), end, sorted.rbegin()));
+
+            if(k < n){
+                p = v;
+                hstl::nth_element(p.begin(), p.begin() + k, p.end());
+                assert(p[k] == sorted[k]);
+                for(int i = 0; i < n; ++i){
+                    assert(i < k ? p[i] <= p[k] : p[i] >= p[k]);
+                }
+            }
+        }
+    }
+    // with a comparator, and on an adversarial already sorted input
+    std::vector<int> v(100000);
+    for(int i = 0; i < 100000; ++i){
+        v[i] = i;
+    }
+    hstl::nth_element(v.begin(), v.begin() + 10, v.end(), std::greater<int>());
+    assert(v[10] == 99989);
+    std::vector<int> top(5);
+    hstl::top_k(v.begin(), v.end(), top.begin(), top.end(), std::greater<int>());
+    assert(top[0] == 0 && top[4] == 4);
+    std::cout << "heap test 9 passed" << std::endl;
+}
+
 #endif
\ No newline at end of file
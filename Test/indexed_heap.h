@@ -0,0 +1,113 @@
+#ifndef TEST_INDEXED_HEAP_H
+#define TEST_INDEXED_HEAP_H
+
+#include "../TinySTL/indexed_heap.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+
+void test_1(){
+    hstl::indexed_heap<int, int> h;
+    assert(h.empty() && !h.contains(3));
+    h.push(3, 30);
+    h.push(1, 10);
+    h.push(7, 70);
+    h.push(2, 20);
+    assert(h.size() == 4 && h.top_key() == 1 && h.top_priority() == 10);
+    h.update(7, 5);
+    assert(h.top_key() == 7 && h.priority(7) == 5);
+    h.update(7, 100);
+    assert(h.top_key() == 1);
+    assert(!h.push_or_decrease(2, 25) && h.priority(2) == 20);
+    assert(h.push_or_decrease(2, 1) && h.top_key() == 2);
+    assert(h.push_or_decrease(9, 0) && h.top_key() == 9);
+    assert(h.erase(1) && !h.erase(1) && !h.contains(1));
+    int expect[] = {9, 2, 3, 7};
+    for(int k : expect){
+        assert(h.top_key() == k);
+        h.pop();
+        assert(!h.contains(k));
+    }
+    assert(h.empty());
+    h.push(4, 4);
+    h.clear();
+    assert(h.empty() && !h.contains(4));
+    std::cout << "indexed_heap test 1 passed" << std::endl;
+}
+
+// random operations against a std::set of (priority, key) pairs
+template <typename Heap>
+void check_against_set(Heap& h, int keys, int ops){
+    std::set<std::pair<int, int>> ref;
+    std::map<int, int> prio;
+    for(int i = 0; i < ops; ++i){
+        const int key = std::rand() % keys;
+        const int p = std::rand() % 1000;
+        switch(std::rand() % 4){
+        case 0:
+        case 1:
+            if(prio.count(key)){
+                ref.erase(std::make_pair(prio[key], key));
+                h.update(key, p);
+            }else{
+                h.push(key, p);
+            }
+            prio[key] = p;
+            ref.insert(std::make_pair(p, key));
+            break;
+        case 2:
+            assert(h.erase(key) == (prio.count(key) == 1));
+            if(prio.count(key)){
+                ref.erase(std::make_pair(prio[key], key));
+                prio.erase(key);
+            }
+            break;
+        default:
+            if(!ref.empty()){
+                // ties may come out in any order
+                assert(h.top_priority() == ref.begin()->first);
+                const int top = h.top_key();
+                ref.erase(std::make_pair(prio[top], top));
+                prio.erase(top);
+                h.pop();
+            }
+        }
+        assert(h.size() == ref.size());
+    }
+    for(auto& kv : prio){
+        assert(h.contains(kv.first) && h.priority(kv.first) == kv.second);
+    }
+}
+
+void test_2(){
+    hstl::indexed_heap<int, int> h4;
+    check_against_set(h4, 100, 20000);
+    hstl::indexed_heap<int, int, std::less<int>, 2> h2(16);
+    check_against_set(h2, 300, 20000);
+    hstl::indexed_heap<unsigned, int, std::less<int>, 8> h8;
+    check_against_set(h8, 50, 20000);
+    std::cout << "indexed_heap test 2 passed" << std::endl;
+}
+
+void test_3(){
+    // max-heap of string priorities
+    hstl::indexed_heap<std::size_t, std::string, std::greater<std::string>> h;
+    h.push(0, "b");
+    h.push(5, "d");
+    h.push(2, "a");
+    assert(h.top_key() == 5);
+    h.update(2, "z");
+    assert(h.top_key() == 2 && h.top_priority() == "z");
+    h.pop();
+    h.pop();
+    assert(h.top_key() == 0 && h.size() == 1);
+    std::cout << "indexed_heap test 3 passed" << std::endl;
+}
+
+#endif
@@ -0,0 +1,7 @@
+#include "interval_tree.h"
+
+int main(){
+    test_1();
+    test_2();
+    return 0;
+}
@@ -0,0 +1,98 @@
+#ifndef TEST_INTERVAL_TREE_H
+#define TEST_INTERVAL_TREE_H
+#include "../TinySTL/interval_tree.h"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+typedef std::pair<int, int> span;
+
+// the overlaps of [lo, hi] by brute force, sorted like the tree reports them
+std::vector<span> brute_overlap(const std::vector<span>& all, int lo, int hi){
+    std::vector<span> out;
+    for(const span& s : all){
+        if(s.second >= lo && s.first <= hi){
+            out.push_back(s);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+template <typename Tree>
+std::vector<span> tree_overlap(const Tree& t, int lo, int hi){
+    std::vector<typename Tree::iterator> its;
+    t.overlap(lo, hi, std::back_inserter(its));
+    std::vector<span> out;
+    for(auto it : its){
+        out.push_back(span(it->low, it->high));
+    }
+    // equal low ends come out in insertion order
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void test_1(){
+    std::mt19937 gen(1);
+    hstl::interval_tree<int> t;
+    std::vector<span> all;
+    for(int i = 0; i < 3000; ++i){
+        int lo = static_cast<int>(gen() % 10000);
+        int hi = lo + static_cast<int>(gen() % (i % 10 == 0 ? 2000 : 50));
+        t.insert(lo, hi);
+        all.push_back(span(lo, hi));
+    }
+    assert(t.size() == 3000 && t.is_balanced());
+    for(int q = 0; q < 300; ++q){
+        int lo = static_cast<int>(gen() % 10500) - 250;
+        int hi = lo + static_cast<int>(gen() % 100);
+        assert(tree_overlap(t, lo, hi) == brute_overlap(all, lo, hi));
+        auto any = t.find_any(lo, hi);
+        if(brute_overlap(all, lo, hi).empty()){
+            assert(any == t.end());
+        }else{
+            assert(any != t.end() && any->high >= lo && any->low <= hi);
+        }
+        std::vector<hstl::interval_tree<int>::iterator> stabbed;
+        t.stab(lo, std::back_inserter(stabbed));
+        assert(stabbed.size() == brute_overlap(all, lo, lo).size());
+    }
+    std::cout << "interval_tree test 1 passed" << std::endl;
+}
+
+// erasing keeps the max-high summaries right
+void test_2(){
+    std::mt19937 gen(2);
+    hstl::interval_tree<int> t;
+    std::vector<span> all;
+    for(int i = 0; i < 2000; ++i){
+        int lo = static_cast<int>(gen() % 5000);
+        int hi = lo + static_cast<int>(gen() % 300);
+        t.insert(lo, hi);
+        all.push_back(span(lo, hi));
+    }
+    for(int round = 0; round < 1500; ++round){
+        int p = static_cast<int>(gen() % 5300);
+        std::vector<hstl::interval_tree<int>::iterator> hits;
+        t.stab(p, std::back_inserter(hits));
+        if(!hits.empty()){
+            auto victim = hits[gen() % hits.size()];
+            span s(victim->low, victim->high);
+            t.erase(victim);
+            all.erase(std::find(all.begin(), all.end(), s));
+        }
+        if(round % 100 == 0){
+            assert(t.is_balanced());
+            assert(tree_overlap(t, p - 20, p + 20) == brute_overlap(all, p - 20, p + 20));
+        }
+    }
+    assert(t.size() == all.size() && t.is_balanced());
+    t.clear();
+    assert(t.empty() && t.find_any(0, 100000) == t.end());
+    std::cout << "interval_tree test 2 passed" << std::endl;
+}
+#endif
@@ -0,0 +1,8 @@
+#include "map.h"
+
+int main(){
+    test_1();
+    test_2();
+    test_3();
+    return 0;
+}
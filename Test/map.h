@@ -0,0 +1,105 @@
+#ifndef TEST_MAP_H
+#define TEST_MAP_H
+#include "../TinySTL/map.h"
+#include <iostream>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// counts the constructions of mapped values
+struct counted{
+    static int made;
+    int value;
+
+    counted() : value(0){ ++made; }
+    explicit counted(int v) : value(v){ ++made; }
+    counted(const counted& rhs) : value(rhs.value){ ++made; }
+};
+int counted::made = 0;
+
+void test_1(){
+    std::mt19937 gen(1);
+    hstl::map<int, int> m;
+    std::map<int, int> ref;
+    for(int i = 0; i < 20000; ++i){
+        int k = static_cast<int>(gen() % 3000);
+        m[k] += i;
+        ref[k] += i;
+    }
+    assert(m.size() == ref.size());
+    auto it = m.begin();
+    for(auto& kv : ref){
+        assert(it->first == kv.first && it->second == kv.second);
+        ++it;
+    }
+    assert(it == m.end());
+    for(int k = -10; k < 3010; ++k){
+        assert(m.count(k) == ref.count(k));
+    }
+    auto r = m.insert(std::make_pair(5000, 1));
+    assert(r.second && m.at(5000) == 1);
+    r = m.insert(std::make_pair(5000, 2));
+    assert(!r.second && r.first->second == 1);
+    bool thrown = false;
+    try{
+        m.at(-1);
+    }catch(const std::out_of_range&){
+        thrown = true;
+    }
+    assert(thrown);
+    assert(m.erase(5000) == 1 && m.find(5000) == m.end());
+
+    std::cout << "map test 1 passed" << std::endl;
+}
+
+// operator[] and try_emplace build nothing for a present key
+void test_2(){
+    hstl::map<int, counted> m;
+    m[1].value = 10;
+    assert(counted::made == 1);
+    m[1].value += 1;
+    assert(counted::made == 1 && m[1].value == 11);
+    auto r = m.try_emplace(1, 99);
+    assert(!r.second && counted::made == 1 && r.first->second.value == 11);
+    r = m.try_emplace(2, 20);
+    assert(r.second && counted::made == 2 && r.first->second.value == 20);
+
+    // a present key leaves the arguments alone
+    hstl::map<std::string, std::unique_ptr<int>> owners;
+    std::unique_ptr<int> p(new int(1));
+    owners.try_emplace("a", std::move(p));
+    assert(p == nullptr);
+    std::unique_ptr<int> q(new int(2));
+    owners.try_emplace("a", std::move(q));
+    assert(q != nullptr && *owners["a"] == 1);
+    std::string key("b");
+    owners[std::move(key)].reset(new int(3));
+    assert(*owners.at("b") == 3);
+
+    std::cout << "map test 2 passed" << std::endl;
+}
+
+void test_3(){
+    hstl::multimap<std::string, int, std::less<>> mm;
+    mm.insert(std::make_pair(std::string("b"), 1));
+    mm.emplace("a", 2);
+    mm.emplace("b", 3);
+    mm.emplace("b", 4);
+    assert(mm.size() == 4 && mm.count(std::string_view("b")) == 3);
+    auto range = mm.equal_range(std::string_view("b"));
+    int expect = 1;
+    for(auto it = range.first; it != range.second; ++it){
+        // equal keys keep insertion order
+        assert(it->second == expect);
+        expect = expect == 1 ? 3 : 4;
+    }
+    assert(mm.begin()->first == "a");
+    assert(mm.erase("b") == 3 && mm.size() == 1);
+
+    std::cout << "map test 3 passed" << std::endl;
+}
+#endif
@@ -0,0 +1,9 @@
+#include "mpmc_queue.h"
+
+int main(){
+    test_1();
+    test_2();
+    test_3();
+    test_4();
+    return 0;
+}
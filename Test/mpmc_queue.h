@@ -0,0 +1,110 @@
+#ifndef TEST_MPMC_QUEUE_H
+#define TEST_MPMC_QUEUE_H
+
+#include "../TinySTL/mpmc_queue.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+
+void test_1(){
+    hstl::mpmc_queue<std::string> q(3);
+    assert(q.capacity() == 4);
+    for(int i = 0; i < 4; ++i){
+        assert(q.try_push(std::to_string(i)));
+    }
+    assert(!q.try_emplace("x"));
+    assert(q.size_approx() == 4);
+    std::string s;
+    for(int i = 0; i < 4; ++i){
+        assert(q.try_pop(s) && s == std::to_string(i));
+    }
+    assert(!q.try_pop(s));
+    // leave elements behind for the destructor
+    q.emplace(3, 'a');
+    q.push("b");
+    std::cout << "mpmc_queue test 1 passed" << std::endl;
+}
+
+struct throws_on_copy{
+    int x;
+    explicit throws_on_copy(int v) : x(v){}
+    throws_on_copy(const throws_on_copy& rhs) : x(rhs.x){
+        if(x < 0){
+            throw std::runtime_error("copy");
+        }
+    }
+    throws_on_copy(throws_on_copy&& rhs) noexcept : x(rhs.x){}
+    throws_on_copy& operator=(throws_on_copy&& rhs) noexcept { x = rhs.x; return *this; }
+};
+
+void test_2(){
+    hstl::mpmc_queue<throws_on_copy> q(4);
+    throws_on_copy bad(-1), good(1);
+    bool thrown = false;
+    try{
+        q.try_push(bad);
+    }catch(const std::runtime_error&){
+        thrown = true;
+    }
+    assert(thrown);
+    // the failed push did not claim a slot
+    assert(q.try_push(good));
+    throws_on_copy out(0);
+    assert(q.try_pop(out) && out.x == 1);
+    assert(!q.try_pop(out));
+    std::cout << "mpmc_queue test 2 passed" << std::endl;
+}
+
+void test_3(){
+    const int producers = 4, consumers = 4, per_producer = 100000;
+    hstl::mpmc_queue<int> q(256);
+    std::atomic<long long> sum(0);
+    std::atomic<int> popped(0);
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; ++p){
+        threads.emplace_back([&, p]{
+            for(int i = 0; i < per_producer; ++i){
+                q.push(p * per_producer + i);
+            }
+        });
+    }
+    for(int c = 0; c < consumers; ++c){
+        threads.emplace_back([&]{
+            int v;
+            while(popped.load() < producers * per_producer){
+                if(q.try_pop(v)){
+                    sum += v;
+                    ++popped;
+                }else{
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(auto& t : threads){
+        t.join();
+    }
+    const long long n = static_cast<long long>(producers) * per_producer;
+    assert(sum.load() == n * (n - 1) / 2);
+    std::cout << "mpmc_queue test 3 passed" << std::endl;
+}
+
+void test_4(){
+    // a narrower argument is converted to T, not written into the slot as-is
+    hstl::mpmc_queue<long long> q(2);
+    long long v = 0;
+    assert(q.try_push(0x123456789LL) && q.try_push(0x123456789LL));
+    assert(q.try_pop(v) && q.try_pop(v));
+    const int small = -1;
+    assert(q.try_emplace(small) && q.try_emplace(small));
+    assert(q.try_pop(v) && v == -1);
+    assert(q.try_pop(v) && v == -1);
+    std::cout << "mpmc_queue test 4 passed" << std::endl;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef TEST_PARALLEL_HEAP_H
+#define TEST_PARALLEL_HEAP_H
+
+#include "../TinySTL/parallel_heap.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+void test_1(){
+    hstl::thread_pool pool(3);
+    for(int n : {0, 1, 2, 3, 100, 1000, 65537, 200000}){
+        std::vector<int> v(n);
+        for(int& x : v){
+            x = std::rand();
+        }
+        std::vector<int> w = v;
+        hstl::parallel_make_heap(pool, v.begin(), v.end(), std::less<int>(), 64);
+        assert(std::is_heap(v.begin(), v.end()));
+        hstl::parallel_make_heap(pool, w.begin(), w.end(), std::greater<int>(), 64);
+        assert(std::is_heap(w.begin(), w.end(), std::greater<int>()));
+    }
+    std::vector<std::string> s;
+    for(int i = 0; i < 20000; ++i){
+        s.push_back(std::to_string(std::rand()));
+    }
+    hstl::parallel_make_heap(pool, s.begin(), s.end());
+    assert(std::is_heap(s.begin(), s.end()));
+    std::cout << "parallel_heap test 1 passed" << std::endl;
+}
+
+void test_2(){
+    hstl::thread_pool pool(3);
+    std::vector<int> v(300000);
+    for(int& x : v){
+        x = std::rand() % 100000;
+    }
+    std::vector<int> sorted = v;
+    std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+    for(int k : {0, 1, 10, 1000}){
+        std::vector<int> top(k);
+        auto end = hstl::parallel_top_k(pool, v.begin(), v.end(), top.begin(), top.end());
+        assert(end == top.end());
+        assert(std::equal(top.begin(), top.end(), sorted.begin()));
+    }
+    // too small to split
+    std::vector<int> top(50);
+    hstl::parallel_top_k(pool, v.begin(), v.begin() + 100, top.begin(), top.end(), std::greater<int>());
+    std::vector<int> head(v.begin(), v.begin() + 100);
+    std::sort(head.begin(), head.end());
+    assert(std::equal(top.begin(), top.end(), head.begin()));
+    std::cout << "parallel_heap test 2 passed" << std::endl;
+}
+
+#endif
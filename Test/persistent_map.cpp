@@ -0,0 +1,8 @@
+#include "persistent_map.h"
+
+int main(){
+    test_1();
+    test_2();
+    test_3();
+    return 0;
+}
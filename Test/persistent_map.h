@@ -0,0 +1,176 @@
+#ifndef TEST_PERSISTENT_MAP_H
+#define TEST_PERSISTENT_MAP_H
+
+#include "../TinySTL/persistent_map.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+typedef std::vector<std::pair<int, std::string>> entries;
+
+template <typename Map>
+entries contents(const Map& m){
+    entries out;
+    for(auto it = m.begin(); it != m.end(); ++it){
+        out.emplace_back(it->first, it->second);
+    }
+    return out;
+}
+
+// every version keeps what it had while later ones are derived from it
+void test_1(){
+    std::mt19937 gen(50);
+    std::vector<hstl::persistent_map<int, std::string>> versions(1);
+    std::vector<std::map<int, std::string>> refs(1);
+    for(int i = 0; i < 3000; ++i){
+        const int k = static_cast<int>(gen() % 400);
+        const std::string v = std::to_string(i);
+        const hstl::persistent_map<int, std::string>& from = versions[gen() % versions.size() / 2 + versions.size() / 2];
+        const std::map<int, std::string>& ref = refs[&from - versions.data()];
+        std::map<int, std::string> next_ref(ref);
+        hstl::persistent_map<int, std::string> next;
+        switch(gen() % 3){
+        case 0:
+            next = from.insert(std::make_pair(k, v));
+            next_ref.emplace(k, v);
+            break;
+        case 1:
+            next = from.insert_or_assign(k, v);
+            next_ref[k] = v;
+            break;
+        default:
+            next = from.erase(k);
+            next_ref.erase(k);
+            break;
+        }
+        assert(next.size() == next_ref.size() && next.tree().is_balanced());
+        versions.push_back(next);
+        refs.push_back(next_ref);
+    }
+    for(size_t i = 0; i < versions.size(); i += 7){
+        assert(contents(versions[i]) == entries(refs[i].begin(), refs[i].end()));
+    }
+
+    const hstl::persistent_map<int, std::string>& m = versions.back();
+    const std::map<int, std::string>& ref = refs.back();
+    entries backward;
+    for(auto it = m.end(); it != m.begin(); ){
+        --it;
+        backward.emplace_back(it->first, it->second);
+    }
+    assert(entries(backward.rbegin(), backward.rend()) == entries(ref.begin(), ref.end()));
+    for(int k = -1; k <= 401; ++k){
+        assert(m.count(k) == ref.count(k));
+        assert((m.find(k) == m.end()) == (ref.find(k) == ref.end()));
+        auto lb = m.lower_bound(k);
+        auto ub = m.upper_bound(k);
+        assert(lb == m.end() ? ref.lower_bound(k) == ref.end() : lb->first == ref.lower_bound(k)->first);
+        assert(ub == m.end() ? ref.upper_bound(k) == ref.end() : ub->first == ref.upper_bound(k)->first);
+    }
+    bool thrown = false;
+    try{
+        m.at(-1);
+    }catch(const std::out_of_range&){
+        thrown = true;
+    }
+    assert(thrown && m.at(ref.begin()->first) == ref.begin()->second);
+    entries range;
+    m.for_each(100, 200, [&](const std::pair<const int, std::string>& e){ range.emplace_back(e.first, e.second); });
+    assert(range == entries(ref.lower_bound(100), ref.lower_bound(200)));
+    std::cout << "persistent_map test 1 passed" << std::endl;
+}
+
+struct counted{
+    static std::atomic<int> live;
+    int x;
+    explicit counted(int v) : x(v){ ++live; }
+    counted(const counted& rhs) : x(rhs.x){ ++live; }
+    counted& operator=(const counted& rhs){ x = rhs.x; return *this; }
+    ~counted(){ --live; }
+};
+std::atomic<int> counted::live(0);
+
+// a new version holds O(log n) new nodes, and an update on an rvalue nobody else shares
+// copies none
+void test_2(){
+    typedef hstl::persistent_map<int, counted> cmap;
+    {
+        std::vector<std::pair<int, counted>> in;
+        for(int i = 0; i < 1024; ++i){
+            in.emplace_back(i, counted(i));
+        }
+        cmap a(in.begin(), in.end());
+        in.clear();
+        assert(counted::live == 1024 && a.tree().is_balanced());
+
+        cmap b = a.insert_or_assign(500, counted(-1));
+        const int copied = counted::live - 1024;
+        assert(copied > 0 && copied <= 2 * 21);
+        assert(a.at(500).x == 500 && b.at(500).x == -1);
+        cmap c = b.erase(3);
+        assert(counted::live - 1024 - copied <= 2 * 21);
+        assert(a.count(3) == 1 && b.count(3) == 1 && c.count(3) == 0);
+
+        // b and c go, a is alone again and is updated in place
+        b = cmap();
+        c = cmap();
+        assert(counted::live == 1024);
+        a = std::move(a).insert_or_assign(7, counted(-7));
+        assert(counted::live == 1024 && a.at(7).x == -7);
+        for(int i = 0; i < 1024; i += 2){
+            a = std::move(a).erase(i);
+            assert(counted::live == static_cast<int>(a.size()));
+        }
+        assert(a.size() == 512 && a.tree().is_balanced());
+    }
+    assert(counted::live == 0);
+    std::cout << "persistent_map test 2 passed" << std::endl;
+}
+
+// versions sharing nodes are copied, updated and dropped on several threads at once
+void test_3(){
+    typedef hstl::persistent_map<int, counted> cmap;
+    {
+        cmap base;
+        for(int i = 0; i < 5000; ++i){
+            base = std::move(base).insert_or_assign(i, counted(i));
+        }
+        std::vector<std::thread> threads;
+        for(int t = 0; t < 4; ++t){
+            threads.emplace_back([&base, t]{
+                std::mt19937 gen(t);
+                cmap mine = base;
+                std::vector<cmap> kept;
+                for(int i = 0; i < 2000; ++i){
+                    const int k = static_cast<int>(gen() % 6000);
+                    mine = gen() % 2 == 0 ? mine.insert_or_assign(k, counted(k)) : mine.erase(k);
+                    if(i % 100 == 0){
+                        kept.push_back(mine);
+                    }
+                }
+                int prev = -1;
+                mine.for_each([&](const std::pair<const int, counted>& e){
+                    assert(e.first > prev && e.second.x == e.first);
+                    prev = e.first;
+                });
+                assert(mine.tree().is_balanced());
+            });
+        }
+        for(auto& t : threads){
+            t.join();
+        }
+        assert(counted::live == 5000 && base.size() == 5000 && base.tree().is_balanced());
+    }
+    assert(counted::live == 0);
+    std::cout << "persistent_map test 3 passed" << std::endl;
+}
+
+#endif
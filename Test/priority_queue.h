@@ -0,0 +1,107 @@
+#ifndef TEST_PRIORITY_QUEUE_H
+#define TEST_PRIORITY_QUEUE_H
+
+#include "../TinySTL/priority_queue.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+
+void test_1(){
+    hstl::priority_queue<int> q;
+    assert(q.empty());
+    int a[] = {5, 1, 9, 3, 7};
+    for(int x : a){
+        q.push(x);
+    }
+    assert(q.size() == 5 && q.top() == 9);
+    q.emplace(11);
+    assert(q.top() == 11);
+    int expect[] = {11, 9, 7, 5, 3, 1};
+    for(int x : expect){
+        assert(q.top() == x);
+        q.pop();
+    }
+    assert(q.empty());
+
+    // min-heap, range constructor
+    const char* words[] = {"pear", "apple", "fig", "banana"};
+    hstl::priority_queue<std::string, hstl::vector<std::string>, std::greater<std::string>> w(words, words + 4);
+    assert(w.top() == "apple");
+    w.pop();
+    assert(w.top() == "banana");
+    std::cout << "priority_queue test 1 passed" << std::endl;
+}
+
+void test_2(){
+    // push_range against std::priority_queue, both the push and the rebuild path
+    hstl::priority_queue<int> q;
+    std::priority_queue<int> ref;
+    for(int round = 0; round < 50; ++round){
+        std::vector<int> batch(std::rand() % (round % 5 == 0 ? 200 : 10));
+        for(int& x : batch){
+            x = std::rand() % 1000;
+            ref.push(x);
+        }
+        q.push_range(batch.begin(), batch.end());
+        assert(q.size() == ref.size());
+        std::vector<int> out;
+        q.pop_n(std::back_inserter(out), 3);
+        for(int x : out){
+            assert(x == ref.top());
+            ref.pop();
+        }
+        assert(q.empty() || q.top() == ref.top());
+    }
+    // pop_n stops when empty
+    std::vector<int> rest;
+    q.pop_n(std::back_inserter(rest), q.size() + 10);
+    assert(q.empty() && rest.size() == ref.size());
+    for(int x : rest){
+        assert(x == ref.top());
+        ref.pop();
+    }
+    std::cout << "priority_queue test 2 passed" << std::endl;
+}
+
+struct deref_less{
+    bool operator()(const std::unique_ptr<int>& x, const std::unique_ptr<int>& y) const { return *x < *y; }
+};
+
+void test_3(){
+    hstl::priority_queue<int> q;
+    // pushpop on an empty queue or with a larger value returns the value untouched
+    assert(q.pushpop(4) == 4 && q.empty());
+    int a[] = {5, 1, 9, 3, 7};
+    q.push_range(a, a + 5);
+    assert(q.pushpop(10) == 10 && q.size() == 5);
+    assert(q.pushpop(6) == 9 && q.top() == 7);
+    assert(q.replace_top(0) == 7 && q.top() == 6 && q.size() == 5);
+    assert(q.replace_top(8) == 6 && q.top() == 8);
+    int expect[] = {8, 5, 3, 1, 0};
+    for(int x : expect){
+        assert(q.top() == x);
+        q.pop();
+    }
+
+    // move-only elements
+    typedef hstl::priority_queue<std::unique_ptr<int>, hstl::vector<std::unique_ptr<int>>, deref_less> ptr_queue;
+    ptr_queue p;
+    for(int i = 0; i < 10; ++i){
+        p.emplace(new int(i));
+    }
+    std::unique_ptr<int> top = p.replace_top(std::unique_ptr<int>(new int(-1)));
+    assert(*top == 9 && *p.top() == 8);
+    ptr_queue o;
+    o.swap(p);
+    assert(p.empty() && o.size() == 10);
+    std::cout << "priority_queue test 3 passed" << std::endl;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef TEST_RADIX_HEAP_H
+#define TEST_RADIX_HEAP_H
+
+#include "../TinySTL/radix_heap.h"
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+void test_1(){
+    hstl::radix_heap<unsigned, std::string> h;
+    assert(h.empty());
+    h.push(5u, "five");
+    h.push(1u, "one");
+    h.emplace(9u, 3, 'n');
+    h.push(1u, "uno");
+    assert(h.size() == 4 && h.top_key() == 1);
+    h.pop();
+    assert(h.top_key() == 1);
+    h.pop();
+    // 1 has been returned, keys from 1 on may still be pushed
+    assert(h.min_key() == 1);
+    h.push(3u, "three");
+    assert(h.top_key() == 3 && h.top_value() == "three");
+    h.pop();
+    assert(h.top_key() == 5 && h.top_value() == "five");
+    h.pop();
+    assert(h.top_key() == 9 && h.top_value() == "nnn");
+    h.pop();
+    assert(h.empty());
+    h.push(100u, "x");
+    h.clear();
+    assert(h.empty());
+    std::cout << "radix_heap test 1 passed" << std::endl;
+}
+
+// monotone random workload against std::priority_queue
+template <typename Key>
+void check_monotone(Key range, int ops){
+    typedef std::pair<Key, int> item;
+    hstl::radix_heap<Key, int> h;
+    std::priority_queue<item, std::vector<item>, std::greater<item>> ref;
+    Key last = 0;
+    for(int i = 0; i < ops; ++i){
+        if(ref.empty() || std::rand() % 3 != 0){
+            const Key key = static_cast<Key>(last + static_cast<Key>(std::rand()) % range);
+            if(key < last){
+                continue;   // wrapped around
+            }
+            h.push(key, i);
+            ref.push(item(key, i));
+        }else{
+            assert(h.top_key() == ref.top().first);
+            last = ref.top().first;
+            h.pop();
+            ref.pop();
+        }
+        assert(h.size() == ref.size());
+    }
+    while(!ref.empty()){
+        assert(h.top_key() == ref.top().first);
+        h.pop();
+        ref.pop();
+    }
+    assert(h.empty());
+}
+
+void test_2(){
+    check_monotone<std::uint8_t>(8, 20000);
+    check_monotone<std::uint16_t>(100, 20000);
+    check_monotone<std::uint32_t>(1000, 50000);
+    check_monotone<std::uint64_t>(1000000, 50000);
+    std::cout << "radix_heap test 2 passed" << std::endl;
+}
+
+void test_3(){
+    // extreme keys
+    hstl::radix_heap<std::uint64_t, int> h;
+    const std::uint64_t top = ~std::uint64_t(0);
+    h.push(top, 1);
+    h.push(0, 2);
+    h.push(top - 1, 3);
+    assert(h.top_key() == 0 && h.top_value() == 2);
+    h.pop();
+    assert(h.top_key() == top - 1);
+    h.pop();
+    h.push(top, 4);
+    assert(h.top_key() == top);
+    h.pop();
+    assert(h.top_key() == top && h.size() == 1);
+    std::cout << "radix_heap test 3 passed" << std::endl;
+}
+
+#endif
@@ -5,6 +5,17 @@ int main(){
     test_2();
     test_3();
     test_4();
+    test_5();
+    test_6();
+    test_7();
+    test_8();
+    test_9();
+    test_10();
+    test_11();
+    test_12();
+    test_13();
+    test_14();
+    test_15();
 
     return 0;
 }
\ No newline at end of file
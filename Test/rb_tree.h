@@ -1,11 +1,28 @@
 #ifndef TEST_RB_TREE_H
 #define TEST_RB_TREE_H
 #include "../TinySTL/rb_tree.h"
+#include "../TinySTL/map.h"
+#include "../TinySTL/set.h"
+#include "../TinySTL/thread_pool.h"
 #include <iostream>
 #include <cassert>
 #include <vector>
 #include <random>
 #include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <type_traits>
+#include <atomic>
+
+// the node layout the suite runs on, rb_tree_compact.cpp runs it again on compact nodes
+#ifndef TEST_RB_TREE_NODE_BASE
+#define TEST_RB_TREE_NODE_BASE hstl::rb_tree_node_base
+#endif
+
+template <typename T, typename Compare, typename KeyOfValue = hstl::identity<T>, typename Augment = hstl::rb_tree_no_augment>
+using test_rb_tree = hstl::rb_tree<T, Compare, KeyOfValue, Augment, TEST_RB_TREE_NODE_BASE>;
 
 
 void test_1(){
@@ -18,7 +35,7 @@ void test_1(){
         v.push_back(dist(gen));
     }
 
-    hstl::rb_tree<int, std::less<int>> rb_tree;
+    test_rb_tree<int, std::less<int>> rb_tree;
     for(int i = 0; i < 10000; ++i){
         rb_tree.insert_equal(v[i]);
     }
@@ -37,7 +54,7 @@ void test_2(){
         v.push_back(dist(gen));
     }
 
-    hstl::rb_tree<int, std::greater<int>> rb_tree;
+    test_rb_tree<int, std::greater<int>> rb_tree;
     for(int i = 0; i < 10000; ++i){
         rb_tree.insert_equal(v[i]);
     }
@@ -60,7 +77,7 @@ void test_3(){
         v.push_back(dist(gen));
     }
 
-    hstl::rb_tree<int, std::greater<int>> rb_tree;
+    test_rb_tree<int, std::greater<int>> rb_tree;
     for(int i = 0; i < 10000; ++i){
         rb_tree.insert_equal(v[i]);
     }
@@ -80,7 +97,7 @@ void test_3(){
 void test_4(){
 
     std::vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8, 9};
-    hstl::rb_tree<int, std::less<int>> rb_tree;
+    test_rb_tree<int, std::less<int>> rb_tree;
     for(int i = 0; i < 9; ++i){
         rb_tree.insert_equal(v[i]);
     }
@@ -96,4 +113,585 @@ void test_4(){
     assert(rb_tree.size() == 1);
     std::cout << "rb_tree test 4 passed" << std::endl;
 }
-#endif
\ No newline at end of file
+
+void test_5(){
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<> dist(1, 500);
+
+    std::vector<int> v;
+    for(int i = 0; i < 5000; ++i){
+        v.push_back(dist(gen) * 2); // even keys only, odd ones are misses
+    }
+    test_rb_tree<int, std::less<int>> rb_tree;
+    for(int i = 0; i < 5000; ++i){
+        rb_tree.insert_equal(v[i]);
+    }
+    std::sort(v.begin(), v.end());
+    const auto& crb_tree = rb_tree;
+    for(int k = 0; k <= 1002; ++k){
+        auto lo = std::lower_bound(v.begin(), v.end(), k);
+        auto hi = std::upper_bound(v.begin(), v.end(), k);
+        auto it = rb_tree.find(k);
+        if(lo == hi){
+            assert(it == rb_tree.end());
+        }else{
+            assert(it != rb_tree.end() && *it == k);
+        }
+        auto l = rb_tree.lower_bound(k);
+        assert(lo == v.end() ? l == rb_tree.end() : *l == *lo);
+        auto u = crb_tree.upper_bound(k);
+        assert(hi == v.end() ? u == crb_tree.end() : *u == *hi);
+        auto range = rb_tree.equal_range(k);
+        assert(range.first == l && range.second == u);
+        assert(rb_tree.count(k) == static_cast<size_t>(hi - lo));
+    }
+
+    test_rb_tree<int, std::greater<int>> desc;
+    for(int i = 0; i < 100; ++i){
+        desc.insert_equal(i);
+    }
+    assert(*desc.lower_bound(50) == 50);
+    assert(*desc.upper_bound(50) == 49);
+    assert(desc.upper_bound(0) == desc.end());
+    assert(desc.find(100) == desc.end());
+
+    std::cout << "rb_tree test 5 passed" << std::endl;
+}
+
+// heterogeneous lookup with a transparent comparator
+void test_6(){
+    test_rb_tree<std::string, std::less<>> rb_tree;
+    const char* words[] = {"pear", "apple", "fig", "apple", "plum", "kiwi"};
+    for(const char* w : words){
+        rb_tree.insert_equal(std::string(w));
+    }
+    std::string_view key("apple");
+    assert(rb_tree.count(key) == 2);
+    assert(*rb_tree.find(key) == "apple");
+    assert(rb_tree.find(std::string_view("grape")) == rb_tree.end());
+    assert(*rb_tree.lower_bound(std::string_view("grape")) == "kiwi");
+    assert(*rb_tree.upper_bound("kiwi") == "pear");
+    auto range = rb_tree.equal_range(std::string_view("plum"));
+    assert(*range.first == "plum" && range.second == rb_tree.end());
+
+    std::cout << "rb_tree test 6 passed" << std::endl;
+}
+
+// unique insertion on a tree keyed by the first member
+void test_7(){
+    typedef std::pair<int, std::string> entry;
+    test_rb_tree<entry, std::less<int>, hstl::select1st<entry>> rb_tree;
+    std::mt19937 gen(7);
+    std::vector<int> keys;
+    for(int i = 0; i < 2000; ++i){
+        int k = static_cast<int>(gen() % 500);
+        auto r = rb_tree.insert_unique(entry(k, std::to_string(i)));
+        bool fresh = std::find(keys.begin(), keys.end(), k) == keys.end();
+        assert(r.second == fresh && r.first->first == k);
+        if(fresh){
+            keys.push_back(k);
+        }
+    }
+    assert(rb_tree.size() == keys.size());
+    std::sort(keys.begin(), keys.end());
+    auto it = rb_tree.begin();
+    for(size_t i = 0; i < keys.size(); ++i, ++it){
+        assert(it->first == keys[i]);
+    }
+    assert(it == rb_tree.end());
+
+    auto e = rb_tree.emplace_unique(1000, "x");
+    assert(e.second && e.first->second == "x");
+    e = rb_tree.emplace_unique(1000, "y");
+    assert(!e.second && e.first->second == "x");
+
+    auto t = rb_tree.try_emplace(1000, 1000, "z");
+    assert(!t.second && t.first->second == "x");
+    t = rb_tree.try_emplace(-1, -1, "neg");
+    assert(t.second && rb_tree.begin()->second == "neg");
+
+    assert(rb_tree.erase(1000) == 1);
+    assert(rb_tree.erase(1000) == 0);
+    assert(rb_tree.size() == keys.size() + 1);
+
+    std::cout << "rb_tree test 7 passed" << std::endl;
+}
+
+// hinted insertion and the sorted bulk build
+void test_8(){
+    for(int n = 0; n < 300; ++n){
+        std::vector<int> v;
+        for(int i = 0; i < n; ++i){
+            v.push_back(i / 3);
+        }
+        test_rb_tree<int, std::less<int>> rb_tree(hstl::sorted_range_tag(), v.begin(), v.end());
+        assert(rb_tree.size() == static_cast<size_t>(n) && rb_tree.is_balanced());
+        auto it = rb_tree.begin();
+        for(int i = 0; i < n; ++i, ++it){
+            assert(*it == v[i]);
+        }
+        assert(it == rb_tree.end());
+        if(n > 0){
+            rb_tree.erase(rb_tree.begin());
+            rb_tree.insert_equal(n);
+            assert(rb_tree.is_balanced());
+        }
+    }
+
+    test_rb_tree<int, std::less<int>> rb_tree;
+    for(int i = 0; i < 1000; ++i){
+        rb_tree.insert_hint(rb_tree.end(), i);
+    }
+    assert(rb_tree.is_balanced());
+    // right hint in the middle, equal keys, a wrong hint
+    auto pos = rb_tree.find(500);
+    auto it = rb_tree.insert_hint(pos, 500);
+    assert(*it == 500 && ++it == pos);
+    it = rb_tree.insert_hint(rb_tree.begin(), -1);
+    assert(it == rb_tree.begin());
+    it = rb_tree.insert_hint(rb_tree.begin(), 2000);
+    assert(*it == 2000 && ++it == rb_tree.end());
+    it = rb_tree.insert_hint(rb_tree.find(10), 700);
+    assert(*it == 700);
+    assert(rb_tree.size() == 1004 && rb_tree.count(500) == 2 && rb_tree.count(700) == 2);
+    assert(rb_tree.is_balanced());
+
+    std::mt19937 gen(8);
+    std::vector<int> v;
+    for(int i = 0; i < 5000; ++i){
+        v.push_back(static_cast<int>(gen() % 1000));
+    }
+    rb_tree.assign_sorted(v.begin(), v.begin()); // empties it
+    assert(rb_tree.empty() && rb_tree.is_balanced());
+    for(int x : v){
+        rb_tree.insert_hint(rb_tree.lower_bound(x), x);
+    }
+    std::sort(v.begin(), v.end());
+    it = rb_tree.begin();
+    for(int x : v){
+        assert(*it++ == x);
+    }
+    assert(rb_tree.is_balanced());
+    rb_tree.assign_sorted(v.begin(), v.end());
+    assert(rb_tree.size() == v.size() && rb_tree.is_balanced() && rb_tree.count(v[0]) == static_cast<size_t>(std::count(v.begin(), v.end(), v[0])));
+
+    std::cout << "rb_tree test 8 passed" << std::endl;
+}
+
+// counts live instances
+struct tracked{
+    static std::atomic<int> live;  // freed from pool threads by the parallel set operations
+    static int copies_left; // a copy throws when this reaches 0, negative never
+    int value;
+
+    tracked(int v) : value(v){ ++live; }
+    tracked(const tracked& rhs) : value(rhs.value){
+        if(copies_left >= 0 && copies_left-- == 0){
+            throw std::runtime_error("tracked copy");
+        }
+        ++live;
+    }
+    ~tracked(){ --live; }
+    bool operator<(const tracked& rhs) const{ return value < rhs.value; }
+};
+std::atomic<int> tracked::live(0);
+int tracked::copies_left = -1;
+
+// clear, copy, move and teardown
+void test_9(){
+    std::mt19937 gen(9);
+    {
+        test_rb_tree<tracked, std::less<tracked>> a;
+        for(int i = 0; i < 3000; ++i){
+            a.insert_equal(tracked(static_cast<int>(gen() % 1000)));
+        }
+        assert(tracked::live == 3000);
+
+        test_rb_tree<tracked, std::less<tracked>> b(a);
+        assert(tracked::live == 6000 && b.size() == a.size() && b.is_balanced());
+        for(auto x = a.begin(), y = b.begin(); x != a.end(); ++x, ++y){
+            assert(x->value == y->value && &*x != &*y);
+        }
+        b.erase(b.begin());
+        assert(a.size() == 3000 && b.size() == 2999 && b.is_balanced());
+
+        test_rb_tree<tracked, std::less<tracked>> c(std::move(b));
+        assert(b.empty() && b.is_balanced() && c.size() == 2999 && c.is_balanced());
+        b.insert_equal(tracked(1));
+        assert(b.size() == 1 && tracked::live == 6000);
+
+        b = c;
+        assert(b.size() == 2999 && tracked::live == 8998 && b.is_balanced());
+        b = b;
+        assert(b.size() == 2999);
+        c = std::move(a);
+        assert(c.size() == 3000 && a.empty() && tracked::live == 5999);
+
+        // a copy that fails half way frees what it built
+        tracked::copies_left = 1500;
+        bool thrown = false;
+        try{
+            test_rb_tree<tracked, std::less<tracked>> d(c);
+        }catch(const std::runtime_error&){
+            thrown = true;
+        }
+        tracked::copies_left = -1;
+        assert(thrown && tracked::live == 5999);
+
+        c.clear();
+        assert(c.empty() && c.is_balanced() && tracked::live == 2999);
+        c.insert_equal(tracked(5));
+        assert(c.size() == 1 && c.begin()->value == 5);
+        c.swap(b);
+        assert(c.size() == 2999 && b.size() == 1 && b.begin()->value == 5);
+    }
+    assert(tracked::live == 0);
+
+    // teardown of a large tree and of a sorted build
+    {
+        test_rb_tree<int, std::less<int>> big;
+        for(int i = 0; i < 200000; ++i){
+            big.insert_hint(big.end(), i);
+        }
+        test_rb_tree<int, std::less<int>> copy(big);
+        assert(copy.size() == 200000 && copy.is_balanced());
+        copy.assign_sorted(big.begin(), big.end());
+        assert(copy.size() == 200000 && copy.is_balanced());
+    }
+
+    std::cout << "rb_tree test 9 passed" << std::endl;
+}
+
+// order statistics kept through insertion, erasure and the bulk paths
+void test_10(){
+    typedef test_rb_tree<int, std::less<int>, hstl::identity<int>, hstl::rb_tree_order_statistic> os_tree;
+    std::mt19937 gen(10);
+    os_tree rb_tree;
+    std::vector<int> ref;
+    for(int round = 0; round < 4000; ++round){
+        int k = static_cast<int>(gen() % 1000);
+        if(ref.empty() || gen() % 3 != 0){
+            rb_tree.insert_equal(k);
+            ref.insert(std::upper_bound(ref.begin(), ref.end(), k), k);
+        }else{
+            size_t i = gen() % ref.size();
+            auto it = rb_tree.select(i);
+            assert(*it == ref[i] && rb_tree.rank(it) == i);
+            rb_tree.erase(it);
+            ref.erase(ref.begin() + i);
+        }
+        if(round % 500 == 0){
+            assert(rb_tree.is_balanced());
+        }
+    }
+    assert(rb_tree.is_balanced() && rb_tree.size() == ref.size());
+    for(size_t i = 0; i < ref.size(); ++i){
+        assert(*rb_tree.select(i) == ref[i]);
+    }
+    assert(rb_tree.select(ref.size()) == rb_tree.end());
+    assert(rb_tree.rank(rb_tree.end()) == ref.size());
+    for(int k = 0; k < 1000; k += 37){
+        auto lo = std::lower_bound(ref.begin(), ref.end(), k) - ref.begin();
+        auto hi = std::upper_bound(ref.begin(), ref.end(), k) - ref.begin();
+        assert(rb_tree.rank(rb_tree.lower_bound(k)) == static_cast<size_t>(lo));
+        assert(rb_tree.distance(rb_tree.lower_bound(k), rb_tree.upper_bound(k)) == hi - lo);
+        assert(rb_tree.distance(rb_tree.upper_bound(k), rb_tree.lower_bound(k)) == lo - hi);
+    }
+
+    os_tree copy(rb_tree);
+    assert(copy.is_balanced() && *copy.select(ref.size() / 2) == ref[ref.size() / 2]);
+    copy.assign_sorted(ref.begin(), ref.end());
+    assert(copy.is_balanced() && copy.rank(copy.find(ref[7])) <= 7);
+    for(int i = 0; i < 100; ++i){
+        copy.insert_hint(copy.end(), 1000 + i);
+    }
+    assert(copy.is_balanced() && *copy.select(ref.size() + 99) == 1099);
+
+    std::cout << "rb_tree test 10 passed" << std::endl;
+}
+
+// a non-commutative monoid: the concatenation of the elements in order
+struct concat_monoid{
+    typedef std::string summary_type;
+
+    static summary_type identity(){ return std::string(); }
+    static summary_type lift(int x){ return std::to_string(x) + ","; }
+    static summary_type combine(const summary_type& a, const summary_type& b){ return a + b; }
+};
+
+struct sum_monoid{
+    typedef long long summary_type;
+
+    static summary_type identity(){ return 0; }
+    static summary_type lift(int x){ return x; }
+    static summary_type combine(summary_type a, summary_type b){ return a + b; }
+};
+
+// range folds over a monoid summary
+void test_11(){
+    std::mt19937 gen(11);
+    test_rb_tree<int, std::less<int>, hstl::identity<int>, hstl::rb_tree_monoid_augment<sum_monoid>> sums;
+    test_rb_tree<int, std::less<int>, hstl::identity<int>, hstl::rb_tree_monoid_augment<concat_monoid>> concat;
+    std::vector<int> ref;
+    for(int i = 0; i < 3000; ++i){
+        int k = static_cast<int>(gen() % 2000);
+        sums.insert_equal(k);
+        concat.insert_equal(k);
+        ref.insert(std::upper_bound(ref.begin(), ref.end(), k), k);
+        if(i % 3 == 2){
+            int e = ref[gen() % ref.size()];
+            sums.erase(sums.find(e));
+            concat.erase(concat.find(e));
+            ref.erase(std::lower_bound(ref.begin(), ref.end(), e));
+        }
+    }
+    assert(sums.is_balanced() && concat.is_balanced());
+    for(int q = 0; q < 500; ++q){
+        int lo = static_cast<int>(gen() % 2100) - 50;
+        int hi = lo + static_cast<int>(gen() % 600);
+        long long sum = 0;
+        std::string cat;
+        for(int x : ref){
+            if(lo <= x && x < hi){
+                sum += x;
+                cat += std::to_string(x) + ",";
+            }
+        }
+        assert(sums.fold(lo, hi) == sum);
+        assert(concat.fold(lo, hi) == cat);
+    }
+    assert(sums.fold(5, 5) == 0 && concat.fold(3000, 4000).empty());
+
+    std::cout << "rb_tree test 11 passed" << std::endl;
+}
+
+void test_12(){
+    std::mt19937 gen(12);
+    for(int round = 0; round < 40; ++round){
+        const int n = static_cast<int>(gen() % 3000);
+        test_rb_tree<int, std::less<int>, hstl::identity<int>, hstl::rb_tree_order_statistic> counted;
+        test_rb_tree<int, std::less<int>, hstl::identity<int>, hstl::rb_tree_monoid_augment<concat_monoid>> concat;
+        std::vector<int> ref;
+        for(int i = 0; i < n; ++i){
+            int k = static_cast<int>(gen() % 1000);
+            counted.insert_equal(k);
+            concat.insert_equal(k);
+            ref.push_back(k);
+        }
+        std::sort(ref.begin(), ref.end());
+        int k = static_cast<int>(gen() % 1100) - 50;
+        auto right = counted.split(k);
+        auto concat_right = concat.split(k);
+        const std::size_t cut = std::lower_bound(ref.begin(), ref.end(), k) - ref.begin();
+        assert(counted.is_balanced() && right.is_balanced() && concat.is_balanced() && concat_right.is_balanced());
+        assert(counted.size() == cut && right.size() == ref.size() - cut && concat_right.size() == right.size());
+        assert(std::equal(counted.begin(), counted.end(), ref.begin()));
+        assert(std::equal(right.begin(), right.end(), ref.begin() + cut));
+
+        // join back, and again after splitting one side at an arbitrary point
+        counted.join(right);
+        concat.join(concat_right);
+        assert(right.empty() && right.is_balanced() && concat_right.empty());
+        assert(counted.is_balanced() && concat.is_balanced() && counted.size() == ref.size());
+        assert(std::equal(counted.begin(), counted.end(), ref.begin()));
+        auto tail = counted.split(static_cast<int>(gen() % 1000));
+        test_rb_tree<int, std::less<int>, hstl::identity<int>, hstl::rb_tree_order_statistic> head;
+        head.join(counted);
+        head.join(tail);
+        assert(head.is_balanced() && counted.empty() && tail.empty() && head.size() == ref.size());
+        assert(std::equal(head.begin(), head.end(), ref.begin()));
+    }
+
+    std::cout << "rb_tree test 12 passed" << std::endl;
+}
+
+template <typename Tree>
+Tree unique_tree(std::mt19937& gen, int n, int range, std::vector<int>& ref){
+    Tree t;
+    ref.clear();
+    for(int i = 0; i < n; ++i){
+        int k = static_cast<int>(gen() % range);
+        if(t.insert_unique(k).second){
+            ref.push_back(k);
+        }
+    }
+    std::sort(ref.begin(), ref.end());
+    return t;
+}
+
+void test_13(){
+    typedef test_rb_tree<int, std::less<int>> tree;
+    std::mt19937 gen(13);
+    hstl::thread_pool pool(4);
+    for(int round = 0; round < 60; ++round){
+        // sizes from empty to lopsided to large enough for the pool to fork
+        const int n1 = round % 10 == 0 ? 0 : static_cast<int>(gen() % (round < 50 ? 2000 : 40000));
+        const int n2 = round % 7 == 0 ? 3 : static_cast<int>(gen() % (round < 50 ? 2000 : 40000));
+        const int range = round % 2 == 0 ? 3000 : 100000;
+        std::vector<int> r1, r2, expect;
+        for(int op = 0; op < 6; ++op){
+            tree a = unique_tree<tree>(gen, n1, range, r1);
+            tree b = unique_tree<tree>(gen, n2, range, r2);
+            expect.clear();
+            switch(op % 3){
+            case 0:
+                std::set_union(r1.begin(), r1.end(), r2.begin(), r2.end(), std::back_inserter(expect));
+                op < 3 ? a.union_with(b) : a.union_with(b, pool);
+                break;
+            case 1:
+                std::set_intersection(r1.begin(), r1.end(), r2.begin(), r2.end(), std::back_inserter(expect));
+                op < 3 ? a.intersect_with(b) : a.intersect_with(b, pool);
+                break;
+            default:
+                std::set_difference(r1.begin(), r1.end(), r2.begin(), r2.end(), std::back_inserter(expect));
+                op < 3 ? a.difference_with(b) : a.difference_with(b, pool);
+                break;
+            }
+            assert(a.is_balanced() && b.empty() && b.is_balanced());
+            assert(a.size() == expect.size() && std::equal(a.begin(), a.end(), expect.begin()));
+        }
+    }
+
+    // every node is kept or freed exactly once, and the left element of a match is kept
+    {
+        test_rb_tree<tracked, std::less<tracked>> a, b, c;
+        for(int i = 0; i < 500; ++i){
+            a.insert_unique(tracked(2 * i));
+            b.insert_unique(tracked(3 * i));
+            c.insert_unique(tracked(5 * i));
+        }
+        const tracked* kept = &*a.find(tracked(0));
+        a.union_with(b);
+        assert(tracked::live == 1333 && a.size() == 833 && b.empty() && &*a.find(tracked(0)) == kept);
+        a.intersect_with(c);
+        assert(tracked::live == 166 && a.size() == 166 && c.empty() && a.is_balanced());
+        for(int i = 0; i < 100; ++i){
+            b.insert_unique(tracked(5 * i));
+        }
+        a.difference_with(b);
+        assert(tracked::live == 99 && a.size() == 99 && b.empty() && a.is_balanced());
+        a.union_with(a);
+        assert(a.size() == 99);
+        a.difference_with(a);
+        assert(a.empty() && tracked::live == 0);
+    }
+
+    std::cout << "rb_tree test 13 passed" << std::endl;
+}
+// both layouts in one program: the layout is part of the tree type, so trees, maps and
+// sets of either kind are separate types that work side by side
+void test_14(){
+    typedef hstl::rb_tree<long long, std::less<long long>> plain_tree;
+    typedef hstl::rb_tree<long long, std::less<long long>, hstl::identity<long long>, hstl::rb_tree_no_augment, hstl::rb_tree_compact_node_base> compact_tree;
+    static_assert(sizeof(hstl::rb_tree_compact_node_base) == 3 * sizeof(void*), "compact links are three words");
+    static_assert(sizeof(compact_tree::node_type) < sizeof(plain_tree::node_type), "compact nodes are smaller");
+    static_assert(!std::is_same<plain_tree::iterator, compact_tree::iterator>::value, "the layout is part of the iterator type");
+
+    std::mt19937 gen(14);
+    plain_tree plain;
+    compact_tree compact;
+    hstl::map<int, int, std::less<int>, hstl::rb_tree_compact_node_base> m;
+    hstl::multiset<int, std::less<int>, hstl::rb_tree_compact_node_base> ms;
+    for(int i = 0; i < 20000; ++i){
+        const long long k = static_cast<long long>(gen() % 5000);
+        if(gen() % 3 == 0){
+            assert(plain.erase(k) == compact.erase(k));
+            m.erase(static_cast<int>(k));
+        }else{
+            assert(plain.insert_unique(k).second == compact.insert_unique(k).second);
+            m[static_cast<int>(k)] = i;
+        }
+        ms.insert(static_cast<int>(k));
+    }
+    assert(plain.is_balanced() && compact.is_balanced());
+    assert(plain.size() == compact.size() && std::equal(plain.begin(), plain.end(), compact.begin()));
+    assert(m.size() == compact.size() && ms.size() == 20000);
+    auto it = compact.begin();
+    for(auto& e : m){
+        assert(e.first == *it);
+        ++it;
+    }
+    compact_tree right = compact.split(2500);
+    compact.join(right);
+    assert(compact.is_balanced() && compact.size() == plain.size());
+    std::cout << "rb_tree test 14 passed" << std::endl;
+}
+// throws on a given call, counted down across threads; negative never
+struct countdown_less{
+    static std::atomic<int> calls_left;
+    bool operator()(const tracked& a, const tracked& b) const{
+        if(calls_left.load() >= 0 && calls_left.fetch_sub(1) == 0){
+            throw std::runtime_error("compare");
+        }
+        return a.value < b.value;
+    }
+};
+std::atomic<int> countdown_less::calls_left(-1);
+
+// a Compare that throws midway leaves valid trees of the right sizes and frees nothing
+// it should not: split undoes itself, the set operations keep every element they did
+// not drop as a duplicate or a miss
+void test_15(){
+    typedef test_rb_tree<tracked, countdown_less> tree;
+    std::mt19937 gen(15);
+    hstl::thread_pool pool(4);
+    for(int round = 0; round < 200; ++round){
+        // the large rounds fork onto the pool
+        const bool large = round < 12;
+        const bool parallel = large || round % 8 < 4;
+        const int n = large ? 30000 : 300;
+        std::vector<int> r1, r2, all;
+        {
+            tree a, b;
+            for(int i = 0; i < n; ++i){
+                int k = static_cast<int>(gen() % (2 * n));
+                if(a.insert_unique(tracked(k)).second){
+                    r1.push_back(k);
+                }
+                k = static_cast<int>(gen() % (2 * n));
+                if(b.insert_unique(tracked(k)).second){
+                    r2.push_back(k);
+                }
+            }
+            std::sort(r1.begin(), r1.end());
+            std::sort(r2.begin(), r2.end());
+            std::set_union(r1.begin(), r1.end(), r2.begin(), r2.end(), std::back_inserter(all));
+
+            // a split compares once per level
+            countdown_less::calls_left = static_cast<int>(gen() % (round % 4 == 3 ? 24 : large ? 60000 : 2000));
+            bool thrown = false;
+            try{
+                switch(round % 4){
+                case 0: parallel ? a.union_with(b, pool) : a.union_with(b); break;
+                case 1: parallel ? a.intersect_with(b, pool) : a.intersect_with(b); break;
+                case 2: parallel ? a.difference_with(b, pool) : a.difference_with(b); break;
+                default:{
+                    tree right = a.split(tracked(static_cast<int>(gen() % (2 * n))));
+                    countdown_less::calls_left = -1;
+                    a.join(right);
+                    break;
+                }
+                }
+            }catch(const std::runtime_error&){
+                thrown = true;
+            }
+            countdown_less::calls_left = -1;
+            assert(a.is_balanced() && b.is_balanced());
+            assert(static_cast<std::size_t>(tracked::live) == a.size() + b.size());
+            if(thrown && round % 4 == 3){
+                assert(a.size() == r1.size() && std::equal(r1.begin(), r1.end(), a.begin(),
+                    [](int x, const tracked& t){ return x == t.value; }));
+            }
+            if(thrown && round % 4 == 0){
+                // nothing but duplicates is gone: the union of what is left is the union
+                a.union_with(b);
+                assert(a.size() == all.size() && std::equal(all.begin(), all.end(), a.begin(),
+                    [](int x, const tracked& t){ return x == t.value; }));
+            }
+        }
+        assert(tracked::live == 0);
+    }
+    std::cout << "rb_tree test 15 passed" << std::endl;
+}
+
+#endif
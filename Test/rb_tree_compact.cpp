@@ -0,0 +1,25 @@
+// the rb_tree tests again, on trees whose color is packed into the parent pointer
+#define TEST_RB_TREE_NODE_BASE hstl::rb_tree_compact_node_base
+#include "rb_tree.h"
+
+static_assert(std::is_base_of<hstl::rb_tree_compact_node_base, test_rb_tree<int, std::less<int>>::node_type>::value, "the suite runs on compact nodes");
+
+int main(){
+    test_1();
+    test_2();
+    test_3();
+    test_4();
+    test_5();
+    test_6();
+    test_7();
+    test_8();
+    test_9();
+    test_10();
+    test_11();
+    test_12();
+    test_13();
+    test_14();
+    test_15();
+
+    return 0;
+}
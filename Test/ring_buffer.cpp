@@ -0,0 +1,11 @@
+#include "ring_buffer.h"
+
+int main(){
+    test_1();
+    test_2();
+    test_3();
+    test_4();
+    test_5();
+    test_6();
+    return 0;
+}
@@ -0,0 +1,117 @@
+#ifndef TEST_RING_BUFFER_H
+#define TEST_RING_BUFFER_H
+
+#include "../TinySTL/ring_buffer.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <deque>
+
+
+void test_1(){
+    hstl::ring_buffer<int> r(5);
+    assert(r.capacity() == 8);
+    assert(r.empty());
+    for(int i = 0; i < 8; ++i){
+        assert(r.push_back(i));
+    }
+    assert(r.full());
+    assert(!r.push_back(8));
+    assert(r.front() == 0 && r.back() == 7);
+    for(int i = 0; i < 8; ++i){
+        assert(r[i] == i);
+    }
+    std::cout << "ring_buffer test 1 passed" << std::endl;
+}
+
+void test_2(){
+    hstl::ring_buffer<std::string> r(16);
+    std::deque<std::string> ref;
+    for(int i = 0; i < 10000; ++i){
+        if(i % 3 != 2 && !r.full()){
+            r.push_back(std::to_string(i));
+            ref.push_back(std::to_string(i));
+        }else if(!r.empty()){
+            assert(r.front() == ref.front());
+            r.pop_front();
+            ref.pop_front();
+        }
+        assert(r.size() == ref.size());
+    }
+    int i = 0;
+    for(auto it = r.begin(); it != r.end(); ++it, ++i){
+        assert(*it == ref[i]);
+    }
+    std::cout << "ring_buffer test 2 passed" << std::endl;
+}
+
+void test_3(){
+    hstl::ring_buffer<int> r(4, true);
+    for(int i = 0; i < 10; ++i){
+        assert(r.push_back(i));
+    }
+    assert(r.size() == 4);
+    assert(r.front() == 6 && r.back() == 9);
+    // contents wrap: [8, 9] at the start of the storage, [6, 7] at the end
+    auto one = r.array_one();
+    auto two = r.array_two();
+    assert(one.second == 2 && one.first[0] == 6 && one.first[1] == 7);
+    assert(two.second == 2 && two.first[0] == 8 && two.first[1] == 9);
+    r.pop_front();
+    r.pop_front();
+    assert(r.array_one().second == 2 && r.array_two().second == 0);
+    std::cout << "ring_buffer test 3 passed" << std::endl;
+}
+
+void test_4(){
+    hstl::ring_buffer<std::string> r(4, true);
+    for(int i = 0; i < 6; ++i){
+        r.emplace_back(3, 'a' + i);
+    }
+    hstl::ring_buffer<std::string> c(r);
+    assert(c.size() == 4 && c.front() == "ccc" && c.back() == "fff");
+    hstl::ring_buffer<std::string> m(std::move(c));
+    assert(m.size() == 4 && m[1] == "ddd");
+    hstl::ring_buffer<std::string> a(2);
+    a = m;
+    assert(a.capacity() == 4 && a.size() == 4 && a.back() == "fff");
+    a.clear();
+    assert(a.empty());
+    std::cout << "ring_buffer test 4 passed" << std::endl;
+}
+
+// a moved-from buffer is empty and rejects pushes, and can be assigned to again
+void test_5(){
+    hstl::ring_buffer<std::string> r(4);
+    r.push_back("a");
+    hstl::ring_buffer<std::string> m(std::move(r));
+    assert(r.empty() && r.full() && r.capacity() == 0);
+    assert(!r.push_back("b") && !r.emplace_back(3, 'c'));
+    assert(r.begin() == r.end() && r.array_one().second == 0 && r.array_two().second == 0);
+    hstl::ring_buffer<std::string> c(r);
+    assert(c.capacity() == 0 && !c.push_back("d"));
+
+    hstl::ring_buffer<std::string> o(2, true);
+    o = std::move(m);
+    hstl::ring_buffer<std::string> p(std::move(o));
+    assert(o.capacity() == 0 && !o.push_back("e"));
+    o = p;
+    assert(o.push_back("f") && o.size() == 2 && o.back() == "f");
+    std::cout << "ring_buffer test 5 passed" << std::endl;
+}
+
+// in overwrite mode the new element may be copied from the one it replaces
+void test_6(){
+    hstl::ring_buffer<std::string> r(2, true);
+    r.push_back(std::string(100, 'x'));
+    r.push_back("b");
+    assert(r.full() && r.push_back(r.front()));
+    assert(r.front() == "b" && r.back() == std::string(100, 'x'));
+    assert(r.emplace_back(r.front()));
+    assert(r.front() == std::string(100, 'x') && r.back() == "b");
+    assert(r.push_back(std::move(r.front())));
+    assert(r.front() == "b" && r.back() == std::string(100, 'x'));
+    std::cout << "ring_buffer test 6 passed" << std::endl;
+}
+
+#endif
@@ -0,0 +1,7 @@
+#include "set.h"
+
+int main(){
+    test_1();
+    test_2();
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef TEST_SET_H
+#define TEST_SET_H
+#include "../TinySTL/set.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+
+void test_1(){
+    std::mt19937 gen(1);
+    hstl::set<int> s;
+    std::set<int> ref;
+    for(int i = 0; i < 20000; ++i){
+        int k = static_cast<int>(gen() % 5000);
+        auto r = s.insert(k);
+        assert(r.second == ref.insert(k).second && *r.first == k);
+    }
+    assert(s.size() == ref.size());
+    auto it = s.begin();
+    for(int k : ref){
+        assert(*it == k);
+        ++it;
+    }
+    for(int k = 0; k < 5000; k += 7){
+        assert(s.erase(k) == ref.erase(k));
+    }
+    assert(s.size() == ref.size());
+    auto lb = s.lower_bound(2500);
+    assert(*lb == *ref.lower_bound(2500));
+    s.erase(lb);
+    ref.erase(ref.lower_bound(2500));
+    assert(s.size() == ref.size() && s.find(*ref.lower_bound(2500)) != s.end());
+
+    std::cout << "set test 1 passed" << std::endl;
+}
+
+void test_2(){
+    hstl::multiset<std::string, std::less<>> ms;
+    const char* words[] = {"b", "a", "b", "c", "b"};
+    for(const char* w : words){
+        ms.emplace(w);
+    }
+    assert(ms.size() == 5 && ms.count(std::string_view("b")) == 3);
+    assert(*ms.upper_bound(std::string_view("b")) == "c");
+
+    hstl::set<std::string, std::less<>> s(ms.begin(), ms.end());
+    assert(s.size() == 3);
+    assert(!s.emplace("a").second);
+    assert(s.find(std::string_view("c")) != s.end());
+
+    std::cout << "set test 2 passed" << std::endl;
+}
+#endif
@@ -0,0 +1,92 @@
+#ifndef TEST_SPSC_QUEUE_H
+#define TEST_SPSC_QUEUE_H
+
+#include "../TinySTL/spsc_queue.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+void test_1(){
+    hstl::spsc_queue<std::string> q(3);
+    assert(q.capacity() == 4);
+    assert(q.empty());
+    for(int i = 0; i < 4; ++i){
+        assert(q.try_push(std::to_string(i)));
+    }
+    assert(!q.try_push("x"));
+    std::string s;
+    assert(q.try_pop(s) && s == "0");
+    assert(q.try_emplace(2, 'y'));
+    assert(*q.front() == "1");
+    q.pop();
+    assert(q.size_approx() == 3);
+    std::cout << "spsc_queue test 1 passed" << std::endl;
+}
+
+void test_2(){
+    hstl::spsc_queue<int> q(8);
+    std::vector<int> in = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    assert(q.try_push_n(in.begin(), in.size()) == 8);
+    std::vector<int> out(10);
+    assert(q.try_pop_n(out.begin(), 3) == 3);
+    assert(out[0] == 1 && out[2] == 3);
+    assert(q.try_push_n(in.begin() + 8, 2) == 2);
+    assert(q.try_pop_n(out.begin(), 10) == 7);
+    assert(out[0] == 4 && out[4] == 8 && out[5] == 9 && out[6] == 10);
+    assert(q.empty());
+    std::cout << "spsc_queue test 2 passed" << std::endl;
+}
+
+void test_3(){
+    const int n = 1000000;
+    hstl::spsc_queue<int> q(1024);
+    std::thread producer([&]{
+        int batch[16];
+        for(int i = 0; i < n; ){
+            if(i % 3 == 0){
+                if(q.try_push(i)){
+                    ++i;
+                }
+            }else{
+                int k = 0;
+                for(; k < 16 && i + k < n; ++k){
+                    batch[k] = i + k;
+                }
+                i += static_cast<int>(q.try_push_n(batch, k));
+            }
+        }
+    });
+    int expected = 0;
+    int buf[32];
+    while(expected < n){
+        size_t got = q.try_pop_n(buf, 32);
+        for(size_t k = 0; k < got; ++k){
+            assert(buf[k] == expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    assert(q.empty());
+    std::cout << "spsc_queue test 3 passed" << std::endl;
+}
+
+void test_4(){
+    // elements of another type are converted to T, not copied into the slot as-is
+    hstl::spsc_queue<std::string> q(8);
+    const char* const names[] = {"a", "bb", "ccc"};
+    assert(q.try_push_n(names, 3) == 3);
+    const char* last = "dddd";
+    assert(q.try_emplace(last));
+    std::string s;
+    assert(q.try_pop(s) && s == "a");
+    assert(q.try_pop(s) && s == "bb");
+    assert(q.try_pop(s) && s == "ccc");
+    assert(q.try_pop(s) && s == "dddd");
+    assert(q.empty());
+    std::cout << "spsc_queue test 4 passed" << std::endl;
+}
+
+#endif
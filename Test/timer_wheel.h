@@ -0,0 +1,116 @@
+#ifndef TEST_TIMER_WHEEL_H
+#define TEST_TIMER_WHEEL_H
+
+#include "../TinySTL/timer_wheel.h"
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+
+void test_1(){
+    hstl::timer_wheel<std::string> w;
+    assert(w.empty() && w.current_tick() == 0);
+    w.schedule(5, "a");
+    auto b = w.schedule(5, "b");
+    w.schedule(100, 3, 'c');
+    w.schedule(70000, "far");
+    assert(w.size() == 4);
+    std::vector<std::string> out;
+    assert(w.advance(4, std::back_inserter(out)) == 0 && w.current_tick() == 5);
+    w.cancel(b);
+    assert(w.advance(5, std::back_inserter(out)) == 1 && out.back() == "a");
+    assert(w.advance(99, std::back_inserter(out)) == 0);
+    assert(w.advance(1000, std::back_inserter(out)) == 1 && out.back() == "ccc");
+    // expires in the past fires at the current tick
+    w.schedule(3, "late");
+    assert(w.advance(1000, std::back_inserter(out)) == 0);
+    assert(w.advance(1001, std::back_inserter(out)) == 1 && out.back() == "late");
+    assert(w.advance(69999, std::back_inserter(out)) == 0 && w.size() == 1);
+    assert(w.advance(70000, std::back_inserter(out)) == 1 && out.back() == "far");
+    assert(w.empty());
+    std::cout << "timer_wheel test 1 passed" << std::endl;
+}
+
+// random schedule / cancel / reschedule / advance against a multimap
+template <std::size_t Bits, std::size_t Levels>
+void check_random(std::uint64_t max_delay, int ops){
+    typedef hstl::timer_wheel<int, Bits, Levels> wheel;
+    wheel w(1000);
+    std::map<int, typename wheel::handle> live;
+    std::map<int, std::uint64_t> when;
+    int next_id = 0;
+    std::uint64_t now = 999;
+    for(int i = 0; i < ops; ++i){
+        const int r = std::rand() % 10;
+        if(r < 5){
+            const std::uint64_t t = now + 1 + static_cast<std::uint64_t>(std::rand()) % max_delay;
+            live[next_id] = w.schedule(t, next_id);
+            when[next_id] = t;
+            ++next_id;
+        }else if(r < 7 && !live.empty()){
+            auto it = live.begin();
+            std::advance(it, std::rand() % live.size());
+            if(r == 5){
+                w.cancel(it->second);
+                when.erase(it->first);
+                live.erase(it);
+            }else{
+                const std::uint64_t t = now + 1 + static_cast<std::uint64_t>(std::rand()) % max_delay;
+                w.reschedule(it->second, t);
+                assert(wheel::expires(it->second) == t && wheel::value(it->second) == it->first);
+                when[it->first] = t;
+            }
+        }else{
+            const std::uint64_t to = now + static_cast<std::uint64_t>(std::rand()) % (max_delay / 4 + 1);
+            std::vector<int> fired;
+            w.advance(to, std::back_inserter(fired));
+            std::uint64_t prev = 0;
+            for(int id : fired){
+                assert(when.count(id) && when[id] > now && when[id] <= to);
+                assert(when[id] >= prev);
+                prev = when[id];
+                when.erase(id);
+                live.erase(id);
+            }
+            for(auto& kv : when){
+                assert(kv.second > to);
+            }
+            now = to;
+        }
+        assert(w.size() == live.size());
+    }
+    w.clear();
+    assert(w.empty());
+}
+
+void test_2(){
+    check_random<6, 4>(5000, 20000);
+    // small wheels to exercise cascading and clamping past the top level
+    check_random<2, 3>(300, 20000);
+    check_random<3, 1>(100, 20000);
+    check_random<4, 2>(1000000, 5000);
+    std::cout << "timer_wheel test 2 passed" << std::endl;
+}
+
+void test_3(){
+    // timers left in the wheel are destroyed with it, nodes are recycled
+    hstl::timer_wheel<std::string, 4, 2> w;
+    for(int i = 0; i < 100; ++i){
+        w.schedule(static_cast<std::uint64_t>(i * 37), std::string(40, 'x'));
+    }
+    std::vector<std::string> out;
+    w.advance(1000, std::back_inserter(out));
+    assert(out.size() == 28 && w.size() == 72);
+    for(int i = 0; i < 10; ++i){
+        w.schedule(2000, "y");
+    }
+    w.shrink_to_fit();
+    std::cout << "timer_wheel test 3 passed" << std::endl;
+}
+
+#endif
@@ -0,0 +1,9 @@
+#include "ws_deque.h"
+
+int main(){
+    test_1();
+    test_2();
+    test_3();
+    test_4();
+    return 0;
+}
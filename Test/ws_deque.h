@@ -0,0 +1,173 @@
+#ifndef TEST_WS_DEQUE_H
+#define TEST_WS_DEQUE_H
+
+#include "../TinySTL/ws_deque.h"
+#include "../TinySTL/thread_pool.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+
+void test_1(){
+    hstl::ws_deque<int> q(4);
+    int x = 0;
+    assert(q.empty() && !q.pop(x) && !q.steal(x));
+    // grows twice past the initial capacity
+    for(int i = 0; i < 20; ++i){
+        q.push(i);
+    }
+    assert(q.size_approx() == 20);
+    // the owner pops the newest, a thief takes the oldest
+    assert(q.pop(x) && x == 19);
+    assert(q.steal(x) && x == 0);
+    assert(q.steal(x) && x == 1);
+    for(int i = 18; i >= 2; --i){
+        assert(q.pop(x) && x == i);
+    }
+    assert(q.empty() && !q.pop(x) && !q.steal(x));
+    q.push(7);
+    assert(q.steal(x) && x == 7);
+    assert(!q.pop(x));
+    std::cout << "ws_deque test 1 passed" << std::endl;
+}
+
+void test_2(){
+    // every pushed item is taken exactly once by the owner or one of the thieves
+    const int n = 100000;
+    const int thieves = 3;
+    hstl::ws_deque<int> q(2);
+    std::vector<std::atomic<int>> seen(n);
+    std::atomic<bool> done(false);
+    std::atomic<int> taken(0);
+
+    std::vector<std::thread> threads;
+    for(int k = 0; k < thieves; ++k){
+        threads.emplace_back([&]{
+            int x;
+            while(!done.load()){
+                if(q.steal(x)){
+                    seen[x].fetch_add(1);
+                    taken.fetch_add(1);
+                }else{
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    int x;
+    for(int i = 0; i < n; ++i){
+        q.push(i);
+        if(i % 3 == 0 && q.pop(x)){
+            seen[x].fetch_add(1);
+            taken.fetch_add(1);
+        }
+    }
+    while(q.pop(x)){
+        seen[x].fetch_add(1);
+        taken.fetch_add(1);
+    }
+    // a thief may still hold the last item it won
+    while(taken.load() != n){
+        std::this_thread::yield();
+    }
+    done.store(true);
+    for(auto& t : threads){
+        t.join();
+    }
+    for(int i = 0; i < n; ++i){
+        assert(seen[i].load() == 1);
+    }
+    std::cout << "ws_deque test 2 passed" << std::endl;
+}
+
+void test_3(){
+    hstl::thread_pool pool(3);
+    assert(pool.size() == 3);
+    const long n = 100000;
+    std::vector<long> v(n);
+    pool.parallel_for(0L, n, 1000L, [&](long i){ v[i] = i; });
+    long sum = 0;
+    for(long i = 0; i < n; ++i){
+        assert(v[i] == i);
+        sum += v[i];
+    }
+    assert(sum == n * (n - 1) / 2);
+
+    // nested: tasks running on workers submit to their own deques
+    std::atomic<long> total(0);
+    pool.parallel_for(0, 8, 1, [&](int){
+        pool.parallel_for(0, 1000, 10, [&](int j){ total.fetch_add(j); });
+    });
+    assert(total.load() == 8L * 999 * 1000 / 2);
+
+    std::atomic<int> count(0);
+    for(int i = 0; i < 1000; ++i){
+        pool.submit([&count]{ count.fetch_add(1); });
+    }
+    pool.wait_idle();
+    assert(count.load() == 1000);
+    std::cout << "ws_deque test 3 passed" << std::endl;
+}
+
+void test_4(){
+    hstl::thread_pool pool(3);
+    // a throwing chunk reaches the caller only after every other chunk has settled
+    std::atomic<int> done(0);
+    bool thrown = false;
+    try{
+        pool.parallel_for(0, 1000, 1, [&](int i){
+            if(i % 97 == 13){
+                throw std::runtime_error("chunk");
+            }
+            done.fetch_add(1);
+        });
+    }catch(const std::runtime_error&){
+        thrown = true;
+    }
+    assert(thrown);
+    assert(done.load() < 1000);
+
+    // nested: the inner failure propagates through the outer chunk
+    thrown = false;
+    try{
+        pool.parallel_for(0, 8, 1, [&](int i){
+            pool.parallel_for(0, 100, 10, [&](int j){
+                if(i == 5 && j == 42){
+                    throw std::runtime_error("inner");
+                }
+            });
+        });
+    }catch(const std::runtime_error&){
+        thrown = true;
+    }
+    assert(thrown);
+
+    // a submitted task's exception is kept for wait_idle, the workers survive it
+    std::atomic<int> count(0);
+    for(int i = 0; i < 100; ++i){
+        pool.submit([&count, i]{
+            count.fetch_add(1);
+            if(i == 50){
+                throw std::runtime_error("task");
+            }
+        });
+    }
+    thrown = false;
+    try{
+        pool.wait_idle();
+    }catch(const std::runtime_error&){
+        thrown = true;
+    }
+    assert(thrown && count.load() == 100);
+    pool.wait_idle();
+
+    std::vector<int> v(1000);
+    pool.parallel_for(0, 1000, 10, [&](int i){ v[i] = i; });
+    assert(v[999] == 999);
+    std::cout << "ws_deque test 4 passed" << std::endl;
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef TINYSTL_ALGORITHM_H
+#define TINYSTL_ALGORITHM_H
+
+#include <algorithm>
+#include <iterator>
+
+namespace hstl{
+
+// generic versions, containers with segmented storage (deque) add overloads
+// that walk one contiguous buffer at a time
+
+template <typename InputIterator, typename OutputIterator>
+inline OutputIterator copy(InputIterator first, InputIterator last, OutputIterator result){
+    return std::copy(first, last, result);
+}
+
+template <typename ForwardIterator, typename T>
+inline void fill(ForwardIterator first, ForwardIterator last, const T& value){
+    std::fill(first, last, value);
+}
+
+template <typename InputIterator, typename T>
+inline InputIterator find(InputIterator first, InputIterator last, const T& value){
+    return std::find(first, last, value);
+}
+
+template <typename InputIterator, typename Function>
+inline Function for_each(InputIterator first, InputIterator last, Function f){
+    return std::for_each(first, last, f);
+}
+
+} // namespace hstl
+
+#endif
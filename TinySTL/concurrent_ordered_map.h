@@ -0,0 +1,201 @@
+#ifndef TINYSTL_CONCURRENT_ORDERED_MAP_H
+#define TINYSTL_CONCURRENT_ORDERED_MAP_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include "epoch.h"
+#include "functional.h"
+#include "persistent_rb_tree.h"
+
+namespace hstl{
+
+// sorted unique keys mapped to values, for many readers and rare writers: readers take no
+// lock and never wait for a writer, writers are serialized by a mutex
+//
+// the map is a persistent_rb_tree. A writer builds the next version by copying the
+// O(log n) nodes on the path it changes, publishes its root with one atomic store and
+// retires the old version to an epoch_domain; the nodes only the old version had are freed
+// once no reader can still be walking them. A reader pins the epoch, loads the root and
+// searches a tree nobody writes to, so each read sees one whole version.
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class concurrent_ordered_map{
+public:
+    typedef Key                                         key_type;
+    typedef T                                           mapped_type;
+    typedef std::pair<const Key, T>                     value_type;
+    typedef Compare                                     key_compare;
+    typedef std::size_t                                 size_type;
+    typedef hstl::persistent_rb_tree<value_type, Compare, hstl::select1st<value_type>> tree_type;
+
+private:
+    typedef typename tree_type::link_type               link_type;
+
+    std::atomic<link_type> root_;       // the version readers see
+    std::atomic<size_type> size_;
+    const key_compare key_compare_;
+    mutable std::mutex writer_;
+    tree_type current_;                 // the same version, owned by the writers
+    mutable epoch_domain epochs_;
+
+public:
+    concurrent_ordered_map() : concurrent_ordered_map(Compare()){}
+    explicit concurrent_ordered_map(const Compare& comp);
+    // no reader or writer may still be inside
+    ~concurrent_ordered_map() = default;
+
+    concurrent_ordered_map(const concurrent_ordered_map&) = delete;
+    concurrent_ordered_map& operator=(const concurrent_ordered_map&) = delete;
+
+    key_compare key_comp() const{ return key_compare_; }
+    // as of the last finished write
+    size_type size() const noexcept { return size_.load(std::memory_order_acquire); }
+    bool empty() const noexcept { return size() == 0; }
+
+    // readers, from any thread
+    bool contains(const key_type& k) const;
+    // copy the value of k into value, false if k is absent
+    bool find(const key_type& k, mapped_type& value) const;
+    // f(element) with the element of k, false if absent; the element must not be kept
+    // after f returns
+    template <typename F>
+    bool visit(const key_type& k, F f) const;
+    // f(element) in order for all elements, or for those with lo <= key < hi, all from
+    // the same version
+    template <typename F>
+    void for_each(F f) const;
+    template <typename F>
+    void for_each(const key_type& lo, const key_type& hi, F f) const;
+
+    // writers, serialized; the bool is whether the key was new / was there
+    bool insert(const key_type& k, const mapped_type& value);
+    bool insert_or_assign(const key_type& k, const mapped_type& value);
+    bool erase(const key_type& k);
+
+    // the current version, which stays as it is while the map moves on
+    tree_type snapshot() const;
+    // free retired versions that no reader can reach any more; every write does this, it
+    // is only needed after the last one
+    void collect();
+
+private:
+    void publish(tree_type&& next);
+    static void release_root(void* p){ tree_type::release(static_cast<link_type>(p)); }
+};
+
+
+template <typename Key, typename T, typename Compare>
+concurrent_ordered_map<Key, T, Compare>::concurrent_ordered_map(const Compare& comp)
+    : root_(nullptr), size_(0), key_compare_(comp), writer_(), current_(comp), epochs_(){
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_ordered_map<Key, T, Compare>::contains(const key_type& k) const{
+    epoch_domain::guard g = epochs_.pin();
+    return tree_type::find_node(root_.load(std::memory_order_acquire), k, key_compare_) != nullptr;
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_ordered_map<Key, T, Compare>::find(const key_type& k, mapped_type& value) const{
+    epoch_domain::guard g = epochs_.pin();
+    link_type x = tree_type::find_node(root_.load(std::memory_order_acquire), k, key_compare_);
+    if(x == nullptr){
+        return false;
+    }
+    value = x->data.second;
+    return true;
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename F>
+bool concurrent_ordered_map<Key, T, Compare>::visit(const key_type& k, F f) const{
+    epoch_domain::guard g = epochs_.pin();
+    link_type x = tree_type::find_node(root_.load(std::memory_order_acquire), k, key_compare_);
+    if(x == nullptr){
+        return false;
+    }
+    f(static_cast<const value_type&>(x->data));
+    return true;
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename F>
+void concurrent_ordered_map<Key, T, Compare>::for_each(F f) const{
+    epoch_domain::guard g = epochs_.pin();
+    tree_type::for_each_node(root_.load(std::memory_order_acquire), f);
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename F>
+void concurrent_ordered_map<Key, T, Compare>::for_each(const key_type& lo, const key_type& hi, F f) const{
+    epoch_domain::guard g = epochs_.pin();
+    tree_type::for_each_node(root_.load(std::memory_order_acquire), lo, hi, key_compare_, f);
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_ordered_map<Key, T, Compare>::insert(const key_type& k, const mapped_type& value){
+    std::lock_guard<std::mutex> lock(writer_);
+    tree_type next = current_.insert(value_type(k, value));
+    if(next.size() == current_.size()){
+        return false;
+    }
+    publish(std::move(next));
+    return true;
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_ordered_map<Key, T, Compare>::insert_or_assign(const key_type& k, const mapped_type& value){
+    std::lock_guard<std::mutex> lock(writer_);
+    tree_type next = current_.insert_or_assign(value_type(k, value));
+    const bool inserted = next.size() != current_.size();
+    publish(std::move(next));
+    return inserted;
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_ordered_map<Key, T, Compare>::erase(const key_type& k){
+    std::lock_guard<std::mutex> lock(writer_);
+    tree_type next = current_.erase(k);
+    if(next.size() == current_.size()){
+        return false;
+    }
+    publish(std::move(next));
+    return true;
+}
+
+template <typename Key, typename T, typename Compare>
+typename concurrent_ordered_map<Key, T, Compare>::tree_type concurrent_ordered_map<Key, T, Compare>::snapshot() const{
+    std::lock_guard<std::mutex> lock(writer_);
+    return current_;
+}
+
+template <typename Key, typename T, typename Compare>
+void concurrent_ordered_map<Key, T, Compare>::collect(){
+    std::lock_guard<std::mutex> lock(writer_);
+    epochs_.collect();
+}
+
+// the old root keeps one reference in the epoch domain, the nodes it shares with the new
+// version stay when it is released, the rest go. It is retired before it is unlinked, so
+// running out of memory there leaves the map as it was
+template <typename Key, typename T, typename Compare>
+void concurrent_ordered_map<Key, T, Compare>::publish(tree_type&& next){
+    link_type old = tree_type::retain(current_.root_node());
+    if(old != nullptr){
+        try{
+            epochs_.retire(old, &release_root);
+        }catch(...){
+            tree_type::release(old);
+            throw;
+        }
+    }
+    current_.swap(next);
+    root_.store(current_.root_node(), std::memory_order_seq_cst);
+    size_.store(current_.size(), std::memory_order_release);
+    epochs_.collect();
+}
+
+} // namespace hstl
+
+#endif
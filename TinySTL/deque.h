@@ -4,31 +4,33 @@
 #include <cstddef>
 #include <iterator>
 #include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <initializer_list>
+#include <functional>
 #include "allocator.h"
 #include "construct.h"
 #include "uninitialized.h"
+#include "algorithm.h"
 namespace hstl{
 
 
-#ifndef DEQUE_MAP_SIZE
-#define DEQUE_MAP_SIZE 8
-#endif
-
-// buffer size
-template <typename T>
+// buffer size, in elements; BufSize == 0 picks a 4096 byte buffer
+template <typename T, std::size_t BufSize = 0>
 class deque_buffer_size{
 public:
-    static constexpr std::size_t buffer_size = sizeof(T) < 256 ? 4096 / sizeof(T) : 16;
+    static constexpr std::size_t buffer_size = BufSize != 0 ? BufSize : (sizeof(T) < 256 ? 4096 / sizeof(T) : 16);
+    static_assert(buffer_size > 1, "deque needs at least two elements per buffer");
 };
 
 
 // deque iterator
-template <typename T, typename Ref, typename Ptr>
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize = 0>
 class deque_iterator{
 public:
-    typedef deque_iterator<T, T&, T*>                   iterator;
-    typedef deque_iterator<T, const T&, const T*>       const_iterator;
-    typedef deque_iterator                              self;
+    typedef deque_iterator<T, T&, T*, BufSize>              iterator;
+    typedef deque_iterator<T, const T&, const T*, BufSize>  const_iterator;
+    typedef deque_iterator                                  self;
 
     typedef std::random_access_iterator_tag             iterator_category;
     typedef T                                           value_type;
@@ -39,7 +41,7 @@ public:
     typedef T*                                          value_pointer;
     typedef T**                                         map_pointer;
 
-    static const size_type buffer_size = deque_buffer_size<T>::buffer_size;
+    static const size_type buffer_size = deque_buffer_size<T, BufSize>::buffer_size;
 
 
     value_pointer   cur;
@@ -63,9 +65,9 @@ public:
 
     difference_type operator-(const self& rhs) const;
     self& operator++();
-    self& operator++(int);
+    self operator++(int);
     self& operator--();
-    self& operator--(int);
+    self operator--(int);
     self& operator+=(difference_type n);
     self& operator-=(difference_type n);
     self operator+(difference_type n) const;
@@ -84,20 +86,20 @@ public:
     
 };
 
-template <typename T, typename Ref, typename Ptr>
-deque_iterator<T, Ref, Ptr>::deque_iterator() noexcept
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+deque_iterator<T, Ref, Ptr, BufSize>::deque_iterator() noexcept
     : cur(nullptr), first(nullptr), last(nullptr), node(nullptr){}
 
-template <typename T, typename Ref, typename Ptr>
-deque_iterator<T, Ref, Ptr>::deque_iterator(value_pointer v_ptr, map_pointer n_ptr)
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+deque_iterator<T, Ref, Ptr, BufSize>::deque_iterator(value_pointer v_ptr, map_pointer n_ptr)
     : cur(v_ptr), first(*n_ptr), last(*n_ptr + buffer_size), node(n_ptr){}
 
-template <typename T, typename Ref, typename Ptr>
-deque_iterator<T, Ref, Ptr>::deque_iterator(const iterator& rhs) noexcept
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+deque_iterator<T, Ref, Ptr, BufSize>::deque_iterator(const iterator& rhs) noexcept
     : cur(rhs.cur), first(rhs.first), last(rhs.last), node(rhs.node){}
 
-template <typename T, typename Ref, typename Ptr>
-deque_iterator<T, Ref, Ptr>::deque_iterator(iterator&& rhs) noexcept
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+deque_iterator<T, Ref, Ptr, BufSize>::deque_iterator(iterator&& rhs) noexcept
     : cur(rhs.cur), first(rhs.first), last(rhs.last), node(rhs.node){
     rhs.cur = nullptr;
     rhs.first = nullptr;
@@ -105,14 +107,14 @@ deque_iterator<T, Ref, Ptr>::deque_iterator(iterator&& rhs) noexcept
     rhs.node = nullptr;
 }
 
-template <typename T, typename Ref, typename Ptr>
-deque_iterator<T, Ref, Ptr>::deque_iterator(const const_iterator& rhs) noexcept
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+deque_iterator<T, Ref, Ptr, BufSize>::deque_iterator(const const_iterator& rhs) noexcept
     : cur(rhs.cur), first(rhs.first), last(rhs.last), node(rhs.node){}
 
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self&
-deque_iterator<T, Ref, Ptr>::operator=(const self& rhs) noexcept{
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self&
+deque_iterator<T, Ref, Ptr, BufSize>::operator=(const self& rhs) noexcept{
     cur = rhs.cur;
     first = rhs.first;
     last = rhs.last;
@@ -120,9 +122,9 @@ deque_iterator<T, Ref, Ptr>::operator=(const self& rhs) noexcept{
     return *this;
 }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self&
-deque_iterator<T, Ref, Ptr>::operator=(iterator&& rhs) noexcept{
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self&
+deque_iterator<T, Ref, Ptr, BufSize>::operator=(iterator&& rhs) noexcept{
     cur = rhs.cur;
     first = rhs.first;
     last = rhs.last;
@@ -135,24 +137,24 @@ deque_iterator<T, Ref, Ptr>::operator=(iterator&& rhs) noexcept{
 }
 
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::reference
-deque_iterator<T, Ref, Ptr>::operator*() const{ return *cur; }
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::reference
+deque_iterator<T, Ref, Ptr, BufSize>::operator*() const{ return *cur; }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::pointer
-deque_iterator<T, Ref, Ptr>::operator->() const{ return cur; }
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::pointer
+deque_iterator<T, Ref, Ptr, BufSize>::operator->() const{ return cur; }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::difference_type
-deque_iterator<T, Ref, Ptr>::operator-(const self& rhs) const{
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::difference_type
+deque_iterator<T, Ref, Ptr, BufSize>::operator-(const self& rhs) const{
     return static_cast<difference_type>(buffer_size) * (node - rhs.node - 1) + (cur - first) + (rhs.last - rhs.cur);
 }
 
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self&
-deque_iterator<T, Ref, Ptr>::operator++(){
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self&
+deque_iterator<T, Ref, Ptr, BufSize>::operator++(){
     ++cur;
     if(cur == last){
         set_node(node + 1);
@@ -161,17 +163,17 @@ deque_iterator<T, Ref, Ptr>::operator++(){
     return *this;
 }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self&
-deque_iterator<T, Ref, Ptr>::operator++(int){
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self
+deque_iterator<T, Ref, Ptr, BufSize>::operator++(int){
     self tmp = *this;
     ++*this;
     return tmp;
 }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self&
-deque_iterator<T, Ref, Ptr>::operator--(){
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self&
+deque_iterator<T, Ref, Ptr, BufSize>::operator--(){
     if(cur == first){
         set_node(node - 1);
         cur = last;
@@ -182,17 +184,17 @@ deque_iterator<T, Ref, Ptr>::operator--(){
 }
 
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self&
-deque_iterator<T, Ref, Ptr>::operator--(int){
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self
+deque_iterator<T, Ref, Ptr, BufSize>::operator--(int){
     self tmp = *this;
     --*this;
     return tmp;
 }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self&
-deque_iterator<T, Ref, Ptr>::operator+=(difference_type n){
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self&
+deque_iterator<T, Ref, Ptr, BufSize>::operator+=(difference_type n){
     difference_type offset = n + (cur - first);
     if(offset >= 0 && offset < difference_type(buffer_size)){
         cur += n;
@@ -204,36 +206,36 @@ deque_iterator<T, Ref, Ptr>::operator+=(difference_type n){
     return *this;
 }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self&
-deque_iterator<T, Ref, Ptr>::operator-=(difference_type n){
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self&
+deque_iterator<T, Ref, Ptr, BufSize>::operator-=(difference_type n){
     return *this += -n;
 }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self
-deque_iterator<T, Ref, Ptr>::operator+(difference_type n) const{
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self
+deque_iterator<T, Ref, Ptr, BufSize>::operator+(difference_type n) const{
     self tmp = *this;
     return tmp += n;
 }
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::self
-deque_iterator<T, Ref, Ptr>::operator-(difference_type n) const{
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::self
+deque_iterator<T, Ref, Ptr, BufSize>::operator-(difference_type n) const{
     self tmp = *this;
     return tmp -= n;
 }
 
 
-template <typename T, typename Ref, typename Ptr>
-typename deque_iterator<T, Ref, Ptr>::reference
-deque_iterator<T, Ref, Ptr>::operator[](difference_type n) const{
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+typename deque_iterator<T, Ref, Ptr, BufSize>::reference
+deque_iterator<T, Ref, Ptr, BufSize>::operator[](difference_type n) const{
     return *(*this + n);
 }
 
 
-template <typename T, typename Ref, typename Ptr>
-void deque_iterator<T, Ref, Ptr>::set_node(map_pointer new_node){
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize>
+void deque_iterator<T, Ref, Ptr, BufSize>::set_node(map_pointer new_node){
     node = new_node;
     first = *node;
     last = first + difference_type(buffer_size);
@@ -241,7 +243,129 @@ void deque_iterator<T, Ref, Ptr>::set_node(map_pointer new_node){
 
 
 
-template <typename T>
+// segmented algorithms: walk a deque range one contiguous buffer at a time, so the
+// inner loops run over plain pointers instead of checking for a buffer switch per step
+
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize, typename OutputIterator>
+OutputIterator copy(deque_iterator<T, Ref, Ptr, BufSize> first, deque_iterator<T, Ref, Ptr, BufSize> last, OutputIterator result){
+    for(; first.node != last.node; first.set_node(first.node + 1), first.cur = first.first){
+        result = hstl::copy(first.cur, first.last, result);
+    }
+    return hstl::copy(first.cur, last.cur, result);
+}
+
+template <typename T, std::size_t BufSize, typename U>
+void fill(deque_iterator<T, T&, T*, BufSize> first, deque_iterator<T, T&, T*, BufSize> last, const U& value){
+    for(; first.node != last.node; first.set_node(first.node + 1), first.cur = first.first){
+        hstl::fill(first.cur, first.last, value);
+    }
+    hstl::fill(first.cur, last.cur, value);
+}
+
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize, typename U>
+deque_iterator<T, Ref, Ptr, BufSize> find(deque_iterator<T, Ref, Ptr, BufSize> first, deque_iterator<T, Ref, Ptr, BufSize> last, const U& value){
+    for(; first.node != last.node; first.set_node(first.node + 1), first.cur = first.first){
+        T* pos = hstl::find(first.cur, first.last, value);
+        if(pos != first.last){
+            first.cur = pos;
+            return first;
+        }
+    }
+    first.cur = hstl::find(first.cur, last.cur, value);
+    return first;
+}
+
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize, typename Function>
+Function for_each(deque_iterator<T, Ref, Ptr, BufSize> first, deque_iterator<T, Ref, Ptr, BufSize> last, Function f){
+    for(; first.node != last.node; first.set_node(first.node + 1), first.cur = first.first){
+        hstl::for_each(first.cur, first.last, std::ref(f));
+    }
+    hstl::for_each(first.cur, last.cur, std::ref(f));
+    return f;
+}
+
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize, typename ForwardIterator>
+ForwardIterator uninitialized_copy(deque_iterator<T, Ref, Ptr, BufSize> first, deque_iterator<T, Ref, Ptr, BufSize> last, ForwardIterator result){
+    ForwardIterator cur = result;
+    try{
+        for(; first.node != last.node; first.set_node(first.node + 1), first.cur = first.first){
+            cur = hstl::uninitialized_copy(first.cur, first.last, cur);
+        }
+        return hstl::uninitialized_copy(first.cur, last.cur, cur);
+    }catch(...){
+        hstl::destroy(result, cur);
+        throw;
+    }
+}
+
+template <typename InputIterator, typename T, std::size_t BufSize>
+deque_iterator<T, T&, T*, BufSize> __uninitialized_copy_to_segments(InputIterator first, InputIterator last,
+    deque_iterator<T, T&, T*, BufSize> result, std::input_iterator_tag){
+    return hstl::__uninitialized_copy(first, last, result);
+}
+
+template <typename ForwardIterator, typename T, std::size_t BufSize>
+deque_iterator<T, T&, T*, BufSize> __uninitialized_copy_to_segments(ForwardIterator first, ForwardIterator last,
+    deque_iterator<T, T&, T*, BufSize> result, std::forward_iterator_tag){
+    typedef typename std::iterator_traits<ForwardIterator>::difference_type difference_type;
+    difference_type n = std::distance(first, last);
+    deque_iterator<T, T&, T*, BufSize> cur = result;
+    try{
+        while(n > cur.last - cur.cur){
+            ForwardIterator next = first;
+            std::advance(next, cur.last - cur.cur);
+            hstl::uninitialized_copy(first, next, cur.cur);
+            n -= cur.last - cur.cur;
+            first = next;
+            cur.set_node(cur.node + 1);
+            cur.cur = cur.first;
+        }
+        hstl::uninitialized_copy(first, last, cur.cur);
+    }catch(...){
+        hstl::destroy(result, cur);
+        throw;
+    }
+    return cur + n;
+}
+
+template <typename InputIterator, typename T, std::size_t BufSize>
+deque_iterator<T, T&, T*, BufSize> uninitialized_copy(InputIterator first, InputIterator last, deque_iterator<T, T&, T*, BufSize> result){
+    typedef typename std::iterator_traits<InputIterator>::iterator_category category;
+    return __uninitialized_copy_to_segments(first, last, result, category());
+}
+
+template <typename T, typename Ref, typename Ptr, std::size_t BufSize, typename U, std::size_t BufSize2>
+deque_iterator<U, U&, U*, BufSize2> uninitialized_copy(deque_iterator<T, Ref, Ptr, BufSize> first, deque_iterator<T, Ref, Ptr, BufSize> last,
+    deque_iterator<U, U&, U*, BufSize2> result){
+    deque_iterator<U, U&, U*, BufSize2> cur = result;
+    try{
+        for(; first.node != last.node; first.set_node(first.node + 1), first.cur = first.first){
+            cur = hstl::uninitialized_copy(first.cur, first.last, cur);
+        }
+        return hstl::uninitialized_copy(first.cur, last.cur, cur);
+    }catch(...){
+        hstl::destroy(result, cur);
+        throw;
+    }
+}
+
+template <typename T, std::size_t BufSize, typename U>
+void uninitialized_fill(deque_iterator<T, T&, T*, BufSize> first, deque_iterator<T, T&, T*, BufSize> last, const U& value){
+    deque_iterator<T, T&, T*, BufSize> cur = first;
+    try{
+        for(; cur.node != last.node; cur.set_node(cur.node + 1), cur.cur = cur.first){
+            hstl::uninitialized_fill_n(cur.cur, cur.last - cur.cur, value);
+        }
+        hstl::uninitialized_fill_n(cur.cur, last.cur - cur.cur, value);
+    }catch(...){
+        hstl::destroy(first, cur);
+        throw;
+    }
+}
+
+
+// BufSize: elements per buffer (0 = default, see deque_buffer_size)
+template <typename T, std::size_t BufSize = 0>
 class deque{
 public:
     typedef hstl::allocator<T>                          allocator_type;
@@ -258,15 +382,21 @@ public:
     typedef pointer*                                    map_pointer;
     typedef const_pointer*                              const_map_pointer;
 
-    typedef deque_iterator<T, T&, T*>                   iterator;
-    typedef deque_iterator<T, const T&, const T*>       const_iterator;
+    typedef deque_iterator<T, T&, T*, BufSize>          iterator;
+    typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
     
-    static const size_type buffer_size = deque_buffer_size<T>::buffer_size;
+    static const size_type buffer_size = deque_buffer_size<T, BufSize>::buffer_size;
+    static const size_type min_map_size = 8;
+    // buffers released at either end are kept here so that a push right after a pop
+    // at a buffer boundary does not go back to the allocator
+    static const size_type spare_capacity = 2;
 private:
     iterator        begin_;
     iterator        end_;
     map_pointer     map_;
     size_type       map_size_;
+    pointer         spare_[spare_capacity];
+    size_type       spare_count_ = 0;
 
 public:
     deque();
@@ -277,6 +407,15 @@ public:
         std::is_convertible<typename std::iterator_traits<Iterator>::iterator_category, std::input_iterator_tag>::value>::type>
     deque(Iterator first, Iterator last);
 
+    deque(std::initializer_list<value_type> ilist);
+    deque(const deque& rhs);
+    deque(deque&& rhs);
+
+    ~deque();
+
+    deque& operator=(const deque& rhs);
+    deque& operator=(deque&& rhs) noexcept;
+
 public:
     iterator begin() noexcept;
     iterator end() noexcept;
@@ -286,7 +425,19 @@ public:
     bool empty() const noexcept;
     reference front();
     reference back();
+    const_reference front() const;
+    const_reference back() const;
+
+    reference operator[](size_type n);
+    const_reference operator[](size_type n) const;
+    reference at(size_type n);
+    const_reference at(size_type n) const;
+
+    void resize(size_type new_size);
+    void resize(size_type new_size, const value_type& value);
+    void shrink_to_fit();
     
+
     template <typename... Args>
     void emplace_front(Args&&... args); 
 
@@ -298,9 +449,34 @@ public:
     void push_front(value_type&& value);
     void push_back(value_type&& value);
     
+    template <typename... Args>
+    iterator emplace(iterator position, Args&&... args);
+
+    iterator insert(iterator position, const value_type& value);
+    iterator insert(iterator position, value_type&& value);
+    iterator insert(iterator position, size_type n, const value_type& value);
+
     void pop_front();
     void pop_back();
+    iterator erase(iterator position);
+    iterator erase(iterator first, iterator last);
     void clear() noexcept;
+    void swap(deque& rhs) noexcept;
+
+    // bulk operations: the buffers for the whole batch are reserved up front
+    // and elements are copied one buffer at a time
+    template <typename Iterator>
+    void append(Iterator first, Iterator last);
+
+    template <typename Iterator>
+    void prepend(Iterator first, Iterator last);
+
+    // move the first (last) n elements, in deque order, to out and remove them
+    template <typename OutputIterator>
+    OutputIterator pop_front_n(size_type n, OutputIterator out);
+
+    template <typename OutputIterator>
+    OutputIterator pop_back_n(size_type n, OutputIterator out);
     
 private:
     void map_init(size_type n_elements);
@@ -318,77 +494,222 @@ private:
     
     void reallocate_map(size_type need_nodes, bool is_front);
 
+    template <typename... Args>
+    iterator insert_aux(iterator position, Args&&... args);
+    void fill_insert(iterator position, size_type n, const value_type& value);
+
+    template <typename Iterator>
+    void append_aux(Iterator first, Iterator last, std::input_iterator_tag);
+    template <typename Iterator>
+    void append_aux(Iterator first, Iterator last, std::forward_iterator_tag);
+    template <typename Iterator>
+    void prepend_aux(Iterator first, Iterator last, std::input_iterator_tag);
+    template <typename Iterator>
+    void prepend_aux(Iterator first, Iterator last, std::forward_iterator_tag);
+
+    template <typename OutputIterator>
+    OutputIterator move_blocks(iterator first, iterator last, OutputIterator out);
+
     void destroy_nodes(map_pointer nstart, map_pointer nfinish);
+    pointer get_buffer();
+    void put_buffer(pointer buffer) noexcept;
+    void release_spares() noexcept;
 };
 
 
-template <typename T>
-deque<T>::deque(){
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>::deque(){
     map_init(0);
 }
 
-template <typename T>
-deque<T>::deque(size_type n){
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>::deque(size_type n){
     map_init(n);
     fill_init(n, value_type());
 }
 
-template <typename T>
-deque<T>::deque(size_type n, const value_type& value){
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>::deque(size_type n, const value_type& value){
     map_init(n);
     fill_init(n, value);
 }
 
-template <typename T>
+template <typename T, std::size_t BufSize>
 template <typename Iterator, typename>
-deque<T>::deque(Iterator first, Iterator last){
+deque<T, BufSize>::deque(Iterator first, Iterator last){
     typedef typename std::iterator_traits<Iterator>::iterator_category category;
     copy_init(first, last, category());
 }
 
-template <typename T>
-typename deque<T>::iterator deque<T>::begin() noexcept{
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>::deque(std::initializer_list<value_type> ilist){
+    copy_init(ilist.begin(), ilist.end(), std::forward_iterator_tag());
+}
+
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>::deque(const deque& rhs){
+    copy_init(rhs.begin(), rhs.end(), std::forward_iterator_tag());
+}
+
+// like libstdc++, the moved-from deque keeps a fresh empty map so it stays usable
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>::deque(deque&& rhs)
+    : begin_(std::move(rhs.begin_)), end_(std::move(rhs.end_)), map_(rhs.map_), map_size_(rhs.map_size_){
+    std::copy(rhs.spare_, rhs.spare_ + rhs.spare_count_, spare_);
+    spare_count_ = rhs.spare_count_;
+    rhs.spare_count_ = 0;
+    rhs.map_ = nullptr;
+    rhs.map_size_ = 0;
+    rhs.map_init(0);
+}
+
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>::~deque(){
+    if(map_ != nullptr){
+        clear();
+        data_allocator::deallocate(*begin_.node, buffer_size);
+        release_spares();
+        map_allocator::deallocate(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+}
+
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>& deque<T, BufSize>::operator=(const deque& rhs){
+    if(this != &rhs){
+        deque tmp(rhs);
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <typename T, std::size_t BufSize>
+deque<T, BufSize>& deque<T, BufSize>::operator=(deque&& rhs) noexcept{
+    if(this != &rhs){
+        swap(rhs);
+    }
+    return *this;
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::begin() noexcept{
     return begin_;
 }
 
-template <typename T>
-typename deque<T>::iterator deque<T>::end() noexcept{
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::end() noexcept{
     return end_;
 }
 
-template <typename T>
-typename deque<T>::const_iterator deque<T>::begin() const noexcept{
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::const_iterator deque<T, BufSize>::begin() const noexcept{
     return begin_;
 }
 
-template <typename T>
-typename deque<T>::const_iterator deque<T>::end() const noexcept{
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::const_iterator deque<T, BufSize>::end() const noexcept{
    return end_;
 }
 
-template <typename T>
-typename deque<T>::size_type deque<T>::size() const noexcept{
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::size_type deque<T, BufSize>::size() const noexcept{
     return end_ - begin_;
 }
 
-template <typename T>
-bool deque<T>::empty() const noexcept{
+template <typename T, std::size_t BufSize>
+bool deque<T, BufSize>::empty() const noexcept{
     return begin_ == end_;
 }
 
-template <typename T>
-typename deque<T>::reference deque<T>::front(){
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::reference deque<T, BufSize>::front(){
+    return *begin_;
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::reference deque<T, BufSize>::back(){
+    return *(end_ - 1);
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::const_reference deque<T, BufSize>::front() const{
     return *begin_;
 }
 
-template <typename T>
-typename deque<T>::reference deque<T>::back(){
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::const_reference deque<T, BufSize>::back() const{
     return *(end_ - 1);
 }
 
-template <typename T>
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::reference deque<T, BufSize>::operator[](size_type n){
+    assert(n < size());
+    return begin_[n];
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::const_reference deque<T, BufSize>::operator[](size_type n) const{
+    assert(n < size());
+    return begin_[n];
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::reference deque<T, BufSize>::at(size_type n){
+    if(n >= size()){
+        throw std::out_of_range("deque::at");
+    }
+    return begin_[n];
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::const_reference deque<T, BufSize>::at(size_type n) const{
+    if(n >= size()){
+        throw std::out_of_range("deque::at");
+    }
+    return begin_[n];
+}
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::resize(size_type new_size){
+    resize(new_size, value_type());
+}
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::resize(size_type new_size, const value_type& value){
+    const size_type len = size();
+    if(new_size < len){
+        erase(begin_ + new_size, end_);
+    }else{
+        insert(end_, new_size - len, value);
+    }
+}
+
+// buffers outside [begin_.node, end_.node] are already released by pop/erase,
+// so what is left to give back is the spare buffers and the unused part of the map
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::shrink_to_fit(){
+    release_spares();
+    const size_type num_nodes = end_.node - begin_.node + 1;
+    const size_type new_map_size = std::max(num_nodes + 2, size_type(min_map_size));
+    if(new_map_size >= map_size_){
+        return;
+    }
+    map_pointer new_map = allocate_map(new_map_size);
+    map_pointer nstart = new_map + (new_map_size - num_nodes) / 2;
+    std::copy(begin_.node, end_.node + 1, nstart);
+    const difference_type begin_offset = begin_.cur - begin_.first;
+    const difference_type end_offset = end_.cur - end_.first;
+    map_allocator::deallocate(map_, map_size_);
+    map_ = new_map;
+    map_size_ = new_map_size;
+    begin_ = iterator(*nstart + begin_offset, nstart);
+    end_ = iterator(*(nstart + num_nodes - 1) + end_offset, nstart + num_nodes - 1);
+}
+
+template <typename T, std::size_t BufSize>
 template <typename ...Args>
-void deque<T>::emplace_front(Args&&... args){
+void deque<T, BufSize>::emplace_front(Args&&... args){
     if(begin_.cur != begin_.first){
         data_allocator::construct(begin_.cur - 1, std::forward<Args>(args)...);
         --begin_.cur;
@@ -400,9 +721,9 @@ void deque<T>::emplace_front(Args&&... args){
 
 }
 
-template <typename T>
+template <typename T, std::size_t BufSize>
 template <typename ...Args>
-void deque<T>::emplace_back(Args&&... args){
+void deque<T, BufSize>::emplace_back(Args&&... args){
     // actually, there are two positions to use in the end, to prevent unauthorized access
     if(end_.cur != end_.last - 1){
         data_allocator::construct(end_.cur, std::forward<Args>(args)...);
@@ -414,8 +735,8 @@ void deque<T>::emplace_back(Args&&... args){
     }
 }
 
-template <typename T>
-void deque<T>::push_front(const value_type& value){
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::push_front(const value_type& value){
     if(begin_.cur != begin_.first){
         data_allocator::construct(begin_.cur - 1, value);
         --begin_.cur;
@@ -426,8 +747,8 @@ void deque<T>::push_front(const value_type& value){
     }
 }
 
-template <typename T>
-void deque<T>::push_back(const value_type& value){
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::push_back(const value_type& value){
     if(end_.cur != end_.last - 1){
         data_allocator::construct(end_.cur, value);
         ++end_.cur;
@@ -438,18 +759,48 @@ void deque<T>::push_back(const value_type& value){
     }
 }
 
-template <typename T>
-void deque<T>::push_front(value_type&& value){
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::push_front(value_type&& value){
     emplace_front(std::move(value));
 }
 
-template <typename T>
-void deque<T>::push_back(value_type&& value){
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::push_back(value_type&& value){
     emplace_back(std::move(value));
 }
 
-template <typename T>
-void deque<T>::pop_front(){
+template <typename T, std::size_t BufSize>
+template <typename... Args>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::emplace(iterator position, Args&&... args){
+    if(position.cur == begin_.cur){
+        emplace_front(std::forward<Args>(args)...);
+        return begin_;
+    }else if(position.cur == end_.cur){
+        emplace_back(std::forward<Args>(args)...);
+        return end_ - 1;
+    }
+    return insert_aux(position, std::forward<Args>(args)...);
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::insert(iterator position, const value_type& value){
+    return emplace(position, value);
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::insert(iterator position, value_type&& value){
+    return emplace(position, std::move(value));
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::insert(iterator position, size_type n, const value_type& value){
+    const difference_type elems_before = position - begin_;
+    fill_insert(position, n, value);
+    return begin_ + elems_before;
+}
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::pop_front(){
     assert(!empty());
     if(begin_.cur != begin_.last - 1){
         data_allocator::destroy(begin_.cur);
@@ -462,8 +813,8 @@ void deque<T>::pop_front(){
     }
 }
 
-template <typename T>
-void deque<T>::pop_back(){
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::pop_back(){
     assert(!empty());
     if(end_.cur != end_.first){
         --end_.cur;
@@ -475,8 +826,53 @@ void deque<T>::pop_back(){
     }
 }
 
-template <typename T>
-void deque<T>::clear() noexcept{
+// move the shorter side towards the hole and drop one element at that end
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::erase(iterator position){
+    assert(position >= begin_ && position < end_);
+    iterator next = position;
+    ++next;
+    const difference_type elems_before = position - begin_;
+    if(static_cast<size_type>(elems_before) < (size() >> 1)){
+        std::move_backward(begin_, position, next);
+        pop_front();
+    }else{
+        std::move(next, end_, position);
+        pop_back();
+    }
+    return begin_ + elems_before;
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::erase(iterator first, iterator last){
+    assert(first >= begin_ && first <= last && last <= end_);
+    if(first == last){
+        return first;
+    }
+    if(first == begin_ && last == end_){
+        clear();
+        return end_;
+    }
+    const difference_type n = last - first;
+    const difference_type elems_before = first - begin_;
+    if(static_cast<size_type>(elems_before) < (size() - n) / 2){
+        std::move_backward(begin_, first, last);
+        iterator new_begin = begin_ + n;
+        data_allocator::destroy(begin_, new_begin);
+        destroy_nodes(begin_.node, new_begin.node - 1);
+        begin_ = new_begin;
+    }else{
+        std::move(last, end_, first);
+        iterator new_end = end_ - n;
+        data_allocator::destroy(new_end, end_);
+        destroy_nodes(new_end.node + 1, end_.node);
+        end_ = new_end;
+    }
+    return begin_ + elems_before;
+}
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::clear() noexcept{
     for(auto cur = begin_.node + 1; cur < end_.node; ++cur){
         data_allocator::destroy(*cur, *cur + buffer_size);
     }
@@ -490,11 +886,23 @@ void deque<T>::clear() noexcept{
     end_ = begin_;
 }
 
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::swap(deque& rhs) noexcept{
+    if(this != &rhs){
+        std::swap(begin_, rhs.begin_);
+        std::swap(end_, rhs.end_);
+        std::swap(map_, rhs.map_);
+        std::swap(map_size_, rhs.map_size_);
+        std::swap(spare_, rhs.spare_);
+        std::swap(spare_count_, rhs.spare_count_);
+    }
+}
 
-template <typename T>
-void deque<T>::map_init(size_type n_elements){
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::map_init(size_type n_elements){
     size_type num_nodes = n_elements / buffer_size + 1; // need nodes
-    map_size_ = std::max(num_nodes + 2, size_type(DEQUE_MAP_SIZE));
+    map_size_ = std::max(num_nodes + 2, size_type(min_map_size));
     try{
         map_ = allocate_map(map_size_);
     }catch(...){
@@ -520,65 +928,52 @@ void deque<T>::map_init(size_type n_elements){
     
 }
 
-template <typename T>
-typename deque<T>::map_pointer deque<T>::allocate_map(size_type map_size){
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::map_pointer deque<T, BufSize>::allocate_map(size_type map_size){
     return map_allocator::allocate(map_size);
 }
 
-template <typename T>
-void deque<T>::allocate_node(map_pointer nstart, map_pointer nfinish){
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::allocate_node(map_pointer nstart, map_pointer nfinish){
     map_pointer cur = nstart;
     try{
         for(; cur <= nfinish; ++cur){
-            *cur = data_allocator::allocate(buffer_size);
+            *cur = get_buffer();
         }
     }catch(...){
         for(--cur; cur >= nstart; --cur){
-            data_allocator::deallocate(*cur, buffer_size);
+            put_buffer(*cur);
         }
         throw;
     }
 }
 
-template <typename T>
-void deque<T>::fill_init(size_type n, const value_type& value){
-    for(map_pointer cur = begin_.node; cur < end_.node; ++cur){
-        hstl::uninitialized_fill_n(*cur, buffer_size, value);
-    }
-    hstl::uninitialized_fill_n(end_.first, end_.cur - end_.first, value);
-    
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::fill_init(size_type n, const value_type& value){
+    hstl::uninitialized_fill(begin_, end_, value);
 }
 
 
-template <typename T>
+template <typename T, std::size_t BufSize>
 template <typename Iterator>
-void deque<T>::copy_init(Iterator first, Iterator last, std::input_iterator_tag){
-    const size_type n = std::distance(first, last);
-    map_init(n);
-    for(;first != last; ++first){
-        emplace_back(*first);
-    }
+void deque<T, BufSize>::copy_init(Iterator first, Iterator last, std::input_iterator_tag){
+    map_init(0);
+    append_aux(first, last, std::input_iterator_tag());
 }
 
-template <typename T>
+template <typename T, std::size_t BufSize>
 template <typename Iterator>
-void deque<T>::copy_init(Iterator first, Iterator last, std::forward_iterator_tag){
+void deque<T, BufSize>::copy_init(Iterator first, Iterator last, std::forward_iterator_tag){
     const size_type n = std::distance(first, last);
     map_init(n);
-    for(auto cur = begin_.node; cur < end_.node; ++cur){
-        auto next = first;
-        std::advance(next, buffer_size);
-        hstl::uninitialized_copy(first, next, *cur);
-        first = next;
-    }
-    hstl::uninitialized_copy(first, last, end_.first);
+    hstl::uninitialized_copy(first, last, begin_);
 }
 
 
-template <typename T>
-void deque<T>::require_capacity(size_type n_elements, bool is_front){
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::require_capacity(size_type n_elements, bool is_front){
     if(is_front && (static_cast<size_type> (begin_.cur - begin_.first) < n_elements )){
-        const size_type need_nodes = (n_elements - (begin_.cur - begin_.first)) / buffer_size + 1;
+        const size_type need_nodes = (n_elements - (begin_.cur - begin_.first) + buffer_size - 1) / buffer_size;
         if(need_nodes > static_cast<size_type> (begin_.node - map_)){
             reallocate_map(need_nodes, is_front);
         }else{
@@ -586,7 +981,7 @@ void deque<T>::require_capacity(size_type n_elements, bool is_front){
         }
         
     }else if (!is_front && (static_cast<size_type> (end_.last - end_.cur - 1) < n_elements )){
-        const size_type need_nodes = (n_elements - (end_.last - end_.cur - 1)) / buffer_size + 1;
+        const size_type need_nodes = (n_elements - (end_.last - end_.cur - 1) + buffer_size - 1) / buffer_size;
         if(need_nodes > static_cast<size_type> ((map_ + map_size_) - end_.node - 1)){
             reallocate_map(need_nodes, is_front);
         }else{
@@ -595,13 +990,30 @@ void deque<T>::require_capacity(size_type n_elements, bool is_front){
     }
 }
 
-template <typename T>
-void deque<T>::reallocate_map(size_type need_nodes, bool is_front){
-    const size_type new_map_size  = std::max(map_size_ << 1, map_size_ + need_nodes + DEQUE_MAP_SIZE);
-    map_pointer new_map = allocate_map(new_map_size);
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::reallocate_map(size_type need_nodes, bool is_front){
     const size_type old_nodes = end_.node - begin_.node + 1;
     const size_type new_nodes = old_nodes + need_nodes;
-    
+    if(map_size_ > 2 * new_nodes){
+        // a queue drifts through the map, recenter the nodes instead of growing the map
+        map_pointer nstart = map_ + (map_size_ - new_nodes) / 2 + (is_front ? need_nodes : 0);
+        if(nstart < begin_.node){
+            std::copy(begin_.node, end_.node + 1, nstart);
+        }else{
+            std::copy_backward(begin_.node, end_.node + 1, nstart + old_nodes);
+        }
+        begin_ = iterator(*nstart + (begin_.cur - begin_.first), nstart);
+        end_ = iterator(*(nstart + old_nodes - 1) + (end_.cur - end_.first), nstart + old_nodes - 1);
+        if(is_front){
+            allocate_node(nstart - need_nodes, nstart - 1);
+        }else{
+            allocate_node(nstart + old_nodes, nstart + old_nodes + need_nodes - 1);
+        }
+        return;
+    }
+
+    const size_type new_map_size  = std::max(map_size_ << 1, map_size_ + need_nodes + min_map_size);
+    map_pointer new_map = allocate_map(new_map_size);
     if(is_front){
         auto begin = new_map + (new_map_size - new_nodes) / 2;
         auto mid = begin + need_nodes;
@@ -632,10 +1044,228 @@ void deque<T>::reallocate_map(size_type need_nodes, bool is_front){
     }
 }
 
-template <typename T>
-void deque<T>::destroy_nodes(map_pointer first, map_pointer last){
+template <typename T, std::size_t BufSize>
+template <typename Iterator>
+void deque<T, BufSize>::append(Iterator first, Iterator last){
+    typedef typename std::iterator_traits<Iterator>::iterator_category category;
+    append_aux(first, last, category());
+}
+
+template <typename T, std::size_t BufSize>
+template <typename Iterator>
+void deque<T, BufSize>::prepend(Iterator first, Iterator last){
+    typedef typename std::iterator_traits<Iterator>::iterator_category category;
+    prepend_aux(first, last, category());
+}
+
+template <typename T, std::size_t BufSize>
+template <typename OutputIterator>
+OutputIterator deque<T, BufSize>::pop_front_n(size_type n, OutputIterator out){
+    assert(n <= size());
+    iterator new_begin = begin_ + n;
+    out = move_blocks(begin_, new_begin, out);
+    data_allocator::destroy(begin_, new_begin);
+    destroy_nodes(begin_.node, new_begin.node - 1);
+    begin_ = new_begin;
+    return out;
+}
+
+template <typename T, std::size_t BufSize>
+template <typename OutputIterator>
+OutputIterator deque<T, BufSize>::pop_back_n(size_type n, OutputIterator out){
+    assert(n <= size());
+    iterator new_end = end_ - n;
+    out = move_blocks(new_end, end_, out);
+    data_allocator::destroy(new_end, end_);
+    destroy_nodes(new_end.node + 1, end_.node);
+    end_ = new_end;
+    return out;
+}
+
+// the length is unknown, so there is nothing to reserve
+template <typename T, std::size_t BufSize>
+template <typename Iterator>
+void deque<T, BufSize>::append_aux(Iterator first, Iterator last, std::input_iterator_tag){
+    for(; first != last; ++first){
+        emplace_back(*first);
+    }
+}
+
+template <typename T, std::size_t BufSize>
+template <typename Iterator>
+void deque<T, BufSize>::append_aux(Iterator first, Iterator last, std::forward_iterator_tag){
+    const size_type n = std::distance(first, last);
+    if(n == 0){
+        return;
+    }
+    require_capacity(n, false);
+    iterator new_end = end_ + n;
+    try{
+        hstl::uninitialized_copy(first, last, end_);
+    }catch(...){
+        destroy_nodes(end_.node + 1, new_end.node);
+        throw;
+    }
+    end_ = new_end;
+}
+
+template <typename T, std::size_t BufSize>
+template <typename Iterator>
+void deque<T, BufSize>::prepend_aux(Iterator first, Iterator last, std::input_iterator_tag){
+    const size_type old_size = size();
+    for(; first != last; ++first){
+        emplace_front(*first);
+    }
+    std::reverse(begin_, end_ - old_size);
+}
+
+template <typename T, std::size_t BufSize>
+template <typename Iterator>
+void deque<T, BufSize>::prepend_aux(Iterator first, Iterator last, std::forward_iterator_tag){
+    const size_type n = std::distance(first, last);
+    if(n == 0){
+        return;
+    }
+    require_capacity(n, true);
+    iterator new_begin = begin_ - n;
+    try{
+        hstl::uninitialized_copy(first, last, new_begin);
+    }catch(...){
+        destroy_nodes(new_begin.node, begin_.node - 1);
+        throw;
+    }
+    begin_ = new_begin;
+}
+
+template <typename T, std::size_t BufSize>
+template <typename OutputIterator>
+OutputIterator deque<T, BufSize>::move_blocks(iterator first, iterator last, OutputIterator out){
+    for(; first.node != last.node; first.set_node(first.node + 1), first.cur = first.first){
+        out = std::move(first.cur, first.last, out);
+    }
+    return std::move(first.cur, last.cur, out);
+}
+
+// libstdc++ style: make room at the end closer to position, shift that side by one,
+// then assign the new value into the hole
+template <typename T, std::size_t BufSize>
+template <typename... Args>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::insert_aux(iterator position, Args&&... args){
+    value_type value(std::forward<Args>(args)...);
+    const difference_type elems_before = position - begin_;
+    if(static_cast<size_type>(elems_before) < (size() >> 1)){
+        emplace_front(std::move(front()));
+        // emplace_front may have reallocated the map
+        iterator front1 = begin_ + 1;
+        iterator front2 = front1 + 1;
+        position = begin_ + elems_before;
+        iterator pos1 = position + 1;
+        std::move(front2, pos1, front1);
+    }else{
+        emplace_back(std::move(back()));
+        iterator back1 = end_ - 1;
+        iterator back2 = back1 - 1;
+        position = begin_ + elems_before;
+        std::move_backward(position, back2, back1);
+    }
+    *position = std::move(value);
+    return position;
+}
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::fill_insert(iterator position, size_type n, const value_type& value){
+    if(n == 0){
+        return;
+    }
+    const difference_type elems_before = position - begin_;
+    const size_type len = size();
+    if(static_cast<size_type>(elems_before) < len / 2){
+        require_capacity(n, true);
+        iterator old_begin = begin_;
+        iterator new_begin = begin_ - n;
+        position = begin_ + elems_before;
+        try{
+            if(static_cast<size_type>(elems_before) >= n){
+                iterator begin_n = begin_ + n;
+                hstl::uninitialized_move(begin_, begin_n, new_begin);
+                begin_ = new_begin;
+                std::move(begin_n, position, old_begin);
+                std::fill(position - n, position, value);
+            }else{
+                iterator mid = hstl::uninitialized_move(begin_, position, new_begin);
+                try{
+                    hstl::uninitialized_fill_n(mid, n - elems_before, value);
+                }catch(...){
+                    data_allocator::destroy(new_begin, mid);
+                    throw;
+                }
+                begin_ = new_begin;
+                std::fill(old_begin, position, value);
+            }
+        }catch(...){
+            destroy_nodes(new_begin.node, begin_.node - 1);
+            throw;
+        }
+    }else{
+        require_capacity(n, false);
+        iterator old_end = end_;
+        iterator new_end = end_ + n;
+        const difference_type elems_after = len - elems_before;
+        position = end_ - elems_after;
+        try{
+            if(static_cast<size_type>(elems_after) > n){
+                iterator end_n = end_ - n;
+                hstl::uninitialized_move(end_n, end_, end_);
+                end_ = new_end;
+                std::move_backward(position, end_n, old_end);
+                std::fill(position, position + n, value);
+            }else{
+                iterator mid = position + n;
+                hstl::uninitialized_fill_n(end_, n - elems_after, value);
+                try{
+                    hstl::uninitialized_move(position, end_, mid);
+                }catch(...){
+                    data_allocator::destroy(end_, mid);
+                    throw;
+                }
+                end_ = new_end;
+                std::fill(position, old_end, value);
+            }
+        }catch(...){
+            destroy_nodes(end_.node + 1, new_end.node);
+            throw;
+        }
+    }
+}
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::destroy_nodes(map_pointer first, map_pointer last){
     for(auto cur = first; cur <= last; ++cur){
-        data_allocator::deallocate(*cur, buffer_size);
+        put_buffer(*cur);
+    }
+}
+
+template <typename T, std::size_t BufSize>
+typename deque<T, BufSize>::pointer deque<T, BufSize>::get_buffer(){
+    if(spare_count_ != 0){
+        return spare_[--spare_count_];
+    }
+    return data_allocator::allocate(buffer_size);
+}
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::put_buffer(pointer buffer) noexcept{
+    if(spare_count_ < spare_capacity){
+        spare_[spare_count_++] = buffer;
+    }else{
+        data_allocator::deallocate(buffer, buffer_size);
+    }
+}
+
+template <typename T, std::size_t BufSize>
+void deque<T, BufSize>::release_spares() noexcept{
+    while(spare_count_ != 0){
+        data_allocator::deallocate(spare_[--spare_count_], buffer_size);
     }
 }
 
@@ -0,0 +1,156 @@
+#ifndef TINYSTL_EPOCH_H
+#define TINYSTL_EPOCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include "vector.h"
+
+namespace hstl{
+
+#ifndef TINYSTL_CACHE_LINE_SIZE
+#define TINYSTL_CACHE_LINE_SIZE 64
+#endif
+
+// epoch based reclamation for structures whose readers take no lock
+//
+// a reader pins the current epoch for the length of one operation; a writer that unlinks
+// memory retires it instead of freeing it, and retired memory is freed once no reader that
+// could still hold a pointer to it is pinned. Readers are counted per epoch parity in
+// slots on their own cache lines, a thread always uses the same slot, so pinning costs
+// two atomic operations on a line that readers rarely share. The epoch only advances when
+// no reader is left in the one before the current, so every pinned reader is in the
+// current epoch or the previous one, and what was retired in epoch e can go at e + 2.
+//
+// pin may be called from any thread, retire and collect from one thread at a time
+class epoch_domain{
+public:
+    typedef std::size_t                                 size_type;
+    typedef std::uint64_t                               epoch_type;
+    typedef void (*deleter_type)(void*);
+
+    static constexpr size_type cache_line_size = TINYSTL_CACHE_LINE_SIZE;
+    static constexpr size_type slot_count = 64;
+
+    // unpins on destruction
+    class guard{
+    private:
+        std::atomic<size_type>* readers_;
+
+    public:
+        explicit guard(std::atomic<size_type>* readers) noexcept : readers_(readers){}
+        guard(guard&& rhs) noexcept : readers_(rhs.readers_){ rhs.readers_ = nullptr; }
+        ~guard(){
+            if(readers_ != nullptr){
+                readers_->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+        guard& operator=(guard&&) = delete;
+    };
+
+private:
+    struct alignas(cache_line_size) slot{
+        std::atomic<size_type> readers[2];
+    };
+    struct retired{
+        void* ptr;
+        deleter_type deleter;
+    };
+
+    slot slots_[slot_count];
+    alignas(cache_line_size) std::atomic<epoch_type> epoch_;
+    hstl::vector<retired> limbo_[3];
+
+public:
+    epoch_domain();
+    // frees everything still retired, no reader may be pinned any more
+    ~epoch_domain();
+
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    guard pin() noexcept;
+    // deleter(p) once no reader pinned now can still reach p; p must be unlinked by the
+    // time of the next collect
+    void retire(void* p, deleter_type deleter);
+    // advance the epoch if no reader is left in the previous one and free what that makes
+    // safe, returns how many were freed. Writers call it after retiring
+    size_type collect();
+
+    epoch_type epoch() const noexcept { return epoch_.load(std::memory_order_relaxed); }
+    size_type pending() const noexcept { return limbo_[0].size() + limbo_[1].size() + limbo_[2].size(); }
+
+private:
+    static size_type thread_slot() noexcept;
+    static size_type free_all(hstl::vector<retired>& list) noexcept;
+};
+
+
+inline epoch_domain::epoch_domain() : epoch_(0){
+    for(slot& s : slots_){
+        s.readers[0].store(0, std::memory_order_relaxed);
+        s.readers[1].store(0, std::memory_order_relaxed);
+    }
+}
+
+inline epoch_domain::~epoch_domain(){
+    for(hstl::vector<retired>& list : limbo_){
+        free_all(list);
+    }
+}
+
+// count in the slot first, then check the epoch has not moved: a writer that advances
+// after the check sees the count, one that advanced before it makes the reader retry
+inline epoch_domain::guard epoch_domain::pin() noexcept{
+    slot& s = slots_[thread_slot() % slot_count];
+    for(;;){
+        const epoch_type e = epoch_.load(std::memory_order_seq_cst);
+        std::atomic<size_type>& readers = s.readers[e & 1];
+        readers.fetch_add(1, std::memory_order_seq_cst);
+        if(epoch_.load(std::memory_order_seq_cst) == e){
+            return guard(&readers);
+        }
+        readers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+// only collect moves the epoch, so a reader pinned in a later one finds p unlinked
+inline void epoch_domain::retire(void* p, deleter_type deleter){
+    const epoch_type e = epoch_.load(std::memory_order_seq_cst);
+    limbo_[e % 3].push_back(retired{p, deleter});
+}
+
+inline epoch_domain::size_type epoch_domain::collect(){
+    const epoch_type e = epoch_.load(std::memory_order_relaxed);
+    const size_type previous = (e + 1) & 1;
+    for(const slot& s : slots_){
+        if(s.readers[previous].load(std::memory_order_seq_cst) != 0){
+            return 0;
+        }
+    }
+    epoch_.store(e + 1, std::memory_order_seq_cst);
+    // retired in e - 1, two epochs ago now
+    return free_all(limbo_[(e + 2) % 3]);
+}
+
+inline epoch_domain::size_type epoch_domain::thread_slot() noexcept{
+    static std::atomic<size_type> next(0);
+    thread_local const size_type index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+inline epoch_domain::size_type epoch_domain::free_all(hstl::vector<retired>& list) noexcept{
+    const size_type n = list.size();
+    for(const retired& r : list){
+        r.deleter(r.ptr);
+    }
+    list.clear();
+    return n;
+}
+
+} // namespace hstl
+
+#endif
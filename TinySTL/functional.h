@@ -0,0 +1,29 @@
+#ifndef TINYSTL_FUNCTIONAL_H
+#define TINYSTL_FUNCTIONAL_H
+
+namespace hstl{
+
+// key extractors for the associative containers: a set element is its own key, a map
+// element is keyed by its first member
+
+template <typename T>
+struct identity{
+    typedef T result_type;
+
+    const T& operator()(const T& x) const{
+        return x;
+    }
+};
+
+template <typename Pair>
+struct select1st{
+    typedef typename Pair::first_type result_type;
+
+    const result_type& operator()(const Pair& x) const{
+        return x.first;
+    }
+};
+
+} // namespace hstl
+
+#endif
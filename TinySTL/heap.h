@@ -1,93 +1,128 @@
 #ifndef TINYSTL_HEAP_H
 #define TINYSTL_HEAP_H
 
+#include <cstddef>
 #include <type_traits>
 #include <iterator>
+#include <utility>
+#include <algorithm>
 
 
 namespace hstl{
 
-template <class RandomAccessIterator, class Distance, class T>
-void __push_heap(RandomAccessIterator first, Distance holeIndex, Distance topIndex, T value){
+// the comparison of the overloads without a Compare, a max-heap on operator<
+struct __heap_less{
+    template <class T1, class T2>
+    bool operator()(const T1& a, const T2& b) const { return a < b; }
+};
+
+// the elements are moved, never copied: the slot at holeIndex is a hole whose old value has
+// been moved out, parents move down into it and value is moved in once at the end
+template <class RandomAccessIterator, class Distance, class T, class Compare>
+void __push_heap(RandomAccessIterator first, Distance holeIndex, Distance topIndex, T&& value, Compare comp){
     Distance parent = (holeIndex - 1) / 2;
-    while(holeIndex > topIndex && *(first + parent) < value){
-        *(first + holeIndex) = *(first + parent);
+    while(holeIndex > topIndex && comp(*(first + parent), value)){
+        *(first + holeIndex) = std::move(*(first + parent));
         holeIndex = parent;
         parent = (holeIndex - 1) / 2;
     }
-    *(first + holeIndex) = value;
+    *(first + holeIndex) = std::move(value);
 }
 
-template <class RandomAccessIterator, class Distance, class T>
-void __push_heap_aux(RandomAccessIterator first, RandomAccessIterator last, Distance*, T*){
-    __push_heap(first, Distance((last - first) - 1), Distance(0), T(*(last - 1)));
+template <class RandomAccessIterator, class Distance, class T, class Compare>
+void __push_heap_aux(RandomAccessIterator first, RandomAccessIterator last, Distance*, T*, Compare comp){
+    T value = std::move(*(last - 1));
+    hstl::__push_heap(first, Distance((last - first) - 1), Distance(0), std::move(value), comp);
 }
 
 // the new value is already at the end of the heap
-template <class RandomAccessIterator>
-inline void push_heap(RandomAccessIterator first, RandomAccessIterator last){
+template <class RandomAccessIterator, class Compare>
+inline void push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
     typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
     typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
-    __push_heap_aux(first, last, static_cast<difference_type*>(0), static_cast<value_type*>(0));
+    hstl::__push_heap_aux(first, last, static_cast<difference_type*>(0), static_cast<value_type*>(0), comp);
+}
+
+template <class RandomAccessIterator>
+inline void push_heap(RandomAccessIterator first, RandomAccessIterator last){
+    hstl::push_heap(first, last, __heap_less());
 }
 
 
-template <class RandomAccessIterator, class Distance, class T>
-void __adjust_heap(RandomAccessIterator first, Distance holeIndex, Distance len, T value){
+// Floyd's bottom-up sift: the hole goes all the way down along the larger child, one
+// comparison per level, and value is then pushed up from the leaf. value usually belongs
+// near the bottom, so this saves the comparison against value on every level
+template <class RandomAccessIterator, class Distance, class T, class Compare>
+void __adjust_heap(RandomAccessIterator first, Distance holeIndex, Distance len, T&& value, Compare comp){
     Distance topIndex = holeIndex;
     Distance secondChild = 2 * holeIndex + 2;
     while(secondChild < len){
-        if(*(first + secondChild) < *(first + (secondChild - 1))){
+        if(comp(*(first + secondChild), *(first + (secondChild - 1)))){
             secondChild--;
         }
-        *(first + holeIndex) = *(first + secondChild);
+        *(first + holeIndex) = std::move(*(first + secondChild));
         holeIndex = secondChild;
         secondChild = 2 * (secondChild + 1);
     }
     if(secondChild == len){
-        *(first + holeIndex) = *(first + (secondChild - 1));
+        *(first + holeIndex) = std::move(*(first + (secondChild - 1)));
         holeIndex = secondChild - 1;
     }
-    __push_heap(first, holeIndex, topIndex, value);
+    hstl::__push_heap(first, holeIndex, topIndex, std::move(value), comp);
 }
 
-template <class RandomAccessIterator, class Distance, class T>
-void __pop_heap(RandomAccessIterator first, RandomAccessIterator last, RandomAccessIterator result, T value, Distance*){
-    *result = *first;
-    __adjust_heap(first, Distance(0), Distance(last - first), value);
+// value has already been moved out of *result
+template <class RandomAccessIterator, class Distance, class T, class Compare>
+void __pop_heap(RandomAccessIterator first, RandomAccessIterator last, RandomAccessIterator result, T&& value, Distance*, Compare comp){
+    *result = std::move(*first);
+    hstl::__adjust_heap(first, Distance(0), Distance(last - first), std::move(value), comp);
 }
 
-template <class RandomAccessIterator, class T>
-void __pop_heap_aux(RandomAccessIterator first, RandomAccessIterator last, T*){
+template <class RandomAccessIterator, class T, class Compare>
+void __pop_heap_aux(RandomAccessIterator first, RandomAccessIterator last, T*, Compare comp){
     typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
-    __pop_heap(first, last - 1, last - 1, T(*(last - 1)), static_cast<difference_type*>(0));
+    T value = std::move(*(last - 1));
+    hstl::__pop_heap(first, last - 1, last - 1, std::move(value), static_cast<difference_type*>(0), comp);
 }
 
 // move the top element of the heap to the end of the heap
+template <class RandomAccessIterator, class Compare>
+inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    if(last - first > 1){
+        hstl::__pop_heap_aux(first, last, static_cast<value_type*>(0), comp);
+    }
+}
+
 template <class RandomAccessIterator>
 inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last){
-    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
-    __pop_heap_aux(first, last, static_cast<value_type*>(0));
+    hstl::pop_heap(first, last, __heap_less());
 }
 
 // sort the heap
-template <class RandomAccessIterator>
-void sort_heap(RandomAccessIterator first, RandomAccessIterator last){
+template <class RandomAccessIterator, class Compare>
+void sort_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
     while(last - first > 1){
-        hstl::pop_heap(first, last--);
+        hstl::pop_heap(first, last--, comp);
     }
 }
 
+template <class RandomAccessIterator>
+void sort_heap(RandomAccessIterator first, RandomAccessIterator last){
+    hstl::sort_heap(first, last, __heap_less());
+}
+
 // make a heap
-template <class RandomAccessIterator, class Distance, class T>
-void __make_heap(RandomAccessIterator first, RandomAccessIterator last, T*, Distance*){
+template <class RandomAccessIterator, class Distance, class T, class Compare>
+void __make_heap(RandomAccessIterator first, RandomAccessIterator last, T*, Distance*, Compare comp){
     if(last - first < 2){
         return;
     }
     Distance len = last - first;
     Distance parent = (len - 2) / 2;
     while(true){
-        __adjust_heap(first, parent, len, T(*(first + parent)));
+        T value = std::move(*(first + parent));
+        hstl::__adjust_heap(first, parent, len, std::move(value), comp);
         if(parent == 0){
             return;
         }
@@ -95,15 +130,318 @@ void __make_heap(RandomAccessIterator first, RandomAccessIterator last, T*, Dist
     }
 }
 
+template <class RandomAccessIterator, class Compare>
+inline void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    hstl::__make_heap(first, last, static_cast<value_type*>(0), static_cast<difference_type*>(0), comp);
+}
+
 template <class RandomAccessIterator>
 inline void make_heap(RandomAccessIterator first, RandomAccessIterator last){
+    hstl::make_heap(first, last, __heap_less());
+}
+
+
+// d-ary heap: the children of i are D * i + 1 ... D * i + D
+//
+// the tree is log2(D) times shallower than a binary heap, so a pop moves fewer elements
+// and, since the D children are adjacent, the extra comparisons per level read one cache
+// line instead of log2(D) lines scattered over the levels. The groups start at first + 1
+// and every D elements after it, so each group lies in one line when first + 1 is aligned
+// to D * sizeof(T) and that divides the line size; place the heap one element before such
+// a boundary to get that, otherwise some groups straddle two lines. D = 4 or 8 suits
+// small keys; push only compares against parents and gets cheaper with D as well
+template <std::size_t D, class RandomAccessIterator, class Distance, class T, class Compare>
+void __dary_push_heap(RandomAccessIterator first, Distance holeIndex, Distance topIndex, T&& value, Compare comp){
+    Distance parent = (holeIndex - 1) / Distance(D);
+    while(holeIndex > topIndex && comp(*(first + parent), value)){
+        *(first + holeIndex) = std::move(*(first + parent));
+        holeIndex = parent;
+        parent = (holeIndex - 1) / Distance(D);
+    }
+    *(first + holeIndex) = std::move(value);
+}
+
+// sift the hole down to a leaf along the larger children, then push value up from there
+template <std::size_t D, class RandomAccessIterator, class Distance, class T, class Compare>
+void __dary_adjust_heap(RandomAccessIterator first, Distance holeIndex, Distance len, T&& value, Compare comp){
+    const Distance topIndex = holeIndex;
+    Distance child = Distance(D) * holeIndex + 1;
+    // full groups: a fixed trip count the compiler unrolls, and a select rather than a
+    // branch since which child wins is unpredictable
+    while(child <= len - Distance(D)){
+        Distance best = child;
+        for(std::size_t k = 1; k < D; ++k){
+            best = comp(*(first + best), *(first + (child + Distance(k)))) ? child + Distance(k) : best;
+        }
+        *(first + holeIndex) = std::move(*(first + best));
+        holeIndex = best;
+        child = Distance(D) * holeIndex + 1;
+    }
+    // the last, partial group
+    if(child < len){
+        Distance best = child;
+        for(Distance c = child + 1; c < len; ++c){
+            best = comp(*(first + best), *(first + c)) ? c : best;
+        }
+        *(first + holeIndex) = std::move(*(first + best));
+        holeIndex = best;
+    }
+    hstl::__dary_push_heap<D>(first, holeIndex, topIndex, std::move(value), comp);
+}
+
+template <std::size_t D, class RandomAccessIterator, class Distance, class T, class Compare>
+void __dary_push_heap_aux(RandomAccessIterator first, RandomAccessIterator last, Distance*, T*, Compare comp){
+    T value = std::move(*(last - 1));
+    hstl::__dary_push_heap<D>(first, Distance((last - first) - 1), Distance(0), std::move(value), comp);
+}
+
+template <std::size_t D, class RandomAccessIterator, class Distance, class T, class Compare>
+void __dary_pop_heap_aux(RandomAccessIterator first, RandomAccessIterator last, Distance*, T*, Compare comp){
+    T value = std::move(*(last - 1));
+    *(last - 1) = std::move(*first);
+    hstl::__dary_adjust_heap<D>(first, Distance(0), Distance((last - first) - 1), std::move(value), comp);
+}
+
+template <std::size_t D, class RandomAccessIterator, class Distance, class T, class Compare>
+void __dary_make_heap(RandomAccessIterator first, RandomAccessIterator last, Distance*, T*, Compare comp){
+    const Distance len = last - first;
+    if(len < 2){
+        return;
+    }
+    for(Distance parent = (len - 2) / Distance(D); ; --parent){
+        T value = std::move(*(first + parent));
+        hstl::__dary_adjust_heap<D>(first, parent, len, std::move(value), comp);
+        if(parent == 0){
+            return;
+        }
+    }
+}
+
+template <std::size_t D, class RandomAccessIterator, class Compare>
+inline void dary_push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+    static_assert(D >= 2, "a d-ary heap needs D >= 2");
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    hstl::__dary_push_heap_aux<D>(first, last, static_cast<difference_type*>(0), static_cast<value_type*>(0), comp);
+}
+
+template <std::size_t D, class RandomAccessIterator>
+inline void dary_push_heap(RandomAccessIterator first, RandomAccessIterator last){
+    hstl::dary_push_heap<D>(first, last, __heap_less());
+}
+
+template <std::size_t D, class RandomAccessIterator, class Compare>
+inline void dary_pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+    static_assert(D >= 2, "a d-ary heap needs D >= 2");
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    if(last - first > 1){
+        hstl::__dary_pop_heap_aux<D>(first, last, static_cast<difference_type*>(0), static_cast<value_type*>(0), comp);
+    }
+}
+
+template <std::size_t D, class RandomAccessIterator>
+inline void dary_pop_heap(RandomAccessIterator first, RandomAccessIterator last){
+    hstl::dary_pop_heap<D>(first, last, __heap_less());
+}
+
+template <std::size_t D, class RandomAccessIterator, class Compare>
+inline void dary_make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+    static_assert(D >= 2, "a d-ary heap needs D >= 2");
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    hstl::__dary_make_heap<D>(first, last, static_cast<difference_type*>(0), static_cast<value_type*>(0), comp);
+}
+
+template <std::size_t D, class RandomAccessIterator>
+inline void dary_make_heap(RandomAccessIterator first, RandomAccessIterator last){
+    hstl::dary_make_heap<D>(first, last, __heap_less());
+}
+
+template <std::size_t D, class RandomAccessIterator, class Compare>
+void dary_sort_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+    while(last - first > 1){
+        hstl::dary_pop_heap<D>(first, last--, comp);
+    }
+}
+
+template <std::size_t D, class RandomAccessIterator>
+void dary_sort_heap(RandomAccessIterator first, RandomAccessIterator last){
+    hstl::dary_sort_heap<D>(first, last, __heap_less());
+}
+
+// heap based selection
+
+template <class Compare>
+struct __heap_reverse{
+    Compare comp;
+    template <class T1, class T2>
+    bool operator()(const T1& a, const T2& b) { return comp(b, a); }
+};
+
+// keep the smallest middle - first elements of [first, last) as a heap in [first, middle)
+template <class RandomAccessIterator, class Compare>
+void __heap_select(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp){
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    hstl::make_heap(first, middle, comp);
+    for(RandomAccessIterator it = middle; it < last; ++it){
+        if(comp(*it, *first)){
+            value_type value = std::move(*it);
+            *it = std::move(*first);
+            hstl::__adjust_heap(first, difference_type(0), difference_type(middle - first), std::move(value), comp);
+        }
+    }
+}
+
+// sort the smallest middle - first elements into [first, middle), the rest is left unordered
+template <class RandomAccessIterator, class Compare>
+void partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp){
+    hstl::__heap_select(first, middle, last, comp);
+    hstl::sort_heap(first, middle, comp);
+}
+
+template <class RandomAccessIterator>
+inline void partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last){
+    hstl::partial_sort(first, middle, last, __heap_less());
+}
+
+// copy the smallest elements of [first, last), sorted, into [result_first, result_last);
+// the input is read once, so it can be a stream, and only the result range is kept in memory
+template <class InputIterator, class RandomAccessIterator, class Compare>
+RandomAccessIterator partial_sort_copy(InputIterator first, InputIterator last,
+    RandomAccessIterator result_first, RandomAccessIterator result_last, Compare comp){
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    RandomAccessIterator result_real_last = result_first;
+    for(; first != last && result_real_last != result_last; ++first, ++result_real_last){
+        *result_real_last = *first;
+    }
+    if(result_real_last == result_first){
+        return result_real_last;
+    }
+    hstl::make_heap(result_first, result_real_last, comp);
+    const difference_type len = result_real_last - result_first;
+    for(; first != last; ++first){
+        if(comp(*first, *result_first)){
+            hstl::__adjust_heap(result_first, difference_type(0), len, value_type(*first), comp);
+        }
+    }
+    hstl::sort_heap(result_first, result_real_last, comp);
+    return result_real_last;
+}
+
+template <class InputIterator, class RandomAccessIterator>
+inline RandomAccessIterator partial_sort_copy(InputIterator first, InputIterator last,
+    RandomAccessIterator result_first, RandomAccessIterator result_last){
+    return hstl::partial_sort_copy(first, last, result_first, result_last, __heap_less());
+}
+
+// the largest result_last - result_first elements of [first, last) under comp, largest first,
+// streamed through a bounded heap that lives in the result range
+template <class InputIterator, class RandomAccessIterator, class Compare>
+inline RandomAccessIterator top_k(InputIterator first, InputIterator last,
+    RandomAccessIterator result_first, RandomAccessIterator result_last, Compare comp){
+    return hstl::partial_sort_copy(first, last, result_first, result_last, __heap_reverse<Compare>{comp});
+}
+
+template <class InputIterator, class RandomAccessIterator>
+inline RandomAccessIterator top_k(InputIterator first, InputIterator last,
+    RandomAccessIterator result_first, RandomAccessIterator result_last){
+    return hstl::top_k(first, last, result_first, result_last, __heap_less());
+}
+
+template <class RandomAccessIterator, class Compare>
+void __move_median_to_first(RandomAccessIterator result, RandomAccessIterator a, RandomAccessIterator b,
+    RandomAccessIterator c, Compare comp){
+    if(comp(*a, *b)){
+        if(comp(*b, *c))        std::iter_swap(result, b);
+        else if(comp(*a, *c))   std::iter_swap(result, c);
+        else                    std::iter_swap(result, a);
+    }else if(comp(*a, *c))      std::iter_swap(result, a);
+    else if(comp(*b, *c))       std::iter_swap(result, c);
+    else                        std::iter_swap(result, b);
+}
+
+// Hoare partition around *pivot; the median of three guarantees an element on each side
+// that stops the scans, so they need no bounds checks
+template <class RandomAccessIterator, class Compare>
+RandomAccessIterator __unguarded_partition(RandomAccessIterator first, RandomAccessIterator last,
+    RandomAccessIterator pivot, Compare comp){
+    while(true){
+        while(comp(*first, *pivot)){
+            ++first;
+        }
+        --last;
+        while(comp(*pivot, *last)){
+            --last;
+        }
+        if(!(first < last)){
+            return first;
+        }
+        std::iter_swap(first, last);
+        ++first;
+    }
+}
+
+template <class RandomAccessIterator, class Compare>
+void __insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
     typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    if(first == last){
+        return;
+    }
+    for(RandomAccessIterator i = first + 1; i != last; ++i){
+        value_type value = std::move(*i);
+        RandomAccessIterator hole = i;
+        for(; hole != first && comp(value, *(hole - 1)); --hole){
+            *hole = std::move(*(hole - 1));
+        }
+        *hole = std::move(value);
+    }
+}
+
+// rearrange [first, last) so that *nth is the element a full sort would put there, with no
+// element before it greater and none after it smaller: introselect, quickselect with a
+// median of three that falls back to heap selection when the partitions keep coming out
+// lopsided, so the worst case is O(n log n) instead of O(n^2)
+template <class RandomAccessIterator, class Compare>
+void nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last, Compare comp){
+    if(first == last || nth == last){
+        return;
+    }
     typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
-    __make_heap(first, last, static_cast<value_type*>(0), static_cast<difference_type*>(0));
+    difference_type depth_limit = 0;
+    for(difference_type n = last - first; n > 1; n >>= 1){
+        depth_limit += 2;
+    }
+    while(last - first > 3){
+        if(depth_limit == 0){
+            hstl::__heap_select(first, nth + 1, last, comp);
+            std::iter_swap(first, nth);
+            return;
+        }
+        --depth_limit;
+        RandomAccessIterator mid = first + (last - first) / 2;
+        hstl::__move_median_to_first(first, first + 1, mid, last - 1, comp);
+        RandomAccessIterator cut = hstl::__unguarded_partition(first + 1, last, first, comp);
+        if(cut <= nth){
+            first = cut;
+        }else{
+            last = cut;
+        }
+    }
+    hstl::__insertion_sort(first, last, comp);
+}
+
+template <class RandomAccessIterator>
+inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last){
+    hstl::nth_element(first, nth, last, __heap_less());
 }
 
 
 }
 
 
-#endif
\ No newline at end of file
+#endif
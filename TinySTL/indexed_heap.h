@@ -0,0 +1,233 @@
+#ifndef TINYSTL_INDEXED_HEAP_H
+#define TINYSTL_INDEXED_HEAP_H
+
+#include <cstddef>
+#include <cassert>
+#include <functional>
+#include <utility>
+#include "vector.h"
+
+namespace hstl{
+
+template <typename Key, typename Priority>
+struct indexed_heap_entry{
+    Key         key;
+    Priority    priority;
+
+    indexed_heap_entry(Key k, Priority p) : key(k), priority(std::move(p)){}
+};
+
+// d-ary heap of keys ordered by priority, with a position map so that the priority of a
+// key already in the heap can be changed or the key removed in O(log n)
+//
+// keys are dense ids (vertex numbers and the like): Key converts to size_t and the
+// position map is a vector indexed by it, grown on demand. top() is the key with the
+// smallest priority under Compare, which is what Dijkstra and Prim want
+template <typename Key, typename Priority, typename Compare = std::less<Priority>, std::size_t D = 4>
+class indexed_heap{
+    static_assert(D >= 2, "a d-ary heap needs D >= 2");
+public:
+    typedef Key                                         key_type;
+    typedef Priority                                    priority_type;
+    typedef Compare                                     priority_compare;
+    typedef std::size_t                                 size_type;
+    typedef indexed_heap_entry<Key, Priority>           entry_type;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+private:
+    hstl::vector<entry_type>    heap_;
+    hstl::vector<size_type>     pos_;   // heap index of each key, npos if absent
+    Compare                     comp_;
+
+public:
+    indexed_heap() : heap_(), pos_(), comp_(){}
+    explicit indexed_heap(size_type key_count, const Compare& comp = Compare());
+
+    size_type size() const noexcept { return heap_.size(); }
+    bool empty() const noexcept { return heap_.empty(); }
+    bool contains(const key_type& key) const;
+    const priority_type& priority(const key_type& key) const;
+
+    const key_type& top_key() const;
+    const priority_type& top_priority() const;
+
+    // the key must not be in the heap
+    void push(const key_type& key, priority_type priority);
+    // the key must be in the heap; the priority may move either way
+    void update(const key_type& key, priority_type priority);
+    // push if absent, otherwise update only if priority is better, return whether it changed;
+    // this is the edge relaxation of Dijkstra
+    bool push_or_decrease(const key_type& key, priority_type priority);
+
+    void pop();
+    // remove the key if present, return whether it was
+    bool erase(const key_type& key);
+    void clear() noexcept;
+
+private:
+    static size_type index_of(const key_type& key) { return static_cast<size_type>(key); }
+    void sift_up(size_type hole, entry_type&& entry);
+    void sift_down(size_type hole, entry_type&& entry);
+    void place(size_type hole, entry_type&& entry);
+    void move_entry(size_type from, size_type to);
+};
+
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+indexed_heap<Key, Priority, Compare, D>::indexed_heap(size_type key_count, const Compare& comp)
+    : heap_(), pos_(key_count, npos), comp_(comp){
+    heap_.reserve(key_count);
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+bool indexed_heap<Key, Priority, Compare, D>::contains(const key_type& key) const{
+    const size_type i = index_of(key);
+    return i < pos_.size() && pos_[i] != npos;
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+const typename indexed_heap<Key, Priority, Compare, D>::priority_type&
+indexed_heap<Key, Priority, Compare, D>::priority(const key_type& key) const{
+    assert(contains(key));
+    return heap_[pos_[index_of(key)]].priority;
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+const typename indexed_heap<Key, Priority, Compare, D>::key_type&
+indexed_heap<Key, Priority, Compare, D>::top_key() const{
+    assert(!empty());
+    return heap_[0].key;
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+const typename indexed_heap<Key, Priority, Compare, D>::priority_type&
+indexed_heap<Key, Priority, Compare, D>::top_priority() const{
+    assert(!empty());
+    return heap_[0].priority;
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+void indexed_heap<Key, Priority, Compare, D>::push(const key_type& key, priority_type priority){
+    assert(!contains(key));
+    const size_type i = index_of(key);
+    if(i >= pos_.size()){
+        pos_.resize(i + 1 > 2 * pos_.size() ? i + 1 : 2 * pos_.size(), npos);
+    }
+    const size_type hole = heap_.size();
+    heap_.push_back(entry_type(key, std::move(priority)));
+    entry_type entry = std::move(heap_[hole]);
+    sift_up(hole, std::move(entry));
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+void indexed_heap<Key, Priority, Compare, D>::update(const key_type& key, priority_type priority){
+    assert(contains(key));
+    const size_type hole = pos_[index_of(key)];
+    entry_type entry(key, std::move(priority));
+    if(comp_(entry.priority, heap_[hole].priority)){
+        sift_up(hole, std::move(entry));
+    }else{
+        sift_down(hole, std::move(entry));
+    }
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+bool indexed_heap<Key, Priority, Compare, D>::push_or_decrease(const key_type& key, priority_type priority){
+    if(!contains(key)){
+        push(key, std::move(priority));
+        return true;
+    }
+    const size_type hole = pos_[index_of(key)];
+    if(!comp_(priority, heap_[hole].priority)){
+        return false;
+    }
+    sift_up(hole, entry_type(key, std::move(priority)));
+    return true;
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+void indexed_heap<Key, Priority, Compare, D>::pop(){
+    assert(!empty());
+    erase(heap_[0].key);
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+bool indexed_heap<Key, Priority, Compare, D>::erase(const key_type& key){
+    if(!contains(key)){
+        return false;
+    }
+    const size_type i = index_of(key);
+    const size_type hole = pos_[i];
+    pos_[i] = npos;
+    const size_type last = heap_.size() - 1;
+    if(hole != last){
+        // the last entry fills the hole and moves whichever way it belongs
+        entry_type entry = std::move(heap_[last]);
+        heap_.pop_back();
+        if(hole > 0 && comp_(entry.priority, heap_[(hole - 1) / D].priority)){
+            sift_up(hole, std::move(entry));
+        }else{
+            sift_down(hole, std::move(entry));
+        }
+    }else{
+        heap_.pop_back();
+    }
+    return true;
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+void indexed_heap<Key, Priority, Compare, D>::clear() noexcept{
+    for(size_type k = 0; k < heap_.size(); ++k){
+        pos_[index_of(heap_[k].key)] = npos;
+    }
+    heap_.clear();
+}
+
+// the slot at hole is free to be overwritten; ancestors that entry beats move down into it
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+void indexed_heap<Key, Priority, Compare, D>::sift_up(size_type hole, entry_type&& entry){
+    while(hole > 0){
+        const size_type parent = (hole - 1) / D;
+        if(!comp_(entry.priority, heap_[parent].priority)){
+            break;
+        }
+        move_entry(parent, hole);
+        hole = parent;
+    }
+    place(hole, std::move(entry));
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+void indexed_heap<Key, Priority, Compare, D>::sift_down(size_type hole, entry_type&& entry){
+    const size_type len = heap_.size();
+    for(size_type child = D * hole + 1; child < len; child = D * hole + 1){
+        const size_type end = len - child < D ? len : child + D;
+        size_type best = child;
+        for(size_type c = child + 1; c < end; ++c){
+            best = comp_(heap_[c].priority, heap_[best].priority) ? c : best;
+        }
+        if(!comp_(heap_[best].priority, entry.priority)){
+            break;
+        }
+        move_entry(best, hole);
+        hole = best;
+    }
+    place(hole, std::move(entry));
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+void indexed_heap<Key, Priority, Compare, D>::place(size_type hole, entry_type&& entry){
+    pos_[index_of(entry.key)] = hole;
+    heap_[hole] = std::move(entry);
+}
+
+template <typename Key, typename Priority, typename Compare, std::size_t D>
+void indexed_heap<Key, Priority, Compare, D>::move_entry(size_type from, size_type to){
+    pos_[index_of(heap_[from].key)] = to;
+    heap_[to] = std::move(heap_[from]);
+}
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef TINYSTL_INTERVAL_TREE_H
+#define TINYSTL_INTERVAL_TREE_H
+
+#include <cassert>
+#include <functional>
+#include "rb_tree.h"
+
+namespace hstl{
+
+// the closed interval [low, high]
+template <typename T>
+struct interval{
+    T low;
+    T high;
+
+    interval() : low(), high(){}
+    interval(const T& l, const T& h) : low(l), high(h){}
+};
+
+template <typename T>
+struct interval_low{
+    typedef T result_type;
+
+    const T& operator()(const interval<T>& x) const{
+        return x.low;
+    }
+};
+
+// the largest high end in a subtree
+template <typename T, typename Compare>
+struct interval_max_high{
+    typedef T summary_type;
+
+    template <typename Node>
+    static summary_type summarize(const Node* x){
+        Compare comp;
+        const T* m = &x->data.high;
+        if(x->left != nullptr && comp(*m, static_cast<const Node*>(x->left)->summary)){
+            m = &static_cast<const Node*>(x->left)->summary;
+        }
+        if(x->right != nullptr && comp(*m, static_cast<const Node*>(x->right)->summary)){
+            m = &static_cast<const Node*>(x->right)->summary;
+        }
+        return *m;
+    }
+};
+
+// closed intervals ordered by their low end, every node also keeps the largest high end of
+// its subtree (CLRS 14.3); insert and erase are O(log n)
+//
+// a query skips every subtree whose largest high end is below it and stops going right
+// once the low ends pass it, which costs O(log n) per reported interval at worst and
+// O(log n + k) when the k results sit together, as they do for short intervals
+template <typename T, typename Compare = std::less<T>>
+class interval_tree{
+public:
+    typedef interval<T>                                 value_type;
+    typedef T                                           point_type;
+    typedef Compare                                     point_compare;
+
+private:
+    typedef hstl::rb_tree<value_type, Compare, interval_low<T>, interval_max_high<T, Compare>> tree_type;
+    typedef typename tree_type::link_type               link_type;
+
+    tree_type tree_;
+
+public:
+    typedef typename tree_type::size_type               size_type;
+    // the low end is the key, intervals cannot be changed in place
+    typedef typename tree_type::const_iterator          iterator;
+    typedef typename tree_type::const_iterator          const_iterator;
+
+    interval_tree() : tree_(){}
+    explicit interval_tree(const Compare& comp) : tree_(comp){}
+
+    iterator begin() const{ return tree_.begin(); }
+    iterator end() const{ return tree_.end(); }
+    size_type size() const{ return tree_.size(); }
+    bool empty() const{ return tree_.empty(); }
+    void clear() noexcept{ tree_.clear(); }
+
+    iterator insert(const T& low, const T& high){ return insert(value_type(low, high)); }
+    iterator insert(const value_type& x);
+    iterator erase(iterator position){ return tree_.erase(typename tree_type::iterator(static_cast<link_type>(position.node))); }
+
+    // write an iterator to every interval that meets [lo, hi] to out, in order of low end
+    template <typename OutputIterator>
+    OutputIterator overlap(const T& lo, const T& hi, OutputIterator out) const;
+    // the intervals that contain p
+    template <typename OutputIterator>
+    OutputIterator stab(const T& p, OutputIterator out) const{ return overlap(p, p, out); }
+    // some interval that meets [lo, hi], end() if none, O(log n)
+    iterator find_any(const T& lo, const T& hi) const;
+
+    bool is_balanced() const{ return tree_.is_balanced(); }
+
+private:
+    bool meets(link_type x, const T& lo, const T& hi) const{
+        return !comp()(x->data.high, lo) && !comp()(hi, x->data.low);
+    }
+    Compare comp() const{ return tree_.key_comp(); }
+
+    template <typename OutputIterator>
+    OutputIterator overlap(link_type x, const T& lo, const T& hi, OutputIterator out) const;
+};
+
+template <typename T, typename Compare>
+typename interval_tree<T, Compare>::iterator interval_tree<T, Compare>::insert(const value_type& x){
+    assert(!comp()(x.high, x.low));
+    return tree_.insert_equal(x);
+}
+
+template <typename T, typename Compare>
+template <typename OutputIterator>
+OutputIterator interval_tree<T, Compare>::overlap(const T& lo, const T& hi, OutputIterator out) const{
+    return overlap(tree_.root_node(), lo, hi, out);
+}
+
+// recursion depth is the tree height
+template <typename T, typename Compare>
+template <typename OutputIterator>
+OutputIterator interval_tree<T, Compare>::overlap(link_type x, const T& lo, const T& hi, OutputIterator out) const{
+    while(x != nullptr && !comp()(x->summary, lo)){
+        out = overlap(static_cast<link_type>(x->left), lo, hi, out);
+        if(comp()(hi, x->data.low)){
+            // x and everything right of it start after hi
+            break;
+        }
+        if(!comp()(x->data.high, lo)){
+            *out = iterator(x);
+            ++out;
+        }
+        x = static_cast<link_type>(x->right);
+    }
+    return out;
+}
+
+// go left whenever the left subtree reaches lo: if nothing there meets [lo, hi] then
+// nothing to the right does either, its intervals start even later
+template <typename T, typename Compare>
+typename interval_tree<T, Compare>::iterator interval_tree<T, Compare>::find_any(const T& lo, const T& hi) const{
+    link_type x = tree_.root_node();
+    while(x != nullptr && !meets(x, lo, hi)){
+        link_type l = static_cast<link_type>(x->left);
+        x = (l != nullptr && !comp()(l->summary, lo)) ? l : static_cast<link_type>(x->right);
+    }
+    return x == nullptr ? end() : iterator(x);
+}
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef TINYSTL_MAP_H
+#define TINYSTL_MAP_H
+
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "functional.h"
+#include "rb_tree.h"
+
+namespace hstl{
+
+// sorted unique keys mapped to values, an rb_tree of pair<const Key, T> keyed by first;
+// NodeBase picks the node layout, see rb_tree_node_base
+template <typename Key, typename T, typename Compare = std::less<Key>, typename NodeBase = rb_tree_node_base>
+class map{
+public:
+    typedef Key                                         key_type;
+    typedef T                                           mapped_type;
+    typedef std::pair<const Key, T>                     value_type;
+    typedef Compare                                     key_compare;
+
+private:
+    typedef hstl::rb_tree<value_type, Compare, hstl::select1st<value_type>, rb_tree_no_augment, NodeBase> tree_type;
+
+    tree_type tree_;
+
+public:
+    typedef typename tree_type::reference               reference;
+    typedef typename tree_type::const_reference         const_reference;
+    typedef typename tree_type::size_type               size_type;
+    typedef typename tree_type::iterator                iterator;
+    typedef typename tree_type::const_iterator          const_iterator;
+
+    map() : tree_(){}
+    explicit map(const Compare& comp) : tree_(comp){}
+    template <typename InputIterator>
+    map(InputIterator first, InputIterator last, const Compare& comp = Compare()) : tree_(comp){
+        insert(first, last);
+    }
+
+    key_compare key_comp() const{ return tree_.key_comp(); }
+    iterator begin(){ return tree_.begin(); }
+    const_iterator begin() const{ return tree_.begin(); }
+    iterator end(){ return tree_.end(); }
+    const_iterator end() const{ return tree_.end(); }
+    size_type size() const{ return tree_.size(); }
+    bool empty() const{ return tree_.empty(); }
+
+    // one descent; the value is default constructed only when the key is new
+    mapped_type& operator[](const key_type& k){ return tree_.try_emplace(k, std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple()).first->second; }
+    mapped_type& operator[](key_type&& k){ return tree_.try_emplace(k, std::piecewise_construct, std::forward_as_tuple(std::move(k)), std::forward_as_tuple()).first->second; }
+    mapped_type& at(const key_type& k);
+    const mapped_type& at(const key_type& k) const;
+
+    std::pair<iterator, bool> insert(const value_type& value){ return tree_.insert_unique(value); }
+    std::pair<iterator, bool> insert(value_type&& value){ return tree_.insert_unique(std::move(value)); }
+    template <typename InputIterator>
+    void insert(InputIterator first, InputIterator last){
+        for(; first != last; ++first){
+            tree_.insert_unique(*first);
+        }
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args){ return tree_.emplace_unique(std::forward<Args>(args)...); }
+    // nothing is built, and args are left alone, when k is already present
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& k, Args&&... args){
+        return tree_.try_emplace(k, std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& k, Args&&... args){
+        return tree_.try_emplace(k, std::piecewise_construct, std::forward_as_tuple(std::move(k)), std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    iterator erase(iterator position){ return tree_.erase(position); }
+    size_type erase(const key_type& k){ return tree_.erase(k); }
+
+    iterator find(const key_type& k){ return tree_.find(k); }
+    const_iterator find(const key_type& k) const{ return tree_.find(k); }
+    size_type count(const key_type& k) const{ return tree_.count(k); }
+    iterator lower_bound(const key_type& k){ return tree_.lower_bound(k); }
+    const_iterator lower_bound(const key_type& k) const{ return tree_.lower_bound(k); }
+    iterator upper_bound(const key_type& k){ return tree_.upper_bound(k); }
+    const_iterator upper_bound(const key_type& k) const{ return tree_.upper_bound(k); }
+    std::pair<iterator, iterator> equal_range(const key_type& k){ return tree_.equal_range(k); }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& k) const{ return tree_.equal_range(k); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& k){ return tree_.find(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const K& k) const{ return tree_.find(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K& k) const{ return tree_.count(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& k){ return tree_.lower_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K& k) const{ return tree_.lower_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& k){ return tree_.upper_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K& k) const{ return tree_.upper_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& k){ return tree_.equal_range(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& k) const{ return tree_.equal_range(k); }
+};
+
+template <typename Key, typename T, typename Compare, typename NodeBase>
+typename map<Key, T, Compare, NodeBase>::mapped_type& map<Key, T, Compare, NodeBase>::at(const key_type& k){
+    iterator it = tree_.find(k);
+    if(it == tree_.end()){
+        throw std::out_of_range("map::at");
+    }
+    return it->second;
+}
+
+template <typename Key, typename T, typename Compare, typename NodeBase>
+const typename map<Key, T, Compare, NodeBase>::mapped_type& map<Key, T, Compare, NodeBase>::at(const key_type& k) const{
+    const_iterator it = tree_.find(k);
+    if(it == tree_.end()){
+        throw std::out_of_range("map::at");
+    }
+    return it->second;
+}
+
+
+// sorted keys mapped to values, equal keys allowed and kept in insertion order
+template <typename Key, typename T, typename Compare = std::less<Key>, typename NodeBase = rb_tree_node_base>
+class multimap{
+public:
+    typedef Key                                         key_type;
+    typedef T                                           mapped_type;
+    typedef std::pair<const Key, T>                     value_type;
+    typedef Compare                                     key_compare;
+
+private:
+    typedef hstl::rb_tree<value_type, Compare, hstl::select1st<value_type>, rb_tree_no_augment, NodeBase> tree_type;
+
+    tree_type tree_;
+
+public:
+    typedef typename tree_type::reference               reference;
+    typedef typename tree_type::const_reference         const_reference;
+    typedef typename tree_type::size_type               size_type;
+    typedef typename tree_type::iterator                iterator;
+    typedef typename tree_type::const_iterator          const_iterator;
+
+    multimap() : tree_(){}
+    explicit multimap(const Compare& comp) : tree_(comp){}
+    template <typename InputIterator>
+    multimap(InputIterator first, InputIterator last, const Compare& comp = Compare()) : tree_(comp){
+        insert(first, last);
+    }
+
+    key_compare key_comp() const{ return tree_.key_comp(); }
+    iterator begin(){ return tree_.begin(); }
+    const_iterator begin() const{ return tree_.begin(); }
+    iterator end(){ return tree_.end(); }
+    const_iterator end() const{ return tree_.end(); }
+    size_type size() const{ return tree_.size(); }
+    bool empty() const{ return tree_.empty(); }
+
+    iterator insert(const value_type& value){ return tree_.insert_equal(value); }
+    iterator insert(value_type&& value){ return tree_.insert_equal(std::move(value)); }
+    template <typename InputIterator>
+    void insert(InputIterator first, InputIterator last){
+        for(; first != last; ++first){
+            tree_.insert_equal(*first);
+        }
+    }
+    template <typename... Args>
+    iterator emplace(Args&&... args){ return tree_.emplace_equal(std::forward<Args>(args)...); }
+
+    iterator erase(iterator position){ return tree_.erase(position); }
+    size_type erase(const key_type& k){ return tree_.erase(k); }
+
+    iterator find(const key_type& k){ return tree_.find(k); }
+    const_iterator find(const key_type& k) const{ return tree_.find(k); }
+    size_type count(const key_type& k) const{ return tree_.count(k); }
+    iterator lower_bound(const key_type& k){ return tree_.lower_bound(k); }
+    const_iterator lower_bound(const key_type& k) const{ return tree_.lower_bound(k); }
+    iterator upper_bound(const key_type& k){ return tree_.upper_bound(k); }
+    const_iterator upper_bound(const key_type& k) const{ return tree_.upper_bound(k); }
+    std::pair<iterator, iterator> equal_range(const key_type& k){ return tree_.equal_range(k); }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& k) const{ return tree_.equal_range(k); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& k){ return tree_.find(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const K& k) const{ return tree_.find(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K& k) const{ return tree_.count(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& k){ return tree_.lower_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K& k) const{ return tree_.lower_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& k){ return tree_.upper_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K& k) const{ return tree_.upper_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& k){ return tree_.equal_range(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& k) const{ return tree_.equal_range(k); }
+};
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,272 @@
+#ifndef TINYSTL_MPMC_QUEUE_H
+#define TINYSTL_MPMC_QUEUE_H
+
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <type_traits>
+#include "allocator.h"
+#include "construct.h"
+
+namespace hstl{
+
+#ifndef TINYSTL_CACHE_LINE_SIZE
+#define TINYSTL_CACHE_LINE_SIZE 64
+#endif
+
+template <typename T>
+struct mpmc_queue_slot{
+    // == position:     free, a producer may claim it for that position
+    // == position + 1: holds the element of that position, a consumer may claim it
+    std::atomic<std::size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+    T* value_ptr() noexcept { return reinterpret_cast<T*>(&storage); }
+};
+
+// bounded multi-producer / multi-consumer queue, Dmitry Vyukov's sequence-number array
+//
+// producers and consumers each advance their own position counter with a CAS and then
+// own the slot they claimed, the slot's sequence number tells whether it is free or full
+// for the current lap, so no other synchronisation is needed
+template <typename T>
+class mpmc_queue{
+public:
+    typedef mpmc_queue_slot<T>                          slot_type;
+    typedef hstl::allocator<slot_type>                  slot_allocator;
+
+    typedef T                                           value_type;
+    typedef T&                                          reference;
+    typedef std::size_t                                 size_type;
+
+    static constexpr size_type cache_line_size = TINYSTL_CACHE_LINE_SIZE;
+
+private:
+    alignas(cache_line_size) slot_type* slots_;
+    size_type mask_;
+    alignas(cache_line_size) std::atomic<size_type> enqueue_pos_;
+    alignas(cache_line_size) std::atomic<size_type> dequeue_pos_;
+
+public:
+    // capacity is rounded up to a power of two, at least 2
+    explicit mpmc_queue(size_type capacity);
+    ~mpmc_queue();
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    size_type capacity() const noexcept { return mask_ + 1; }
+    size_type size_approx() const noexcept;
+
+    // non-blocking, return false when full / empty
+    template <typename... Args>
+    bool try_emplace(Args&&... args);
+    bool try_push(const value_type& value);
+    bool try_push(value_type&& value);
+    bool try_pop(value_type& value);
+
+    // blocking, spin with backoff until there is room / an element
+    template <typename... Args>
+    void emplace(Args&&... args);
+    void push(const value_type& value);
+    void push(value_type&& value);
+    void pop(value_type& value);
+
+private:
+    slot_type* claim_enqueue();
+    slot_type* claim_dequeue(size_type& pos);
+
+    template <typename... Args>
+    bool try_emplace_aux(std::true_type, Args&&... args);
+    template <typename... Args>
+    bool try_emplace_aux(std::false_type, Args&&... args);
+
+    static size_type round_up_capacity(size_type n) noexcept;
+    static void backoff(unsigned& spins) noexcept;
+};
+
+
+template <typename T>
+mpmc_queue<T>::mpmc_queue(size_type capacity)
+    : slots_(nullptr), mask_(round_up_capacity(capacity) - 1), enqueue_pos_(0), dequeue_pos_(0){
+    slots_ = slot_allocator::allocate(mask_ + 1);
+    for(size_type i = 0; i <= mask_; ++i){
+        ::new(static_cast<void*>(&slots_[i].sequence)) std::atomic<size_type>(i);
+    }
+}
+
+template <typename T>
+mpmc_queue<T>::~mpmc_queue(){
+    size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+    const size_type end = enqueue_pos_.load(std::memory_order_relaxed);
+    for(; pos != end; ++pos){
+        hstl::destroy(slots_[pos & mask_].value_ptr());
+    }
+    slot_allocator::deallocate(slots_, mask_ + 1);
+}
+
+template <typename T>
+typename mpmc_queue<T>::size_type mpmc_queue<T>::size_approx() const noexcept{
+    const size_type head = dequeue_pos_.load(std::memory_order_relaxed);
+    const size_type tail = enqueue_pos_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
+
+template <typename T>
+template <typename... Args>
+bool mpmc_queue<T>::try_emplace(Args&&... args){
+    static_assert(std::is_nothrow_move_constructible<T>::value || std::is_nothrow_constructible<T, Args&&...>::value,
+        "mpmc_queue needs a nothrow move constructor or a nothrow emplace");
+    return try_emplace_aux(std::integral_constant<bool, std::is_nothrow_constructible<T, Args&&...>::value>(),
+        std::forward<Args>(args)...);
+}
+
+// a claimed slot must be published, so construct in place only if that cannot throw
+template <typename T>
+template <typename... Args>
+bool mpmc_queue<T>::try_emplace_aux(std::true_type, Args&&... args){
+    slot_type* slot = claim_enqueue();
+    if(slot == nullptr){
+        return false;
+    }
+    const size_type seq = slot->sequence.load(std::memory_order_relaxed);
+    // placement new rather than hstl::construct, whose (ptr, const Ty2&) overload would
+    // build a Ty2 instead of converting to T
+    ::new(static_cast<void*>(slot->value_ptr())) T(std::forward<Args>(args)...);
+    slot->sequence.store(seq + 1, std::memory_order_release);
+    return true;
+}
+
+// otherwise build the element first and move it into the slot
+template <typename T>
+template <typename... Args>
+bool mpmc_queue<T>::try_emplace_aux(std::false_type, Args&&... args){
+    value_type tmp(std::forward<Args>(args)...);
+    return try_emplace_aux(std::true_type(), std::move(tmp));
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_push(const value_type& value){
+    return try_emplace(value);
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_push(value_type&& value){
+    return try_emplace(std::move(value));
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_pop(value_type& value){
+    size_type pos;
+    slot_type* slot = claim_dequeue(pos);
+    if(slot == nullptr){
+        return false;
+    }
+    T* p = slot->value_ptr();
+    // the slot is released even if the assignment throws, the element is then dropped
+    struct release_guard{
+        slot_type* slot;
+        T* p;
+        size_type next;
+        ~release_guard(){
+            hstl::destroy(p);
+            slot->sequence.store(next, std::memory_order_release);
+        }
+    } guard{slot, p, pos + mask_ + 1};
+    value = std::move(*p);
+    return true;
+}
+
+template <typename T>
+template <typename... Args>
+void mpmc_queue<T>::emplace(Args&&... args){
+    value_type tmp(std::forward<Args>(args)...);
+    unsigned spins = 0;
+    while(!try_emplace(std::move(tmp))){
+        backoff(spins);
+    }
+}
+
+template <typename T>
+void mpmc_queue<T>::push(const value_type& value){
+    unsigned spins = 0;
+    while(!try_push(value)){
+        backoff(spins);
+    }
+}
+
+template <typename T>
+void mpmc_queue<T>::push(value_type&& value){
+    unsigned spins = 0;
+    while(!try_emplace(std::move(value))){
+        backoff(spins);
+    }
+}
+
+template <typename T>
+void mpmc_queue<T>::pop(value_type& value){
+    unsigned spins = 0;
+    while(!try_pop(value)){
+        backoff(spins);
+    }
+}
+
+template <typename T>
+typename mpmc_queue<T>::slot_type* mpmc_queue<T>::claim_enqueue(){
+    size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for(;;){
+        slot_type* slot = &slots_[pos & mask_];
+        const size_type seq = slot->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if(diff == 0){
+            if(enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                return slot;
+            }
+        }else if(diff < 0){
+            return nullptr; // full
+        }else{
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+typename mpmc_queue<T>::slot_type* mpmc_queue<T>::claim_dequeue(size_type& pos){
+    pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for(;;){
+        slot_type* slot = &slots_[pos & mask_];
+        const size_type seq = slot->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+        if(diff == 0){
+            if(dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                return slot;
+            }
+        }else if(diff < 0){
+            return nullptr; // empty
+        }else{
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+typename mpmc_queue<T>::size_type mpmc_queue<T>::round_up_capacity(size_type n) noexcept{
+    size_type capacity = 2;
+    while(capacity < n){
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+template <typename T>
+void mpmc_queue<T>::backoff(unsigned& spins) noexcept{
+    if(++spins < 64){
+        return;
+    }
+    std::this_thread::yield();
+}
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef TINYSTL_PARALLEL_HEAP_H
+#define TINYSTL_PARALLEL_HEAP_H
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include "heap.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace hstl{
+
+// make_heap with the sifts of each level run on the pool
+//
+// the subtrees below the nodes of one level are disjoint, so those nodes can be sifted
+// down concurrently once the level underneath is done; levels with fewer than grain
+// nodes, the top ones, are not worth the fork and run on the calling thread
+template <class RandomAccessIterator, class Compare>
+void parallel_make_heap(hstl::thread_pool& pool, RandomAccessIterator first, RandomAccessIterator last,
+    Compare comp, typename std::iterator_traits<RandomAccessIterator>::difference_type grain = 4096){
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    const difference_type len = last - first;
+    if(len < 2){
+        return;
+    }
+    const difference_type last_parent = (len - 2) / 2;
+    // first node of the deepest level that has a parent
+    difference_type level_begin = 0;
+    while(2 * level_begin + 1 <= last_parent){
+        level_begin = 2 * level_begin + 1;
+    }
+    auto sift = [first, len, &comp](difference_type i){
+        value_type value = std::move(*(first + i));
+        hstl::__adjust_heap(first, i, len, std::move(value), comp);
+    };
+    for(;;){
+        const difference_type level_end = 2 * level_begin + 1 < last_parent + 1 ? 2 * level_begin + 1 : last_parent + 1;
+        if(level_end - level_begin >= grain){
+            pool.parallel_for(level_begin, level_end, grain, sift);
+        }else{
+            for(difference_type i = level_end; i-- > level_begin; ){
+                sift(i);
+            }
+        }
+        if(level_begin == 0){
+            return;
+        }
+        level_begin = (level_begin - 1) / 2;
+    }
+}
+
+template <class RandomAccessIterator>
+inline void parallel_make_heap(hstl::thread_pool& pool, RandomAccessIterator first, RandomAccessIterator last){
+    hstl::parallel_make_heap(pool, first, last, __heap_less());
+}
+
+// top_k over chunks of the input on the pool, then once more over the chunk winners
+template <class RandomAccessIterator1, class RandomAccessIterator2, class Compare>
+RandomAccessIterator2 parallel_top_k(hstl::thread_pool& pool, RandomAccessIterator1 first, RandomAccessIterator1 last,
+    RandomAccessIterator2 result_first, RandomAccessIterator2 result_last, Compare comp){
+    typedef typename std::iterator_traits<RandomAccessIterator2>::value_type value_type;
+    typedef typename std::iterator_traits<RandomAccessIterator1>::difference_type difference_type;
+    const difference_type n = last - first;
+    const difference_type k = result_last - result_first;
+    const difference_type chunks = static_cast<difference_type>(pool.size()) * 4;
+    // not worth splitting when a chunk would hold little more than its own k winners
+    if(k == 0 || n < chunks * k * 4){
+        return hstl::top_k(first, last, result_first, result_last, comp);
+    }
+    const difference_type chunk = (n + chunks - 1) / chunks;
+    hstl::vector<value_type> winners(static_cast<std::size_t>(chunks * k));
+    hstl::vector<difference_type> found(static_cast<std::size_t>(chunks));
+    pool.parallel_for(difference_type(0), chunks, difference_type(1), [&](difference_type c){
+        if(c * chunk >= n){
+            found[c] = 0;
+            return;
+        }
+        RandomAccessIterator1 lo = first + c * chunk;
+        RandomAccessIterator1 hi = n - c * chunk > chunk ? lo + chunk : last;
+        auto out = winners.begin() + c * k;
+        found[c] = hstl::top_k(lo, hi, out, out + k, comp) - out;
+    });
+    // compact the winners of short chunks
+    auto tail = winners.begin();
+    for(difference_type c = 0; c < chunks; ++c){
+        auto from = winners.begin() + c * k;
+        for(difference_type i = 0; i < found[c]; ++i){
+            *tail++ = std::move(*(from + i));
+        }
+    }
+    return hstl::top_k(winners.begin(), tail, result_first, result_last, comp);
+}
+
+template <class RandomAccessIterator1, class RandomAccessIterator2>
+inline RandomAccessIterator2 parallel_top_k(hstl::thread_pool& pool, RandomAccessIterator1 first, RandomAccessIterator1 last,
+    RandomAccessIterator2 result_first, RandomAccessIterator2 result_last){
+    return hstl::parallel_top_k(pool, first, last, result_first, result_last, __heap_less());
+}
+
+} // namespace hstl
+
+#endif
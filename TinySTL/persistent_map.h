@@ -0,0 +1,150 @@
+#ifndef TINYSTL_PERSISTENT_MAP_H
+#define TINYSTL_PERSISTENT_MAP_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include "functional.h"
+#include "persistent_rb_tree.h"
+
+namespace hstl{
+
+// walks one version by searching down from its root, shared nodes have no parent links to
+// climb, so ++ and -- are O(log n); for_each on the map visits everything in O(n)
+template <typename Tree>
+struct persistent_map_iterator{
+    typedef std::bidirectional_iterator_tag             iterator_category;
+    typedef std::ptrdiff_t                              difference_type;
+    typedef typename Tree::value_type                   value_type;
+    typedef const value_type&                           reference;
+    typedef const value_type*                           pointer;
+    typedef typename Tree::link_type                    link_type;
+    typedef persistent_map_iterator<Tree>               self;
+
+    const Tree* tree;
+    link_type node;     // nullptr at the end
+
+    persistent_map_iterator() : tree(nullptr), node(nullptr){}
+    persistent_map_iterator(const Tree* t, link_type x) : tree(t), node(x){}
+
+    reference operator*() const{ return node->data; }
+    pointer operator->() const{ return &node->data; }
+
+    self& operator++(){
+        node = Tree::upper_bound_node(tree->root_node(), node->data.first, tree->key_comp());
+        return *this;
+    }
+    self operator++(int){
+        self tmp = *this;
+        ++*this;
+        return tmp;
+    }
+    self& operator--(){
+        if(node == nullptr){
+            node = static_cast<link_type>(rb_tree_node_base::maximum(tree->root_node()));
+        }else{
+            node = Tree::before_node(tree->root_node(), node->data.first, tree->key_comp());
+        }
+        return *this;
+    }
+    self operator--(int){
+        self tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const{ return node == rhs.node; }
+    bool operator!=(const self& rhs) const{ return node != rhs.node; }
+};
+
+// sorted unique keys mapped to values, as an immutable value: copying a map is O(1), and
+// insert, insert_or_assign and erase return the changed map in O(log n) and leave the
+// original as it was. The versions share every node off the paths that changed (see
+// persistent_rb_tree); nodes are reference counted and go with the last version that
+// holds them, and versions may be handed to and dropped by other threads freely.
+//
+// Called on an rvalue the updates give the old map up and change the nodes no other
+// version holds in place, so m = std::move(m).insert(v) costs no more than an ordinary
+// insert once m stops sharing. Iterators belong to the map object they came from and are
+// invalidated by assigning to it
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class persistent_map{
+public:
+    typedef Key                                         key_type;
+    typedef T                                           mapped_type;
+    typedef std::pair<const Key, T>                     value_type;
+    typedef Compare                                     key_compare;
+    typedef hstl::persistent_rb_tree<value_type, Compare, hstl::select1st<value_type>> tree_type;
+    typedef typename tree_type::size_type               size_type;
+    typedef const value_type&                           const_reference;
+    typedef persistent_map_iterator<tree_type>          const_iterator;
+    typedef const_iterator                              iterator;
+
+private:
+    tree_type tree_;
+
+    explicit persistent_map(tree_type&& tree) : tree_(std::move(tree)){}
+
+public:
+    persistent_map() : tree_(){}
+    explicit persistent_map(const Compare& comp) : tree_(comp){}
+    template <typename InputIterator>
+    persistent_map(InputIterator first, InputIterator last, const Compare& comp = Compare()) : tree_(comp){
+        for(; first != last; ++first){
+            tree_ = std::move(tree_).insert(*first);
+        }
+    }
+
+    key_compare key_comp() const{ return tree_.key_comp(); }
+    const_iterator begin() const;
+    const_iterator end() const{ return const_iterator(&tree_, nullptr); }
+    size_type size() const{ return tree_.size(); }
+    bool empty() const{ return tree_.empty(); }
+
+    const mapped_type& at(const key_type& k) const;
+    const_iterator find(const key_type& k) const{ return const_iterator(&tree_, tree_type::find_node(tree_.root_node(), k, tree_.key_comp())); }
+    size_type count(const key_type& k) const{ return tree_.find(k) != nullptr ? 1 : 0; }
+    const_iterator lower_bound(const key_type& k) const{ return const_iterator(&tree_, tree_type::lower_bound_node(tree_.root_node(), k, tree_.key_comp())); }
+    const_iterator upper_bound(const key_type& k) const{ return const_iterator(&tree_, tree_type::upper_bound_node(tree_.root_node(), k, tree_.key_comp())); }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& k) const{ return std::make_pair(lower_bound(k), upper_bound(k)); }
+    // f(element) in order, for all elements or for those with lo <= key < hi
+    template <typename F>
+    void for_each(F f) const{ tree_.for_each(f); }
+    template <typename F>
+    void for_each(const key_type& lo, const key_type& hi, F f) const{ tree_.for_each(lo, hi, f); }
+
+    // the changed map; an element with the same key stays for insert and is replaced for
+    // insert_or_assign
+    persistent_map insert(const value_type& value) const&{ return persistent_map(tree_.insert(value)); }
+    persistent_map insert(const value_type& value) &&{ return persistent_map(std::move(tree_).insert(value)); }
+    persistent_map insert_or_assign(const key_type& k, const mapped_type& value) const&{ return persistent_map(tree_.insert_or_assign(value_type(k, value))); }
+    persistent_map insert_or_assign(const key_type& k, const mapped_type& value) &&{ return persistent_map(std::move(tree_).insert_or_assign(value_type(k, value))); }
+    persistent_map erase(const key_type& k) const&{ return persistent_map(tree_.erase(k)); }
+    persistent_map erase(const key_type& k) &&{ return persistent_map(std::move(tree_).erase(k)); }
+
+    const tree_type& tree() const noexcept { return tree_; }
+    void swap(persistent_map& rhs) noexcept { tree_.swap(rhs.tree_); }
+};
+
+template <typename Key, typename T, typename Compare>
+typename persistent_map<Key, T, Compare>::const_iterator persistent_map<Key, T, Compare>::begin() const{
+    if(tree_.root_node() == nullptr){
+        return end();
+    }
+    return const_iterator(&tree_, static_cast<typename tree_type::link_type>(rb_tree_node_base::minimum(tree_.root_node())));
+}
+
+template <typename Key, typename T, typename Compare>
+const typename persistent_map<Key, T, Compare>::mapped_type& persistent_map<Key, T, Compare>::at(const key_type& k) const{
+    const value_type* v = tree_.find(k);
+    if(v == nullptr){
+        throw std::out_of_range("persistent_map::at");
+    }
+    return v->second;
+}
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,548 @@
+#ifndef TINYSTL_PERSISTENT_RB_TREE_H
+#define TINYSTL_PERSISTENT_RB_TREE_H
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <utility>
+#include "allocator.h"
+#include "functional.h"
+#include "rb_tree.h"
+
+namespace hstl{
+
+// a node that may be shared by several versions of a persistent_rb_tree; refs counts the
+// links and roots that point at it. Parent links are only meaningful inside the copies an
+// update is working on, a shared node is never written again apart from refs
+template <typename T>
+struct persistent_rb_node : public rb_tree_node_base{
+    std::atomic<std::size_t> refs;
+    T data;
+
+    template <typename... Args>
+    explicit persistent_rb_node(Args&&... args) : refs(1), data(std::forward<Args>(args)...){}
+};
+
+// one version of a red-black tree of unique keys on shared nodes
+//
+// insert and erase leave *this alone and return a new version that copies the nodes on
+// the path to the change and shares every other subtree with *this (path copying). The
+// copies carry parent links, so the rebalancing of rb_tree runs on them unchanged; the few
+// nodes off the path that it recolors or relinks are found beforehand from the colors
+// alone and copied too. Called on an rvalue they give the version up instead, and the
+// nodes no other version holds are changed in place rather than copied. Copying a version
+// is O(1), and versions sharing nodes may be read, copied and destroyed from any number of
+// threads.
+//
+// updates copy elements, so T must be copy constructible; if a copy or an allocation
+// throws the update has no effect
+template <typename T, typename Compare, typename KeyOfValue = hstl::identity<T>>
+class persistent_rb_tree{
+public:
+    typedef persistent_rb_node<T>                       node_type;
+    typedef hstl::allocator<node_type>                  node_allocator;
+    typedef node_type*                                  link_type;
+    typedef rb_tree_node_base::base_ptr                 base_ptr;
+    typedef typename KeyOfValue::result_type            key_type;
+    typedef Compare                                     key_compare;
+    typedef T                                           value_type;
+    typedef std::size_t                                 size_type;
+
+    // a red-black tree of n nodes is at most 2 log2(n + 1) high
+    static constexpr size_type max_height = 2 * sizeof(size_type) * CHAR_BIT;
+
+private:
+    link_type   root_;
+    size_type   size_;
+    key_compare key_compare_;
+
+public:
+    persistent_rb_tree() : persistent_rb_tree(key_compare()){}
+    explicit persistent_rb_tree(const key_compare& comp) : root_(nullptr), size_(0), key_compare_(comp){}
+    persistent_rb_tree(const persistent_rb_tree& rhs) : root_(retain(rhs.root_)), size_(rhs.size_), key_compare_(rhs.key_compare_){}
+    persistent_rb_tree(persistent_rb_tree&& rhs) noexcept;
+    ~persistent_rb_tree(){ release(root_); }
+
+    persistent_rb_tree& operator=(const persistent_rb_tree& rhs);
+    persistent_rb_tree& operator=(persistent_rb_tree&& rhs) noexcept;
+
+    void swap(persistent_rb_tree& rhs) noexcept;
+
+    key_compare key_comp() const{ return key_compare_; }
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    // the root node, nullptr if empty; stays valid as long as a version holding it
+    link_type root_node() const noexcept { return root_; }
+
+    // the element with key k, nullptr if there is none; it lives as long as any version
+    // that holds it
+    const value_type* find(const key_type& k) const;
+    // f(element) for every element in order, or for those with lo <= key < hi
+    template <typename F>
+    void for_each(F f) const{ for_each_node(root_, f); }
+    template <typename F>
+    void for_each(const key_type& lo, const key_type& hi, F f) const{ for_each_node(root_, lo, hi, key_compare_, f); }
+
+    // the new version; an element with the same key stays, or is replaced by value for
+    // insert_or_assign
+    persistent_rb_tree insert(const value_type& value) const&{ return persistent_rb_tree(*this).insert(value); }
+    persistent_rb_tree insert(const value_type& value) &&{ insert_value(value, false); return std::move(*this); }
+    persistent_rb_tree insert_or_assign(const value_type& value) const&{ return persistent_rb_tree(*this).insert_or_assign(value); }
+    persistent_rb_tree insert_or_assign(const value_type& value) &&{ insert_value(value, true); return std::move(*this); }
+    persistent_rb_tree erase(const key_type& k) const&{ return persistent_rb_tree(*this).erase(k); }
+    persistent_rb_tree erase(const key_type& k) &&{ erase_key(k); return std::move(*this); }
+
+    // the same searches on a bare root, for readers that hold no version of their own
+    static link_type find_node(link_type x, const key_type& k, const key_compare& comp);
+    // the first node with key >= k / key > k, the last one with key < k; nullptr if none
+    static link_type lower_bound_node(link_type x, const key_type& k, const key_compare& comp);
+    static link_type upper_bound_node(link_type x, const key_type& k, const key_compare& comp);
+    static link_type before_node(link_type x, const key_type& k, const key_compare& comp);
+    template <typename F>
+    static void for_each_node(link_type x, F& f);
+    template <typename F>
+    static void for_each_node(link_type x, const key_type& lo, const key_type& hi, const key_compare& comp, F& f);
+
+    // take and drop a reference to the nodes under x; the last release frees them
+    static link_type retain(link_type x) noexcept;
+    static void release(link_type x) noexcept;
+
+    // check the red-black invariants, the order and the reference counts, for tests
+    bool is_balanced() const;
+
+private:
+    // the updates in place, on nodes that are unshared first; until the rebalancing, which
+    // cannot throw, the tree keeps its elements
+    void insert_value(const value_type& value, bool assign);
+    void erase_key(const key_type& k);
+    template <typename... Args>
+    static link_type create_node(Args&&... args);
+    static void destroy_node(link_type x) noexcept;
+    // x exclusively, to be written: x itself if this reference is the only one, else a copy
+    // that shares the children of x, and the reference to x is given up
+    static link_type unshare(link_type x);
+    // unshare the child of p on the given side, which is then linked back to p
+    static void unshare_child(link_type p, bool left);
+    // unshare the subtree at the child of p down to depth levels below it
+    static void unshare_below(link_type p, bool left, size_type depth);
+    static const key_type& key(base_ptr x){ return KeyOfValue()(static_cast<link_type>(x)->data); }
+    static bool is_red(base_ptr x){ return x != nullptr && rb_tree_is_red(x); }
+    static base_ptr child(base_ptr x, bool left){ return left ? x->left : x->right; }
+    int is_balanced(link_type x) const;
+};
+
+
+template <typename T, typename Compare, typename KeyOfValue>
+persistent_rb_tree<T, Compare, KeyOfValue>::persistent_rb_tree(persistent_rb_tree&& rhs) noexcept
+    : root_(rhs.root_), size_(rhs.size_), key_compare_(rhs.key_compare_){
+    rhs.root_ = nullptr;
+    rhs.size_ = 0;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+persistent_rb_tree<T, Compare, KeyOfValue>& persistent_rb_tree<T, Compare, KeyOfValue>::operator=(const persistent_rb_tree& rhs){
+    persistent_rb_tree tmp(rhs);
+    swap(tmp);
+    return *this;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+persistent_rb_tree<T, Compare, KeyOfValue>& persistent_rb_tree<T, Compare, KeyOfValue>::operator=(persistent_rb_tree&& rhs) noexcept{
+    persistent_rb_tree tmp(std::move(rhs));
+    swap(tmp);
+    return *this;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+void persistent_rb_tree<T, Compare, KeyOfValue>::swap(persistent_rb_tree& rhs) noexcept{
+    std::swap(root_, rhs.root_);
+    std::swap(size_, rhs.size_);
+    std::swap(key_compare_, rhs.key_compare_);
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+const typename persistent_rb_tree<T, Compare, KeyOfValue>::value_type* persistent_rb_tree<T, Compare, KeyOfValue>::find(const key_type& k) const{
+    link_type x = find_node(root_, k, key_compare_);
+    return x != nullptr ? &x->data : nullptr;
+}
+
+// the path to the key is copied; for a new key the leaf goes in red and the insert fixup
+// of rb_tree runs on the copies. Which nodes the fixup touches follows from the colors: it
+// climbs two levels per red uncle (case 3) and stops at a black parent or with one or two
+// rotations, so the siblings of the path from that level down are copied as well
+template <typename T, typename Compare, typename KeyOfValue>
+void persistent_rb_tree<T, Compare, KeyOfValue>::insert_value(const value_type& value, bool assign){
+    const key_type& k = KeyOfValue()(value);
+    base_ptr path[max_height];
+    bool went_left[max_height];
+    size_type depth = 0;
+    bool found = false;
+    for(base_ptr x = root_; x != nullptr; ){
+        path[depth] = x;
+        if(key_compare_(k, key(x))){
+            went_left[depth++] = true;
+            x = x->left;
+        }else if(key_compare_(key(x), k)){
+            went_left[depth++] = false;
+            x = x->right;
+        }else{
+            found = true;
+            break;
+        }
+    }
+    if(found && !assign){
+        return;
+    }
+
+    link_type leaf = create_node(value);
+    try{
+        // the path above the key, then the node with the key is replaced by the leaf
+        link_type p = nullptr;
+        for(size_type i = 0; i < depth; ++i){
+            link_type c = p == nullptr ? (root_ = unshare(root_)) : (unshare_child(p, went_left[i - 1]), static_cast<link_type>(child(p, went_left[i - 1])));
+            rb_tree_set_parent(c, p);
+            path[i] = c;
+            p = c;
+        }
+        if(found){
+            link_type old = p == nullptr ? root_ : static_cast<link_type>(child(p, went_left[depth - 1]));
+            rb_tree_set_color(leaf, rb_tree_color(old));
+            leaf->left = retain(static_cast<link_type>(old->left));
+            leaf->right = retain(static_cast<link_type>(old->right));
+            rb_tree_set_parent(leaf, p);
+            if(p == nullptr){
+                root_ = leaf;
+            }else{
+                (went_left[depth - 1] ? p->left : p->right) = leaf;
+            }
+            release(old);
+            return;
+        }
+        if(p == nullptr){
+            rb_tree_set_black(leaf);
+            root_ = leaf;
+            size_ = 1;
+            return;
+        }
+
+        // replay the colors of the fixup: the leaf is level depth, its parent depth - 1
+        size_type j = depth;
+        bool rotates = false;
+        while(j > 0 && is_red(path[j - 1])){
+            if(is_red(child(path[j - 2], !went_left[j - 2]))){
+                j -= 2;
+            }else{
+                rotates = true;
+                break;
+            }
+        }
+        for(size_type level = (rotates ? j : j + 1); level <= depth; ++level){
+            if(level > 0){
+                unshare_child(static_cast<link_type>(path[level - 1]), !went_left[level - 1]);
+            }
+        }
+    }catch(...){
+        destroy_node(leaf);
+        throw;
+    }
+    (went_left[depth - 1] ? path[depth - 1]->left : path[depth - 1]->right) = leaf;
+    rb_tree_set_parent(leaf, path[depth - 1]);
+    base_ptr top = root_;
+    rb_tree_insert_rebalance(leaf, top);
+    root_ = static_cast<link_type>(top);
+    ++size_;
+}
+
+// the path to the node that really leaves the tree (the successor when the key has two
+// children) is copied, and the erase fixup of rb_tree runs on the copies. It recolors the
+// sibling at every level it climbs (case 2) and at the level where it stops rotates within
+// the subtree of the sibling, at most three levels into it; all of that is copied first
+template <typename T, typename Compare, typename KeyOfValue>
+void persistent_rb_tree<T, Compare, KeyOfValue>::erase_key(const key_type& k){
+    base_ptr path[max_height];
+    bool went_left[max_height];
+    size_type depth = 0;
+    size_type z_depth = 0;
+    bool found = false;
+    for(base_ptr x = root_; x != nullptr; ){
+        path[depth] = x;
+        if(key_compare_(k, key(x))){
+            went_left[depth++] = true;
+            x = x->left;
+        }else if(key_compare_(key(x), k)){
+            went_left[depth++] = false;
+            x = x->right;
+        }else{
+            found = true;
+            break;
+        }
+    }
+    if(!found){
+        return;
+    }
+    // down to the node that is unlinked: z itself or its successor
+    z_depth = depth;
+    base_ptr y = path[depth];
+    if(y->left != nullptr && y->right != nullptr){
+        went_left[depth++] = false;
+        for(y = y->right; ; y = y->left){
+            path[depth] = y;
+            if(y->left == nullptr){
+                break;
+            }
+            went_left[depth++] = true;
+        }
+    }
+    // path[0 .. depth] now runs from the root to y; y has at most one child, x
+    const bool y_has_left = y->left != nullptr;
+
+    link_type p = nullptr;
+    for(size_type i = 0; i <= depth; ++i){
+        link_type c = p == nullptr ? (root_ = unshare(root_)) : (unshare_child(p, went_left[i - 1]), static_cast<link_type>(child(p, went_left[i - 1])));
+        rb_tree_set_parent(c, p);
+        path[i] = c;
+        p = c;
+    }
+    link_type z = static_cast<link_type>(path[z_depth]);
+    // the children that get a new parent: x, and the left child of z when y moves up
+    if(y_has_left || path[depth]->right != nullptr){
+        unshare_child(static_cast<link_type>(path[depth]), y_has_left);
+    }
+    if(z_depth != depth){
+        unshare_child(z, true);
+    }
+
+    // replay the colors of the fixup; it runs if the color that leaves the tree, that of
+    // y before it takes over the color of z, is black. x moves up into y's old place at
+    // level depth, above it the node at level i is path[i], or y with the color of z at
+    // z_depth, whose other child is still reached through z
+    if(rb_tree_is_black(path[depth])){
+        base_ptr x = y_has_left ? path[depth]->left : path[depth]->right;
+        size_type j = depth;
+        while(j > 0 && (x == nullptr || rb_tree_is_black(x))){
+            // the sibling of x in the relinked tree is the old sibling of path[j]
+            link_type xp = static_cast<link_type>(j - 1 == z_depth && z_depth != depth ? z : path[j - 1]);
+            const bool x_left = went_left[j - 1];
+            base_ptr bro = child(xp, !x_left);
+            if(rb_tree_is_red(bro)){
+                unshare_below(xp, !x_left, 3);
+                break;
+            }
+            if(!is_red(bro->left) && !is_red(bro->right)){
+                unshare_child(xp, !x_left);
+                x = j - 1 == z_depth ? z : path[j - 1];
+                --j;
+                continue;
+            }
+            unshare_below(xp, !x_left, 2);
+            break;
+        }
+    }
+
+    base_ptr top = root_;
+    base_ptr leftmost = nullptr;
+    base_ptr rightmost = nullptr;
+    rb_tree_erase_rebalance(z, top, leftmost, rightmost);
+    root_ = static_cast<link_type>(top);
+    --size_;
+    // z is out, the links it held now belong to the nodes that took its place
+    destroy_node(z);
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+typename persistent_rb_tree<T, Compare, KeyOfValue>::link_type persistent_rb_tree<T, Compare, KeyOfValue>::find_node(link_type x, const key_type& k, const key_compare& comp){
+    while(x != nullptr){
+        if(comp(k, key(x))){
+            x = static_cast<link_type>(x->left);
+        }else if(comp(key(x), k)){
+            x = static_cast<link_type>(x->right);
+        }else{
+            return x;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+typename persistent_rb_tree<T, Compare, KeyOfValue>::link_type persistent_rb_tree<T, Compare, KeyOfValue>::lower_bound_node(link_type x, const key_type& k, const key_compare& comp){
+    link_type y = nullptr;
+    while(x != nullptr){
+        if(!comp(key(x), k)){
+            y = x;
+            x = static_cast<link_type>(x->left);
+        }else{
+            x = static_cast<link_type>(x->right);
+        }
+    }
+    return y;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+typename persistent_rb_tree<T, Compare, KeyOfValue>::link_type persistent_rb_tree<T, Compare, KeyOfValue>::upper_bound_node(link_type x, const key_type& k, const key_compare& comp){
+    link_type y = nullptr;
+    while(x != nullptr){
+        if(comp(k, key(x))){
+            y = x;
+            x = static_cast<link_type>(x->left);
+        }else{
+            x = static_cast<link_type>(x->right);
+        }
+    }
+    return y;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+typename persistent_rb_tree<T, Compare, KeyOfValue>::link_type persistent_rb_tree<T, Compare, KeyOfValue>::before_node(link_type x, const key_type& k, const key_compare& comp){
+    link_type y = nullptr;
+    while(x != nullptr){
+        if(comp(key(x), k)){
+            y = x;
+            x = static_cast<link_type>(x->right);
+        }else{
+            x = static_cast<link_type>(x->left);
+        }
+    }
+    return y;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+template <typename F>
+void persistent_rb_tree<T, Compare, KeyOfValue>::for_each_node(link_type x, F& f){
+    while(x != nullptr){
+        for_each_node(static_cast<link_type>(x->left), f);
+        f(static_cast<const value_type&>(x->data));
+        x = static_cast<link_type>(x->right);
+    }
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+template <typename F>
+void persistent_rb_tree<T, Compare, KeyOfValue>::for_each_node(link_type x, const key_type& lo, const key_type& hi, const key_compare& comp, F& f){
+    while(x != nullptr){
+        if(comp(key(x), lo)){
+            x = static_cast<link_type>(x->right);
+        }else if(!comp(key(x), hi)){
+            x = static_cast<link_type>(x->left);
+        }else{
+            for_each_node(static_cast<link_type>(x->left), lo, hi, comp, f);
+            f(static_cast<const value_type&>(x->data));
+            x = static_cast<link_type>(x->right);
+        }
+    }
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+typename persistent_rb_tree<T, Compare, KeyOfValue>::link_type persistent_rb_tree<T, Compare, KeyOfValue>::retain(link_type x) noexcept{
+    if(x != nullptr){
+        x->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return x;
+}
+
+// recurse on the left child of a freed node and loop on the right one, so the depth is
+// bounded by the height
+template <typename T, typename Compare, typename KeyOfValue>
+void persistent_rb_tree<T, Compare, KeyOfValue>::release(link_type x) noexcept{
+    while(x != nullptr && x->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+        link_type l = static_cast<link_type>(x->left);
+        link_type r = static_cast<link_type>(x->right);
+        destroy_node(x);
+        release(l);
+        x = r;
+    }
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+template <typename... Args>
+typename persistent_rb_tree<T, Compare, KeyOfValue>::link_type persistent_rb_tree<T, Compare, KeyOfValue>::create_node(Args&&... args){
+    link_type p = node_allocator::allocate();
+    try{
+        ::new(static_cast<void*>(p)) node_type(std::forward<Args>(args)...);
+    }catch(...){
+        node_allocator::deallocate(p);
+        throw;
+    }
+    rb_tree_set_parent_color(p, nullptr, rb_tree_red);
+    p->left = p->right = nullptr;
+    return p;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+void persistent_rb_tree<T, Compare, KeyOfValue>::destroy_node(link_type x) noexcept{
+    x->~node_type();
+    node_allocator::deallocate(x);
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+typename persistent_rb_tree<T, Compare, KeyOfValue>::link_type persistent_rb_tree<T, Compare, KeyOfValue>::unshare(link_type x){
+    if(x->refs.load(std::memory_order_acquire) == 1){
+        return x;
+    }
+    link_type y = create_node(x->data);
+    rb_tree_set_color(y, rb_tree_color(x));
+    y->left = retain(static_cast<link_type>(x->left));
+    y->right = retain(static_cast<link_type>(x->right));
+    release(x);
+    return y;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+void persistent_rb_tree<T, Compare, KeyOfValue>::unshare_child(link_type p, bool left){
+    base_ptr& c = left ? p->left : p->right;
+    if(c != nullptr){
+        c = unshare(static_cast<link_type>(c));
+        rb_tree_set_parent(c, p);
+    }
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+void persistent_rb_tree<T, Compare, KeyOfValue>::unshare_below(link_type p, bool left, size_type depth){
+    unshare_child(p, left);
+    link_type c = static_cast<link_type>(child(p, left));
+    if(c != nullptr && depth > 0){
+        unshare_below(c, true, depth - 1);
+        unshare_below(c, false, depth - 1);
+    }
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+bool persistent_rb_tree<T, Compare, KeyOfValue>::is_balanced() const{
+    if(root_ == nullptr){
+        return size_ == 0;
+    }
+    if(!rb_tree_is_black(root_) || is_balanced(root_) < 0){
+        return false;
+    }
+    size_type n = 0;
+    const value_type* prev = nullptr;
+    bool ordered = true;
+    for_each([&](const value_type& v){
+        ordered = ordered && (prev == nullptr || key_compare_(KeyOfValue()(*prev), KeyOfValue()(v)));
+        prev = &v;
+        ++n;
+    });
+    return ordered && n == size_;
+}
+
+template <typename T, typename Compare, typename KeyOfValue>
+int persistent_rb_tree<T, Compare, KeyOfValue>::is_balanced(link_type x) const{
+    if(x == nullptr){
+        return 0;
+    }
+    if(x->refs.load(std::memory_order_relaxed) == 0){
+        return -1;
+    }
+    if(rb_tree_is_red(x) && (is_red(x->left) || is_red(x->right))){
+        return -1;
+    }
+    int lh = is_balanced(static_cast<link_type>(x->left));
+    int rh = is_balanced(static_cast<link_type>(x->right));
+    if(lh < 0 || lh != rh){
+        return -1;
+    }
+    return lh + (rb_tree_is_black(x) ? 1 : 0);
+}
+
+} // namespace hstl
+
+#endif
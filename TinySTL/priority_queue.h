@@ -0,0 +1,178 @@
+#ifndef TINYSTL_PRIORITY_QUEUE_H
+#define TINYSTL_PRIORITY_QUEUE_H
+
+#include <cstddef>
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include "heap.h"
+#include "vector.h"
+
+namespace hstl{
+
+// container adaptor keeping c as a heap under comp, the top is the largest element;
+// Container needs random access iterators, push_back, emplace_back, pop_back and swap
+template <typename T, typename Container = hstl::vector<T>, typename Compare = std::less<typename Container::value_type>>
+class priority_queue{
+public:
+    typedef Container                                   container_type;
+    typedef Compare                                     value_compare;
+    typedef typename Container::value_type              value_type;
+    typedef typename Container::size_type               size_type;
+    typedef typename Container::reference               reference;
+    typedef typename Container::const_reference         const_reference;
+
+private:
+    typedef typename std::iterator_traits<typename Container::iterator>::difference_type difference_type;
+
+    Container   c_;
+    Compare     comp_;
+
+public:
+    priority_queue() : c_(), comp_(){}
+    explicit priority_queue(const Compare& comp) : c_(), comp_(comp){}
+    template <typename InputIterator>
+    priority_queue(InputIterator first, InputIterator last, const Compare& comp = Compare());
+
+    const_reference top() const;
+    size_type size() const { return c_.size(); }
+    bool empty() const { return c_.empty(); }
+
+    void push(const value_type& value);
+    void push(value_type&& value);
+    template <typename... Args>
+    void emplace(Args&&... args);
+    // append [first, last) and restore the heap with one make_heap if the batch is at least
+    // as large as the heap, otherwise push the new elements one by one
+    template <typename InputIterator>
+    void push_range(InputIterator first, InputIterator last);
+
+    void pop();
+    // move up to n elements to out in priority order, return the end of the output
+    template <typename OutputIterator>
+    OutputIterator pop_n(OutputIterator out, size_type n);
+
+    // pop then push, with a single sift: return the old top and insert value
+    value_type replace_top(value_type value);
+    // push then pop, with at most one sift: return the largest of the top and value
+    value_type pushpop(value_type value);
+
+    void swap(priority_queue& rhs);
+
+private:
+    // move value into the root slot, whose element has been moved out, and sift it down
+    void sift_top(value_type&& value);
+};
+
+
+template <typename T, typename Container, typename Compare>
+template <typename InputIterator>
+priority_queue<T, Container, Compare>::priority_queue(InputIterator first, InputIterator last, const Compare& comp)
+    : c_(), comp_(comp){
+    for(; first != last; ++first){
+        c_.push_back(*first);
+    }
+    hstl::make_heap(c_.begin(), c_.end(), comp_);
+}
+
+template <typename T, typename Container, typename Compare>
+typename priority_queue<T, Container, Compare>::const_reference priority_queue<T, Container, Compare>::top() const{
+    assert(!empty());
+    return *c_.begin();
+}
+
+template <typename T, typename Container, typename Compare>
+void priority_queue<T, Container, Compare>::push(const value_type& value){
+    c_.push_back(value);
+    hstl::push_heap(c_.begin(), c_.end(), comp_);
+}
+
+template <typename T, typename Container, typename Compare>
+void priority_queue<T, Container, Compare>::push(value_type&& value){
+    c_.push_back(std::move(value));
+    hstl::push_heap(c_.begin(), c_.end(), comp_);
+}
+
+template <typename T, typename Container, typename Compare>
+template <typename... Args>
+void priority_queue<T, Container, Compare>::emplace(Args&&... args){
+    c_.emplace_back(std::forward<Args>(args)...);
+    hstl::push_heap(c_.begin(), c_.end(), comp_);
+}
+
+template <typename T, typename Container, typename Compare>
+template <typename InputIterator>
+void priority_queue<T, Container, Compare>::push_range(InputIterator first, InputIterator last){
+    const size_type old_size = c_.size();
+    try{
+        for(; first != last; ++first){
+            c_.push_back(*first);
+        }
+    }catch(...){
+        // keep the elements that made it in, the heap stays valid either way
+        hstl::make_heap(c_.begin(), c_.end(), comp_);
+        throw;
+    }
+    const size_type added = c_.size() - old_size;
+    if(added >= old_size){
+        // O(n) rebuild beats added * O(log n) pushes
+        hstl::make_heap(c_.begin(), c_.end(), comp_);
+    }else{
+        for(auto it = c_.begin() + (old_size + 1); it <= c_.end(); ++it){
+            hstl::push_heap(c_.begin(), it, comp_);
+        }
+    }
+}
+
+template <typename T, typename Container, typename Compare>
+void priority_queue<T, Container, Compare>::pop(){
+    assert(!empty());
+    hstl::pop_heap(c_.begin(), c_.end(), comp_);
+    c_.pop_back();
+}
+
+template <typename T, typename Container, typename Compare>
+template <typename OutputIterator>
+OutputIterator priority_queue<T, Container, Compare>::pop_n(OutputIterator out, size_type n){
+    for(; n > 0 && !c_.empty(); --n, ++out){
+        hstl::pop_heap(c_.begin(), c_.end(), comp_);
+        *out = std::move(*(c_.end() - 1));
+        c_.pop_back();
+    }
+    return out;
+}
+
+template <typename T, typename Container, typename Compare>
+typename priority_queue<T, Container, Compare>::value_type priority_queue<T, Container, Compare>::replace_top(value_type value){
+    assert(!empty());
+    value_type result = std::move(*c_.begin());
+    sift_top(std::move(value));
+    return result;
+}
+
+template <typename T, typename Container, typename Compare>
+typename priority_queue<T, Container, Compare>::value_type priority_queue<T, Container, Compare>::pushpop(value_type value){
+    if(c_.empty() || !comp_(value, *c_.begin())){
+        // value would come straight back out
+        return value;
+    }
+    value_type result = std::move(*c_.begin());
+    sift_top(std::move(value));
+    return result;
+}
+
+template <typename T, typename Container, typename Compare>
+void priority_queue<T, Container, Compare>::swap(priority_queue& rhs){
+    c_.swap(rhs.c_);
+    std::swap(comp_, rhs.comp_);
+}
+
+template <typename T, typename Container, typename Compare>
+void priority_queue<T, Container, Compare>::sift_top(value_type&& value){
+    hstl::__adjust_heap(c_.begin(), difference_type(0), difference_type(c_.size()), std::move(value), comp_);
+}
+
+} // namespace hstl
+
+#endif
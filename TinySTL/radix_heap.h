@@ -0,0 +1,180 @@
+#ifndef TINYSTL_RADIX_HEAP_H
+#define TINYSTL_RADIX_HEAP_H
+
+#include <cstddef>
+#include <cassert>
+#include <climits>
+#include <type_traits>
+#include <utility>
+#include "vector.h"
+
+namespace hstl{
+
+// monotone priority queue on unsigned integer keys (Ahuja, Mehlhorn, Orlin and Tarjan)
+//
+// last_ is the key most recently returned by top_key(), an entry with key k sits in bucket
+// bit_width(k ^ last_), so bucket 0 holds the entries equal to last_ and bucket i those
+// that first differ from it in bit i - 1. When bucket 0 runs empty the lowest non-empty
+// bucket is redistributed around its minimum; every entry only moves to lower buckets,
+// which makes push O(1) and pop amortized O(log C) for C the key range, with no
+// comparisons between entries at all.
+//
+// pushed keys must not be less than the last key returned by top_key(), as with
+// Dijkstra on non-negative weights or timers that never fire in the past
+template <typename Key, typename Value>
+class radix_heap{
+    static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value, "radix_heap keys must be unsigned integers");
+public:
+    typedef Key                                         key_type;
+    typedef Value                                       value_type;
+    typedef std::pair<Key, Value>                       entry_type;
+    typedef std::size_t                                 size_type;
+
+    static constexpr size_type key_bits = sizeof(Key) * CHAR_BIT;
+
+private:
+    typedef hstl::vector<entry_type>                    bucket_type;
+
+    // redistributed lazily by the const accessors, which does not change the contents
+    mutable bucket_type buckets_[key_bits + 1];
+    mutable key_type    last_;
+    size_type           size_;
+
+public:
+    radix_heap() : last_(0), size_(0){}
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    // the smallest key that may still be pushed
+    key_type min_key() const noexcept { return last_; }
+
+    void push(key_type key, const value_type& value);
+    void push(key_type key, value_type&& value);
+    template <typename... Args>
+    void emplace(key_type key, Args&&... args);
+
+    key_type top_key() const;
+    const value_type& top_value() const;
+    value_type& top_value();
+    void pop();
+
+    void clear() noexcept;
+
+private:
+    size_type bucket_of(key_type key) const noexcept;
+    void pull() const;
+    static size_type bit_width(key_type x) noexcept;
+};
+
+
+template <typename Key, typename Value>
+void radix_heap<Key, Value>::push(key_type key, const value_type& value){
+    emplace(key, value);
+}
+
+template <typename Key, typename Value>
+void radix_heap<Key, Value>::push(key_type key, value_type&& value){
+    emplace(key, std::move(value));
+}
+
+template <typename Key, typename Value>
+template <typename... Args>
+void radix_heap<Key, Value>::emplace(key_type key, Args&&... args){
+    assert(key >= last_);
+    buckets_[bucket_of(key)].push_back(entry_type(key, value_type(std::forward<Args>(args)...)));
+    ++size_;
+}
+
+template <typename Key, typename Value>
+typename radix_heap<Key, Value>::key_type radix_heap<Key, Value>::top_key() const{
+    assert(!empty());
+    pull();
+    return last_;
+}
+
+template <typename Key, typename Value>
+const typename radix_heap<Key, Value>::value_type& radix_heap<Key, Value>::top_value() const{
+    assert(!empty());
+    pull();
+    return (buckets_[0].end() - 1)->second;
+}
+
+template <typename Key, typename Value>
+typename radix_heap<Key, Value>::value_type& radix_heap<Key, Value>::top_value(){
+    assert(!empty());
+    pull();
+    return (buckets_[0].end() - 1)->second;
+}
+
+template <typename Key, typename Value>
+void radix_heap<Key, Value>::pop(){
+    assert(!empty());
+    pull();
+    buckets_[0].pop_back();
+    --size_;
+}
+
+template <typename Key, typename Value>
+void radix_heap<Key, Value>::clear() noexcept{
+    for(size_type i = 0; i <= key_bits; ++i){
+        buckets_[i].clear();
+    }
+    size_ = 0;
+}
+
+template <typename Key, typename Value>
+typename radix_heap<Key, Value>::size_type radix_heap<Key, Value>::bucket_of(key_type key) const noexcept{
+    return bit_width(static_cast<key_type>(key ^ last_));
+}
+
+// make bucket 0 non-empty: move last_ up to the minimum of the lowest non-empty bucket
+// and spread that bucket over the lower ones
+//
+// the target buckets are reserved before anything moves, so running out of memory leaves
+// the heap as it was; the moves themselves are assumed not to throw
+template <typename Key, typename Value>
+void radix_heap<Key, Value>::pull() const{
+    if(!buckets_[0].empty()){
+        return;
+    }
+    size_type i = 1;
+    while(buckets_[i].empty()){
+        ++i;
+    }
+    bucket_type& b = buckets_[i];
+    key_type m = b.begin()->first;
+    for(auto it = b.begin() + 1; it != b.end(); ++it){
+        m = it->first < m ? it->first : m;
+    }
+    size_type count[key_bits + 1] = {};
+    for(auto it = b.begin(); it != b.end(); ++it){
+        ++count[bit_width(static_cast<key_type>(it->first ^ m))];
+    }
+    for(size_type j = 0; j < i; ++j){
+        if(count[j] != 0){
+            buckets_[j].reserve(buckets_[j].size() + count[j]);
+        }
+    }
+    last_ = m;
+    for(auto it = b.begin(); it != b.end(); ++it){
+        buckets_[bucket_of(it->first)].push_back(std::move(*it));
+    }
+    b.clear();
+}
+
+template <typename Key, typename Value>
+typename radix_heap<Key, Value>::size_type radix_heap<Key, Value>::bit_width(key_type x) noexcept{
+#if defined(__GNUC__) || defined(__clang__)
+    return x == 0 ? 0 : sizeof(unsigned long long) * CHAR_BIT - static_cast<size_type>(__builtin_clzll(static_cast<unsigned long long>(x)));
+#else
+    size_type n = 0;
+    for(; x != 0; x >>= 1){
+        ++n;
+    }
+    return n;
+#endif
+}
+
+} // namespace hstl
+
+#endif
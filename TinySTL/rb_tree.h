@@ -4,8 +4,12 @@
 #include <iterator>
 #include <type_traits>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 #include "allocator.h"
 #include "construct.h"
+#include "functional.h"
 
 
 namespace hstl{
@@ -15,6 +19,14 @@ static constexpr rb_tree_color_type rb_tree_red = false;
 static constexpr rb_tree_color_type rb_tree_black = true;
 
 
+// the links of a node and the header; a tree picks one of two layouts with its NodeBase
+// parameter. rb_tree_node_base keeps the color in a field of its own,
+// rb_tree_compact_node_base keeps it in the low bit of the parent pointer, which is always
+// clear for aligned nodes: 24 bytes of links instead of 32 on LP64, so an 8-byte key ends
+// a node at 32 bytes rather than 40. The layout is part of the type of every node,
+// iterator and tree built on it, so trees of both kinds live side by side in one program.
+// The links are only touched through rb_tree_parent, rb_tree_color and their setters
+// below, which are overloaded for the two, and the algorithms are templates over the base
 struct rb_tree_node_base{
     typedef rb_tree_color_type color_type;
     typedef rb_tree_node_base* base_ptr;
@@ -46,16 +58,168 @@ struct rb_tree_node_base{
     }
 };
 
+struct rb_tree_compact_node_base{
+    typedef rb_tree_color_type color_type;
+    typedef rb_tree_compact_node_base* base_ptr;
+
+
+    std::uintptr_t parent_color;
+    base_ptr left;
+    base_ptr right;
+
+
+    base_ptr get_base_ptr(){
+        return &*this;
+    }
+
+
+    static base_ptr minimum(base_ptr x){
+        while (x->left != nullptr){
+            x = x->left;
+        }
+        return x;
+    }
+
+    static base_ptr maximum(base_ptr x){
+        while (x->right != nullptr){
+            x = x->right;
+        }
+        return x;
+    }
+};
+
+static_assert(alignof(rb_tree_compact_node_base) >= 2, "the color bit needs aligned nodes");
 
-template <typename T>
-struct rb_tree_node : public rb_tree_node_base{
-    typedef rb_tree_node<T>* link_type;
+inline rb_tree_node_base* rb_tree_parent(const rb_tree_node_base* x){
+    return x->parent;
+}
+inline rb_tree_color_type rb_tree_color(const rb_tree_node_base* x){
+    return x->color;
+}
+inline void rb_tree_set_parent(rb_tree_node_base* x, rb_tree_node_base* p){
+    x->parent = p;
+}
+inline void rb_tree_set_color(rb_tree_node_base* x, rb_tree_color_type c){
+    x->color = c;
+}
+// for a node whose links are not initialized yet
+inline void rb_tree_set_parent_color(rb_tree_node_base* x, rb_tree_node_base* p, rb_tree_color_type c){
+    x->parent = p;
+    x->color = c;
+}
+
+inline rb_tree_compact_node_base* rb_tree_parent(const rb_tree_compact_node_base* x){
+    return reinterpret_cast<rb_tree_compact_node_base*>(x->parent_color & ~std::uintptr_t(1));
+}
+inline rb_tree_color_type rb_tree_color(const rb_tree_compact_node_base* x){
+    return (x->parent_color & 1) != 0;
+}
+inline void rb_tree_set_parent(rb_tree_compact_node_base* x, rb_tree_compact_node_base* p){
+    x->parent_color = reinterpret_cast<std::uintptr_t>(p) | (x->parent_color & 1);
+}
+inline void rb_tree_set_color(rb_tree_compact_node_base* x, rb_tree_color_type c){
+    x->parent_color = (x->parent_color & ~std::uintptr_t(1)) | std::uintptr_t(c);
+}
+inline void rb_tree_set_parent_color(rb_tree_compact_node_base* x, rb_tree_compact_node_base* p, rb_tree_color_type c){
+    x->parent_color = reinterpret_cast<std::uintptr_t>(p) | std::uintptr_t(c);
+}
+
+
+template <typename T, typename NodeBase = rb_tree_node_base>
+struct rb_tree_node : public NodeBase{
+    typedef rb_tree_node<T, NodeBase>* link_type;
     T data;
 };
 
 
+// augmentation: a policy with a summary_type and a
+//     template <typename Node> static summary_type summarize(const Node* x);
+// that computes the summary of x from x->data and the summaries of its children (Node* after
+// a cast, nullptr for nil). The summary is stored in every node and kept up to date through
+// insertion, erasure and rotation.
+struct rb_tree_no_augment{};
+
+template <typename T, typename Augment, typename NodeBase = rb_tree_node_base>
+struct rb_tree_augmented_node : public rb_tree_node<T, NodeBase>{
+    typename Augment::summary_type summary;
+};
+
+// plain nodes unless the tree is augmented
+template <typename T, typename Augment, typename NodeBase = rb_tree_node_base>
+struct rb_tree_node_of{
+    typedef rb_tree_augmented_node<T, Augment, NodeBase> type;
+};
+template <typename T, typename NodeBase>
+struct rb_tree_node_of<T, rb_tree_no_augment, NodeBase>{
+    typedef rb_tree_node<T, NodeBase> type;
+};
+
+// the hook the rebalancing functions call on every node whose subtree changed, children
+// before parents
+struct rb_tree_no_update{
+    template <typename NodeBase>
+    void operator()(NodeBase*) const{}
+};
+
+template <typename T, typename Augment, typename NodeBase = rb_tree_node_base>
+struct rb_tree_augment_update{
+    void operator()(NodeBase* x) const{
+        typedef rb_tree_augmented_node<T, Augment, NodeBase> node_type;
+        node_type* p = static_cast<node_type*>(x);
+        p->summary = Augment::summarize(static_cast<const node_type*>(p));
+    }
+};
+
+template <typename T, typename Augment, typename NodeBase = rb_tree_node_base>
+struct rb_tree_update_of{
+    typedef rb_tree_augment_update<T, Augment, NodeBase> type;
+};
+template <typename T, typename NodeBase>
+struct rb_tree_update_of<T, rb_tree_no_augment, NodeBase>{
+    typedef rb_tree_no_update type;
+};
+
+// subtree sizes, for select, rank and distance in O(log n)
+struct rb_tree_order_statistic{
+    typedef std::size_t summary_type;
+
+    template <typename Node>
+    static summary_type count(typename Node::base_ptr x){
+        return x == nullptr ? 0 : static_cast<const Node*>(x)->summary;
+    }
+
+    template <typename Node>
+    static summary_type summarize(const Node* x){
+        return 1 + count<Node>(x->left) + count<Node>(x->right);
+    }
+};
+
+// the summary of a subtree as a fold of its elements in order under a monoid:
+//     typedef ... summary_type;
+//     static summary_type identity();
+//     static summary_type lift(const T& element);
+//     static summary_type combine(const summary_type& left, const summary_type& right);
+// combine must be associative, it need not commute; rb_tree::fold uses it for ranges of keys
+template <typename Monoid>
+struct rb_tree_monoid_augment{
+    typedef Monoid                          monoid_type;
+    typedef typename Monoid::summary_type   summary_type;
+
+    template <typename Node>
+    static summary_type summary(typename Node::base_ptr x){
+        return x == nullptr ? Monoid::identity() : static_cast<const Node*>(x)->summary;
+    }
+
+    template <typename Node>
+    static summary_type summarize(const Node* x){
+        return Monoid::combine(Monoid::combine(summary<Node>(x->left), Monoid::lift(x->data)), summary<Node>(x->right));
+    }
+};
+
+
+template <typename NodeBase>
 struct rb_tree_iterator_base{
-    typedef rb_tree_node_base::base_ptr                             base_ptr;
+    typedef typename NodeBase::base_ptr                             base_ptr;
     typedef std::bidirectional_iterator_tag                         iterator_category;
     typedef ptrdiff_t                                               difference_type;
     
@@ -69,10 +233,10 @@ struct rb_tree_iterator_base{
             }
         }
         else{
-            base_ptr y = node->parent;
+            base_ptr y = rb_tree_parent(node);
             while (node == y->right){
                 node = y;
-                y = y->parent;
+                y = rb_tree_parent(y);
             }
             if(node->right != y){
                 node = y;
@@ -81,7 +245,7 @@ struct rb_tree_iterator_base{
     }
 
     void decrement(){
-        if(node->color == rb_tree_red && node->parent->parent == node){
+        if(rb_tree_color(node) == rb_tree_red && rb_tree_parent(rb_tree_parent(node)) == node){
             node = node->right;
         }else if(node->left != nullptr){
             base_ptr y = node->left;
@@ -90,25 +254,30 @@ struct rb_tree_iterator_base{
             }
             node = y;
         }else{
-            base_ptr y = node->parent;
+            base_ptr y = rb_tree_parent(node);
             while (node == y->left){
                 node = y;
-                y = y->parent;
+                y = rb_tree_parent(y);
             }
             node = y;
         }
     }
 };
 
-template <typename Value, typename Ref, typename Ptr>
-struct rb_tree_iterator : public rb_tree_iterator_base{
+template <typename Value, typename Ref, typename Ptr, typename NodeBase = rb_tree_node_base>
+struct rb_tree_iterator : public rb_tree_iterator_base<NodeBase>{
     typedef Value                                                   value_type;
     typedef Ref                                                     reference;
     typedef Ptr                                                     pointer;
-    typedef rb_tree_iterator<Value, Value&, Value*>                 iterator;
-    typedef rb_tree_iterator<Value, const Value&, const Value*>     const_iterator;
-    typedef rb_tree_iterator<Value, Ref, Ptr>                       self;
-    typedef rb_tree_node<Value>*                                    link_type;
+    typedef rb_tree_iterator<Value, Value&, Value*, NodeBase>       iterator;
+    typedef rb_tree_iterator<Value, const Value&, const Value*, NodeBase> const_iterator;
+    typedef rb_tree_iterator<Value, Ref, Ptr, NodeBase>             self;
+    typedef rb_tree_node<Value, NodeBase>*                          link_type;
+    typedef rb_tree_iterator_base<NodeBase>                         base;
+
+    using base::node;
+    using base::increment;
+    using base::decrement;
 
 
     rb_tree_iterator(){
@@ -120,6 +289,8 @@ struct rb_tree_iterator : public rb_tree_iterator_base{
     rb_tree_iterator(const iterator& it){
         node = it.node;
     }
+    // the constructor above is the copy constructor of iterator
+    rb_tree_iterator& operator=(const rb_tree_iterator&) = default;
 
     reference operator*() const{
         return link_type(node)->data;
@@ -152,34 +323,54 @@ struct rb_tree_iterator : public rb_tree_iterator_base{
     }
 };
 
-inline void rb_tree_set_red(rb_tree_node_base* x){
-    x->color = rb_tree_red;
+// iterator and const_iterator compare with each other through the base
+template <typename NodeBase>
+inline bool operator==(const rb_tree_iterator_base<NodeBase>& x, const rb_tree_iterator_base<NodeBase>& y){
+    return x.node == y.node;
+}
+template <typename NodeBase>
+inline bool operator!=(const rb_tree_iterator_base<NodeBase>& x, const rb_tree_iterator_base<NodeBase>& y){
+    return x.node != y.node;
+}
+
+// x may be a node base or any node derived from one
+template <typename Node>
+inline void rb_tree_set_red(Node* x){
+    rb_tree_set_color(x, rb_tree_red);
 }
-inline void rb_tree_set_black(rb_tree_node_base* x){
-    x->color = rb_tree_black;
+template <typename Node>
+inline void rb_tree_set_black(Node* x){
+    rb_tree_set_color(x, rb_tree_black);
 }
 
-inline bool rb_tree_is_red(const rb_tree_node_base* x){
-    return x->color == rb_tree_red;
+template <typename Node>
+inline bool rb_tree_is_red(const Node* x){
+    return rb_tree_color(x) == rb_tree_red;
 }
-inline bool rb_tree_is_black(const rb_tree_node_base* x){
-    return x->color == rb_tree_black;
+template <typename Node>
+inline bool rb_tree_is_black(const Node* x){
+    return rb_tree_color(x) == rb_tree_black;
 }
-inline bool rb_tree_is_left_child(const rb_tree_node_base* x){
-    return x->parent->left == x;
+template <typename Node>
+inline bool rb_tree_is_left_child(const Node* x){
+    return rb_tree_parent(x)->left == x;
 }
-inline bool rb_tree_is_right_child(const rb_tree_node_base* x){
-    return x->parent->right == x;
+template <typename Node>
+inline bool rb_tree_is_right_child(const Node* x){
+    return rb_tree_parent(x)->right == x;
 }
 
-inline rb_tree_node_base* rb_tree_get_next(rb_tree_node_base* x){
+// the rebalancing functions below take the node base from the root they are given, the
+// nodes may be passed as any type derived from it
+template <typename NodeBase>
+inline NodeBase* rb_tree_get_next(NodeBase* x){
     if(x->right != nullptr){
-        return rb_tree_node_base::minimum(x->right);
+        return NodeBase::minimum(x->right);
     }
-    rb_tree_node_base* y = x->parent;
+    NodeBase* y = rb_tree_parent(x);
     while(x == y->right){
         x = y;
-        y = y->parent;
+        y = rb_tree_parent(y);
     }
     if(x->right != y){
         return y;
@@ -188,41 +379,57 @@ inline rb_tree_node_base* rb_tree_get_next(rb_tree_node_base* x){
     }
 }
 
-inline void rb_tree_rotate_left(rb_tree_node_base* x, rb_tree_node_base*& root){
-    rb_tree_node_base *y = x->right;
+// update every node from x up to the root, after the subtree under x has changed shape
+template <typename Node, typename Update>
+inline void rb_tree_update_path(Node* from, typename Node::base_ptr header, Update update){
+    for(typename Node::base_ptr x = from; x != header; x = rb_tree_parent(x)){
+        update(x);
+    }
+}
+template <typename Node>
+inline void rb_tree_update_path(Node*, typename Node::base_ptr, rb_tree_no_update){
+}
+
+template <typename NodeBase, typename Update = rb_tree_no_update>
+inline void rb_tree_rotate_left(typename NodeBase::base_ptr x, NodeBase*& root, Update update = Update()){
+    NodeBase *y = x->right;
     x->right = y->left;
     if(y->left != nullptr){
-        y->left->parent = x;
+        rb_tree_set_parent(y->left, x);
     }
-    y->parent = x->parent;
+    rb_tree_set_parent(y, rb_tree_parent(x));
     if(x == root){
         root = y;
     }else if (rb_tree_is_left_child(x)){
-        x->parent->left = y;
+        rb_tree_parent(x)->left = y;
     }else{
-        x->parent->right = y;
+        rb_tree_parent(x)->right = y;
     }
     y->left = x;
-    x->parent = y;
-    
+    rb_tree_set_parent(x, y);
+    update(x);
+    update(y);
 }
 
-inline void rb_tree_rotate_right(rb_tree_node_base* x, rb_tree_node_base*& root){
-    rb_tree_node_base *y = x->left;
+template <typename NodeBase, typename Update = rb_tree_no_update>
+inline void rb_tree_rotate_right(typename NodeBase::base_ptr x, NodeBase*& root, Update update = Update()){
+    NodeBase *y = x->left;
     x->left = y->right;
     if(y->right != nullptr){
-        y->right->parent = x;
+        rb_tree_set_parent(y->right, x);
     }
-    y->parent = x->parent;
+    rb_tree_set_parent(y, rb_tree_parent(x));
     if(x == root){
         root = y;
     }else if (rb_tree_is_left_child(x)){
-        x->parent->left = y;
+        rb_tree_parent(x)->left = y;
     }else{
-        x->parent->right = y;
+        rb_tree_parent(x)->right = y;
     }
     y->right = x;
-    x->parent = y;
+    rb_tree_set_parent(x, y);
+    update(x);
+    update(y);
 }
 
 // 插入节点后使 rb tree 重新平衡，参数一为新增节点，参数二为根节点
@@ -236,101 +443,116 @@ inline void rb_tree_rotate_right(rb_tree_node_base* x, rb_tree_node_base*& root)
 // case 5: 父节点为红，叔叔节点为 NIL 或黑色，父节点为左（右）孩子，当前节点为左（右）孩子，
 //         让父节点变为黑色，祖父节点变为红色，以祖父节点为支点右（左）旋
 
-inline void rb_tree_insert_rebalance(rb_tree_node_base* x, rb_tree_node_base*& root){
+//
+// x is already linked in; with an update hook the path above it is refreshed first, the
+// rotations then keep the summaries right. Returns whether the black height of the tree
+// grew, which happens when case 3 reaches the root (or x is the first node)
+template <typename NodeBase, typename Update = rb_tree_no_update>
+inline bool rb_tree_insert_rebalance(typename NodeBase::base_ptr x, NodeBase*& root, Update update = Update()){
+    rb_tree_update_path(x, rb_tree_parent(root), update);
     rb_tree_set_red(x);
-    while(x != root && rb_tree_is_red(x->parent)){
-        if(rb_tree_is_left_child(x->parent)){
-            rb_tree_node_base* uncle = x->parent->parent->right;
+    while(x != root && rb_tree_is_red(rb_tree_parent(x))){
+        if(rb_tree_is_left_child(rb_tree_parent(x))){
+            NodeBase* uncle = rb_tree_parent(rb_tree_parent(x))->right;
             if(uncle != nullptr && rb_tree_is_red(uncle)){ // case 3
-                rb_tree_set_black(x->parent);
+                rb_tree_set_black(rb_tree_parent(x));
                 rb_tree_set_black(uncle);
-                rb_tree_set_red(x->parent->parent);
-                x = x->parent->parent;
+                rb_tree_set_red(rb_tree_parent(rb_tree_parent(x)));
+                x = rb_tree_parent(rb_tree_parent(x));
             }else{
                 if(rb_tree_is_right_child(x)){  // case 4
-                    x = x->parent;
-                    rb_tree_rotate_left(x, root);
+                    x = rb_tree_parent(x);
+                    rb_tree_rotate_left(x, root, update);
                 }
                 // case 5
-                rb_tree_set_black(x->parent); 
-                rb_tree_set_red(x->parent->parent);
-                rb_tree_rotate_right(x->parent->parent, root);
+                rb_tree_set_black(rb_tree_parent(x)); 
+                rb_tree_set_red(rb_tree_parent(rb_tree_parent(x)));
+                rb_tree_rotate_right(rb_tree_parent(rb_tree_parent(x)), root, update);
                 break;
             }
         }else{
-            rb_tree_node_base* uncle = x->parent->parent->left;
+            NodeBase* uncle = rb_tree_parent(rb_tree_parent(x))->left;
             if(uncle != nullptr && rb_tree_is_red(uncle)){ // case 3
-                rb_tree_set_black(x->parent);
+                rb_tree_set_black(rb_tree_parent(x));
                 rb_tree_set_black(uncle);
-                rb_tree_set_red(x->parent->parent);
-                x = x->parent->parent;
+                rb_tree_set_red(rb_tree_parent(rb_tree_parent(x)));
+                x = rb_tree_parent(rb_tree_parent(x));
             }else{
                 if(rb_tree_is_left_child(x)){  // case 4
-                    x = x->parent;
-                    rb_tree_rotate_right(x, root);
+                    x = rb_tree_parent(x);
+                    rb_tree_rotate_right(x, root, update);
                 }
                 // case 5
-                rb_tree_set_black(x->parent); 
-                rb_tree_set_red(x->parent->parent);
-                rb_tree_rotate_left(x->parent->parent, root);
+                rb_tree_set_black(rb_tree_parent(x)); 
+                rb_tree_set_red(rb_tree_parent(rb_tree_parent(x)));
+                rb_tree_rotate_left(rb_tree_parent(rb_tree_parent(x)), root, update);
                 break;
             }
         }
     }
+    const bool grew = rb_tree_is_red(root);
     rb_tree_set_black(root); // keep root black
+    return grew;
 }
 
 // TODO
-inline void rb_tree_erase_rebalance(rb_tree_node_base* z, rb_tree_node_base*& root, rb_tree_node_base*& leftmost, rb_tree_node_base*& rightmost){
-    rb_tree_node_base* y = (z->left == nullptr || z->right == nullptr) ? z : rb_tree_get_next(z); // y is the node to be deleted
-    rb_tree_node_base* x = nullptr;  // x is the child of y or nullptr
-    rb_tree_node_base* xp = nullptr; // xp is the parent of x
+template <typename NodeBase, typename Update = rb_tree_no_update>
+inline void rb_tree_erase_rebalance(typename NodeBase::base_ptr z, NodeBase*& root, NodeBase*& leftmost, NodeBase*& rightmost, Update update = Update()){
+    NodeBase* header = rb_tree_parent(root);
+    NodeBase* y = (z->left == nullptr || z->right == nullptr) ? z : rb_tree_get_next(z); // y is the node to be deleted
+    NodeBase* x = nullptr;  // x is the child of y or nullptr
+    NodeBase* xp = nullptr; // xp is the parent of x
     if(z != y){ // z have two children
         x = y->right; // y must have no left child, x may be nullptr
-        z->left->parent = y;
+        rb_tree_set_parent(z->left, y);
         y->left = z->left;
         if(y != z->right){
-            xp = y->parent;
+            xp = rb_tree_parent(y);
             if(x != nullptr){
-                x->parent = y->parent;
+                rb_tree_set_parent(x, rb_tree_parent(y));
             }
-            y->parent->left = x;
+            rb_tree_parent(y)->left = x;
             y->right = z->right;
-            z->right->parent = y;
+            rb_tree_set_parent(z->right, y);
         }else{
             xp = y;
         }
         if(z == root){
             root = y;
         }else if(rb_tree_is_left_child(z)){
-            z->parent->left = y;
+            rb_tree_parent(z)->left = y;
         }else{
-            z->parent->right = y;
+            rb_tree_parent(z)->right = y;
         }
-        y->parent = z->parent;
-        std::swap(y->color, z->color);
+        rb_tree_set_parent(y, rb_tree_parent(z));
+        const rb_tree_color_type c = rb_tree_color(y);
+        rb_tree_set_color(y, rb_tree_color(z));
+        rb_tree_set_color(z, c);
         y = z;
     }else{
         x = y->left != nullptr ? y->left : y->right;
         if(x != nullptr){
-            x->parent = y->parent;
+            rb_tree_set_parent(x, rb_tree_parent(y));
         }
         if(z == root){
             root = x;
         }else if(rb_tree_is_left_child(z)){
-            z->parent->left = x;
+            rb_tree_parent(z)->left = x;
         }else{
-            z->parent->right = x;
+            rb_tree_parent(z)->right = x;
         }
-        xp = y->parent;
+        xp = rb_tree_parent(y);
         if(z == leftmost){
-            leftmost = (x == nullptr) ? xp : rb_tree_node_base::minimum(x);
+            leftmost = (x == nullptr) ? xp : NodeBase::minimum(x);
         }
         if(z == rightmost){
-            rightmost = (x == nullptr) ? xp : rb_tree_node_base::maximum(x);
+            rightmost = (x == nullptr) ? xp : NodeBase::maximum(x);
         }
     }
 
+    // z is out; every subtree that lost a node hangs on the path from xp up
+    rb_tree_update_path(xp, header, update);
+
     // 此时，y 指向要删除的节点，x 为替代节点，从 x 节点开始调整。
     // 如果删除的节点为红色，树的性质没有被破坏，否则按照以下情况调整（x 为左子节点为例）：
     // case 1: 兄弟节点为红色，令父节点为红，兄弟节点为黑，进行左（右）旋，继续处理
@@ -342,59 +564,59 @@ inline void rb_tree_erase_rebalance(rb_tree_node_base* z, rb_tree_node_base*& ro
     if(rb_tree_is_black(y)){
         while(x != root &&(x == nullptr || rb_tree_is_black(x))){
             if(x == xp->left){
-                rb_tree_node_base* bro = xp->right;
+                NodeBase* bro = xp->right;
                 if(rb_tree_is_red(bro)){ // case 1
                     rb_tree_set_black(bro);
                     rb_tree_set_red(xp);
-                    rb_tree_rotate_left(xp, root);
+                    rb_tree_rotate_left(xp, root, update);
                     bro = xp->right;
                 }
                 if((bro->left == nullptr || rb_tree_is_black(bro->left)) && (bro->right == nullptr || rb_tree_is_black(bro->right))){ // case 2
                     rb_tree_set_red(bro);
                     x = xp;
-                    xp = xp->parent;
+                    xp = rb_tree_parent(xp);
                 }else{
                     if(bro->right == nullptr || rb_tree_is_black(bro->right)){ // case 3
                         rb_tree_set_black(bro->left);
                         rb_tree_set_red(bro);
-                        rb_tree_rotate_right(bro, root);
+                        rb_tree_rotate_right(bro, root, update);
                         bro = xp->right;
                     }
                     // case 4
-                    bro->color = xp->color;
+                    rb_tree_set_color(bro, rb_tree_color(xp));
                     rb_tree_set_black(xp);
                     if(bro->right != nullptr){
                         rb_tree_set_black(bro->right);
                     }
-                    rb_tree_rotate_left(xp, root);
+                    rb_tree_rotate_left(xp, root, update);
                     break;
                 }
             }else{
-                rb_tree_node_base* bro = xp->left;
+                NodeBase* bro = xp->left;
                 if(rb_tree_is_red(bro)){ // case 1
                     rb_tree_set_black(bro);
                     rb_tree_set_red(xp);
-                    rb_tree_rotate_right(xp, root);
+                    rb_tree_rotate_right(xp, root, update);
                     bro = xp->left;
                 }
                 if((bro->left == nullptr || rb_tree_is_black(bro->left)) && (bro->right == nullptr || rb_tree_is_black(bro->right))){ // case 2
                     rb_tree_set_red(bro);
                     x = xp;
-                    xp = xp->parent;
+                    xp = rb_tree_parent(xp);
                 }else{
                     if(bro->left == nullptr || rb_tree_is_black(bro->left)){ // case 3
                         rb_tree_set_black(bro->right);
                         rb_tree_set_red(bro);
-                        rb_tree_rotate_left(bro, root);
+                        rb_tree_rotate_left(bro, root, update);
                         bro = xp->left;
                     }
                     // case 4
-                    bro->color = xp->color;
+                    rb_tree_set_color(bro, rb_tree_color(xp));
                     rb_tree_set_black(xp);
                     if(bro->left != nullptr){
                         rb_tree_set_black(bro->left);
                     }
-                    rb_tree_rotate_right(xp, root);
+                    rb_tree_rotate_right(xp, root, update);
                     break;
                 }
             }
@@ -407,14 +629,23 @@ inline void rb_tree_erase_rebalance(rb_tree_node_base* z, rb_tree_node_base*& ro
 }
 
 
-template <typename T, typename Compare>
+// selects the rb_tree constructor that takes an already sorted range
+struct sorted_range_tag{};
+
+// KeyOfValue extracts the key an element is ordered by, the element itself by default;
+// Augment is the summary kept in every node, see rb_tree_no_augment; NodeBase is the link
+// layout, rb_tree_node_base or rb_tree_compact_node_base
+template <typename T, typename Compare, typename KeyOfValue = hstl::identity<T>, typename Augment = rb_tree_no_augment, typename NodeBase = rb_tree_node_base>
 class rb_tree{
 public:
+    typedef typename rb_tree_node_of<T, Augment, NodeBase>::type node_type;
+    typedef typename rb_tree_update_of<T, Augment, NodeBase>::type update_type;
     typedef hstl::allocator<T>                          allocator_type;
     typedef hstl::allocator<T>                          data_allocator;
-    typedef hstl::allocator<rb_tree_node<T>>            node_allocator;
-    typedef typename rb_tree_node<T>::link_type         link_type;
-    typedef rb_tree_node_base::base_ptr                 base_ptr;
+    typedef hstl::allocator<node_type>                  node_allocator;
+    typedef node_type*                                  link_type;
+    typedef typename NodeBase::base_ptr                 base_ptr;
+    typedef typename KeyOfValue::result_type            key_type;
     typedef Compare                                     key_compare;
 
     typedef typename allocator_type::value_type         value_type;
@@ -423,8 +654,10 @@ public:
     typedef typename allocator_type::reference          reference;
     typedef typename allocator_type::const_reference    const_reference;
     typedef typename allocator_type::size_type          size_type;
+    typedef typename allocator_type::difference_type    difference_type;
 
-    typedef rb_tree_iterator<T, T&, T*>                 iterator;
+    typedef rb_tree_iterator<T, T&, T*, NodeBase>       iterator;
+    typedef rb_tree_iterator<T, const T&, const T*, NodeBase> const_iterator;
 
 private:
     link_type header_;
@@ -440,111 +673,1357 @@ public:
 
 
 private:
-    link_type& root() const{ return (link_type&) header_->parent; }
+    link_type root() const{ return static_cast<link_type>(rb_tree_parent(header_)); }
+    void set_root(base_ptr x){ rb_tree_set_parent(header_, x); }
     link_type& leftmost() const{ return (link_type&) header_->left; }
     link_type& rightmost() const{ return (link_type&) header_->right; }
 
+    static const key_type& key(base_ptr x){ return KeyOfValue()(static_cast<link_type>(x)->data); }
+
 public:
     rb_tree();
+    explicit rb_tree(const key_compare& comp);
+    // build from a range already sorted under comp, see assign_sorted
+    template <typename ForwardIterator>
+    rb_tree(sorted_range_tag, ForwardIterator first, ForwardIterator last, const key_compare& comp = key_compare());
+    // copies the shape and colors of rhs node for node, O(n) with no comparisons
+    rb_tree(const rb_tree& rhs);
+    // rhs is left empty; both trees own a header, so this allocates one for rhs
+    rb_tree(rb_tree&& rhs);
+    ~rb_tree();
+
+    rb_tree& operator=(const rb_tree& rhs);
+    rb_tree& operator=(rb_tree&& rhs) noexcept;
+
+    void clear() noexcept;
+    void swap(rb_tree& rhs) noexcept;
+
     iterator insert_equal(const value_type& value); // insert value into rb_tree (allowing duplicate values)
+    iterator insert_equal(value_type&& value);
+    template <typename... Args>
+    iterator emplace_equal(Args&&... args);
+    // insert_equal as close as possible before pos; amortized O(1) when value belongs right
+    // there, e.g. pos == end() while loading sorted data, otherwise a normal insert_equal
+    iterator insert_hint(iterator pos, const value_type& value);
+    iterator insert_hint(iterator pos, value_type&& value);
+    // replace the contents with [first, last), which must be sorted under key_comp(); the
+    // tree is built balanced in O(n) with no comparisons and no rebalancing
+    template <typename ForwardIterator>
+    void assign_sorted(ForwardIterator first, ForwardIterator last);
+
+    // insert unless an element with an equivalent key is present; the bool is whether it was
+    // inserted, the iterator points at the element with that key either way
+    std::pair<iterator, bool> insert_unique(const value_type& value);
+    std::pair<iterator, bool> insert_unique(value_type&& value);
+    // the node is built first, its key is not known before that
+    template <typename... Args>
+    std::pair<iterator, bool> emplace_unique(Args&&... args);
+    // look k up first and build value_type(args...) only if it is absent, so a present key
+    // costs one descent and no construction; args must build an element whose key is k
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& k, Args&&... args);
+
     iterator erase(iterator position); // erase node at position
+    size_type erase(const key_type& k); // erase every element with key k, return how many
+
+    // split keeps the elements whose key is less than k and returns the others as a new
+    // tree; join appends rhs, none of whose keys may be less than a key here, and leaves it
+    // empty. Both relink nodes in O(log n), but split also has to count the part it hands
+    // out: O(1) with Augment = rb_tree_order_statistic, linear in that part otherwise. If
+    // Compare throws, split leaves the tree as it was
+    rb_tree split(const key_type& k);
+    void join(rb_tree& rhs);
+
+    // set operations on trees of unique keys, rhs is consumed and left empty: its nodes
+    // are moved here or freed, and where both trees hold a key the element of *this stays.
+    // rhs is split at the root of *this and the two halves recurse, then join back
+    // (Blelloch, Ferizovic and Sun), O(m log(n / m + 1)) for sizes m <= n where inserting
+    // one tree into the other is O(m log n). The overloads taking a pool run the halves of
+    // large subtrees concurrently through pool.parallel_for, e.g. on a hstl::thread_pool;
+    // Compare and the destructor of T must then be safe to call from several threads.
+    // If Compare throws, the elements not freed yet are left in *this and rhs, both valid
+    // trees with their sizes recounted, and the exception propagates
+    void union_with(rb_tree& rhs);
+    void intersect_with(rb_tree& rhs);
+    void difference_with(rb_tree& rhs);
+    template <typename Pool>
+    void union_with(rb_tree& rhs, Pool& pool);
+    template <typename Pool>
+    void intersect_with(rb_tree& rhs, Pool& pool);
+    template <typename Pool>
+    void difference_with(rb_tree& rhs, Pool& pool);
+
+    // lookup, O(log n); the template overloads take any key comparable under a transparent
+    // Compare (std::less<> and the like), e.g. a string_view against string keys
+    iterator find(const key_type& k){ return find_node(k); }
+    const_iterator find(const key_type& k) const{ return find_node(k); }
+    iterator lower_bound(const key_type& k){ return lower_bound_node(k); }
+    const_iterator lower_bound(const key_type& k) const{ return lower_bound_node(k); }
+    iterator upper_bound(const key_type& k){ return upper_bound_node(k); }
+    const_iterator upper_bound(const key_type& k) const{ return upper_bound_node(k); }
+    std::pair<iterator, iterator> equal_range(const key_type& k){ return equal_range_node<iterator>(k); }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& k) const{ return equal_range_node<const_iterator>(k); }
+    size_type count(const key_type& k) const{ return count_node(k); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& k){ return find_node(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const K& k) const{ return find_node(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& k){ return lower_bound_node(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K& k) const{ return lower_bound_node(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& k){ return upper_bound_node(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K& k) const{ return upper_bound_node(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& k){ return equal_range_node<iterator>(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& k) const{ return equal_range_node<const_iterator>(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K& k) const{ return count_node(k); }
+
+    // order statistics, O(log n), for Augment = rb_tree_order_statistic only: the element
+    // at index k in sorted order (end() if k >= size()), the index of it (size() for end()),
+    // and the signed distance from first to last
+    iterator select(size_type k) const;
+    size_type rank(const_iterator it) const;
+    difference_type distance(const_iterator first, const_iterator last) const;
+
+    // the monoid fold of the elements with lo <= key < hi, in order, O(log n); for
+    // Augment = rb_tree_monoid_augment only
+    template <typename A = Augment>
+    typename A::summary_type fold(const key_type& lo, const key_type& hi) const;
+
+    // the root node, nullptr if empty, for structures that search the summaries themselves
+    link_type root_node() const{ return root(); }
+
+    // check the red-black invariants, the links, the order and the summaries, for tests
+    bool is_balanced() const;
 private:
     link_type get_node();
-    link_type create_node(const value_type& value);
+    template <typename... Args>
+    link_type create_node(Args&&... args);
     void destroy_node(link_type p);
-    iterator insert_node(base_ptr y_, const value_type& value);
+    iterator insert_node(base_ptr y_, link_type z);
+    iterator insert_node(base_ptr y_, link_type z, bool insert_left);
+    iterator insert_equal_node(link_type z);
+    iterator insert_hint_node(base_ptr pos, link_type z);
+    template <typename ForwardIterator>
+    link_type build_sorted(ForwardIterator& first, size_type n, size_type depth, size_type red_depth);
+    void destroy_subtree(link_type x) noexcept;
+    // clone the subtree at x under parent p
+    link_type copy_subtree(link_type x, link_type p);
+    // black height of the subtree at x, -1 if it is broken
+    int is_balanced(link_type x) const;
 
+    static size_type subtree_size(base_ptr x){ return Augment::template count<node_type>(x); }
+    // the summary lives beside data and is built and destroyed with the node
+    static void construct_summary(rb_tree_node<T, NodeBase>*){}
+    template <typename A>
+    static void construct_summary(rb_tree_augmented_node<T, A, NodeBase>* x){ ::new(static_cast<void*>(&(x->summary))) typename A::summary_type(); }
+    static void destroy_summary(rb_tree_node<T, NodeBase>*){}
+    template <typename A>
+    static void destroy_summary(rb_tree_augmented_node<T, A, NodeBase>* x){ hstl::destroy(&(x->summary)); }
+    static void copy_summary(rb_tree_node<T, NodeBase>*, const rb_tree_node<T, NodeBase>*){}
+    template <typename A>
+    static void copy_summary(rb_tree_augmented_node<T, A, NodeBase>* to, const rb_tree_augmented_node<T, A, NodeBase>* from){ to->summary = from->summary; }
+    static bool summary_ok(const rb_tree_node<T, NodeBase>*){ return true; }
+    template <typename A>
+    static bool summary_ok(const rb_tree_augmented_node<T, A, NodeBase>* x){ return A::summarize(x) == x->summary; }
+
+    // a detached subtree (root->parent == nullptr) and its black height, what split and
+    // join pass around; the root may be red
+    struct piece{
+        link_type root;
+        size_type black_height;
+    };
+    // the keys less than k, the node with key k or nullptr, the keys greater than k
+    struct split_result{
+        piece left;
+        link_type match;
+        piece right;
+    };
+    // the pool of the sequential set operations, never asked to run anything
+    struct no_pool{
+        template <typename Index, typename F>
+        void parallel_for(Index first, Index last, Index, F f){
+            for(; first != last; ++first){
+                f(first);
+            }
+        }
+    };
+    // the halves of a set operation on subtrees of a lower black height (some thousands
+    // of nodes in a tree built by random inserts) run on the calling thread
+    static constexpr size_type parallel_black_height = 8;
+
+    // move every node out into a piece, the tree is left empty apart from size_
+    piece take_nodes();
+    // hang p under the header as the whole tree of n elements
+    void adopt_nodes(piece p, size_type n);
+    // the same for a piece of unknown size, which is counted
+    void adopt_counted(piece p);
+    static piece join_node(piece l, link_type k, piece r);
+    static piece join_node(piece l, piece r);
+    static void split_children(link_type x, size_type black_height, piece& l, piece& r);
+    // the splits consume t; if Compare throws they put t back together, a valid tree again
+    std::pair<piece, piece> split_node(piece& t, const key_type& k) const;
+    split_result split3_node(piece& t, const key_type& k) const;
+    static std::pair<piece, link_type> split_last_node(piece t);
+    // the set operations leave their result in a and b empty; if Compare throws, a and b
+    // are left as two valid trees of every node not freed yet
+    template <typename Pool>
+    void union_node(piece& a, piece& b, size_type& matched, Pool* pool);
+    template <typename Pool>
+    void intersect_node(piece& a, piece& b, size_type& matched, Pool* pool);
+    template <typename Pool>
+    void difference_node(piece& a, piece& b, size_type& matched, Pool* pool);
+    void adopt_after_throw(rb_tree& rhs, piece a, piece b);
+    template <typename Pool, typename F, typename G>
+    static void fork(Pool* pool, bool parallel, F f, G g);
+    size_type count_nodes(std::true_type) const{ return subtree_size(root()); }
+    size_type count_nodes(std::false_type) const;
+
+    // (node with key k, nullptr) if there is one, else (nullptr, parent to insert k under)
+    template <typename K>
+    std::pair<base_ptr, base_ptr> get_insert_unique_pos(const K& k) const;
+
+    template <typename K>
+    link_type lower_bound_node(const K& k) const;
+    template <typename K>
+    link_type upper_bound_node(const K& k) const;
+    template <typename K>
+    link_type find_node(const K& k) const;
+    template <typename Iterator, typename K>
+    std::pair<Iterator, Iterator> equal_range_node(const K& k) const;
+    template <typename K>
+    size_type count_node(const K& k) const;
 };
 
-template <typename T, typename Compare>
-rb_tree<T, Compare>::rb_tree(){
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::rb_tree() : rb_tree(key_compare()){
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::rb_tree(const key_compare& comp) : key_compare_(comp){
     header_ = get_node();
-    header_->color = rb_tree_red;
-    header_->parent = nullptr;
+    rb_tree_set_parent_color(header_, nullptr, rb_tree_red);
     header_->left = header_;
     header_->right = header_;
     size_ = 0;
 }
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator rb_tree<T, Compare>::insert_equal(const value_type& value){
-    link_type y = header_;
-    link_type x = root();
-    while (x != nullptr){
-        y = x;
-        x = key_compare_(value, x->data) ? link_type(x->left) : link_type(x->right);
+// the delegated constructor has finished, so the destructor cleans up if assign_sorted throws
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename ForwardIterator>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::rb_tree(sorted_range_tag, ForwardIterator first, ForwardIterator last, const key_compare& comp) : rb_tree(comp){
+    assign_sorted(first, last);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::rb_tree(const rb_tree& rhs) : rb_tree(rhs.key_compare_){
+    if(rhs.root() != nullptr){
+        set_root(copy_subtree(rhs.root(), header_));
+        leftmost() = static_cast<link_type>(NodeBase::minimum(root()));
+        rightmost() = static_cast<link_type>(NodeBase::maximum(root()));
+        size_ = rhs.size_;
+    }
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::rb_tree(rb_tree&& rhs) : rb_tree(rhs.key_compare_){
+    swap(rhs);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::~rb_tree(){
+    clear();
+    node_allocator::deallocate(header_);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>& rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::operator=(const rb_tree& rhs){
+    if(this != &rhs){
+        rb_tree tmp(rhs);
+        swap(tmp);
     }
-    return insert_node(y, value);
+    return *this;
+}
 
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>& rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::operator=(rb_tree&& rhs) noexcept{
+    if(this != &rhs){
+        clear();
+        swap(rhs);
+    }
+    return *this;
 }
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator rb_tree<T, Compare>::erase(iterator position){
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::clear() noexcept{
+    destroy_subtree(root());
+    set_root(nullptr);
+    leftmost() = header_;
+    rightmost() = header_;
+    size_ = 0;
+}
+
+// the header pointers are exchanged, every node keeps its links
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::swap(rb_tree& rhs) noexcept{
+    std::swap(header_, rhs.header_);
+    std::swap(size_, rhs.size_);
+    std::swap(key_compare_, rhs.key_compare_);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_equal(const value_type& value){
+    return insert_equal_node(create_node(value));
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_equal(value_type&& value){
+    return insert_equal_node(create_node(std::move(value)));
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename... Args>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::emplace_equal(Args&&... args){
+    return insert_equal_node(create_node(std::forward<Args>(args)...));
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_hint(iterator pos, const value_type& value){
+    return insert_hint_node(pos.node, create_node(value));
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_hint(iterator pos, value_type&& value){
+    return insert_hint_node(pos.node, create_node(std::move(value)));
+}
+
+// a balanced tree of n nodes split at the middle has every nil path of length
+// floor(log2(n + 1)) or one more; making the nodes of that extra level red and all the others
+// black gives every path the same black height with no red node under a red one
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename ForwardIterator>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::assign_sorted(ForwardIterator first, ForwardIterator last){
+    clear();
+    const size_type n = static_cast<size_type>(std::distance(first, last));
+    if(n == 0){
+        return;
+    }
+    size_type red_depth = 0;
+    while((size_type(1) << (red_depth + 1)) <= n + 1){
+        ++red_depth;
+    }
+    link_type x = build_sorted(first, n, 0, red_depth);
+    rb_tree_set_parent(x, header_);
+    set_root(x);
+    leftmost() = static_cast<link_type>(NodeBase::minimum(x));
+    rightmost() = static_cast<link_type>(NodeBase::maximum(x));
+    size_ = n;
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+std::pair<typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator, bool> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_unique(const value_type& value){
+    std::pair<base_ptr, base_ptr> pos = get_insert_unique_pos(KeyOfValue()(value));
+    if(pos.second == nullptr){
+        return std::pair<iterator, bool>(iterator(link_type(pos.first)), false);
+    }
+    return std::pair<iterator, bool>(insert_node(pos.second, create_node(value)), true);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+std::pair<typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator, bool> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_unique(value_type&& value){
+    std::pair<base_ptr, base_ptr> pos = get_insert_unique_pos(KeyOfValue()(value));
+    if(pos.second == nullptr){
+        return std::pair<iterator, bool>(iterator(link_type(pos.first)), false);
+    }
+    return std::pair<iterator, bool>(insert_node(pos.second, create_node(std::move(value))), true);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename... Args>
+std::pair<typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator, bool> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::emplace_unique(Args&&... args){
+    link_type z = create_node(std::forward<Args>(args)...);
+    std::pair<base_ptr, base_ptr> pos = get_insert_unique_pos(key(z));
+    if(pos.second == nullptr){
+        destroy_node(z);
+        return std::pair<iterator, bool>(iterator(link_type(pos.first)), false);
+    }
+    return std::pair<iterator, bool>(insert_node(pos.second, z), true);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename K, typename... Args>
+std::pair<typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator, bool> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::try_emplace(const K& k, Args&&... args){
+    std::pair<base_ptr, base_ptr> pos = get_insert_unique_pos(k);
+    if(pos.second == nullptr){
+        return std::pair<iterator, bool>(iterator(link_type(pos.first)), false);
+    }
+    link_type z = create_node(std::forward<Args>(args)...);
+    return std::pair<iterator, bool>(insert_node(pos.second, z), true);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::erase(iterator position){
     link_type y = static_cast<link_type>(position.node);
     iterator next(y);
     ++next;
-    rb_tree_erase_rebalance(base_ptr(y), header_->parent, header_->left, header_->right);
+    base_ptr top = root();
+    rb_tree_erase_rebalance(base_ptr(y), top, header_->left, header_->right, update_type());
+    set_root(top);
     destroy_node(y);
     --size_;
     return next;
 
 }
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::link_type rb_tree<T, Compare>::get_node(){
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::size_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::erase(const key_type& k){
+    std::pair<iterator, iterator> range = equal_range(k);
+    size_type n = 0;
+    while(range.first != range.second){
+        range.first = erase(range.first);
+        ++n;
+    }
+    return n;
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+rb_tree<T, Compare, KeyOfValue, Augment, NodeBase> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::split(const key_type& k){
+    rb_tree right(key_compare_);
+    if(root() == nullptr){
+        return right;
+    }
+    const size_type n = size_;
+    piece t = take_nodes();
+    std::pair<piece, piece> parts;
+    try{
+        parts = split_node(t, k);
+    }catch(...){
+        adopt_nodes(t, n);
+        throw;
+    }
+    right.adopt_counted(parts.second);
+    adopt_nodes(parts.first, n - right.size_);
+    return right;
+}
+
+// the leftmost node of rhs is taken out with the erase fixup and becomes the middle key
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::join(rb_tree& rhs){
+    if(rhs.root() == nullptr){
+        return;
+    }
+    if(root() == nullptr){
+        swap(rhs);
+        return;
+    }
+    assert(!key_compare_(key(rhs.leftmost()), key(rightmost())));
+    const size_type n = size_ + rhs.size_;
+    link_type k = rhs.leftmost();
+    base_ptr top = rhs.root();
+    rb_tree_erase_rebalance(base_ptr(k), top, rhs.header_->left, rhs.header_->right, update_type());
+    rhs.set_root(top);
+    rb_tree_set_parent(k, nullptr);
+    k->left = k->right = nullptr;
+    piece l = take_nodes();
+    piece r = rhs.take_nodes();
+    rhs.size_ = 0;
+    adopt_nodes(join_node(l, k, r), n);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::union_with(rb_tree& rhs){
+    no_pool sequential;
+    union_with(rhs, sequential);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::intersect_with(rb_tree& rhs){
+    no_pool sequential;
+    intersect_with(rhs, sequential);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::difference_with(rb_tree& rhs){
+    no_pool sequential;
+    difference_with(rhs, sequential);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename Pool>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::union_with(rb_tree& rhs, Pool& pool){
+    if(this == &rhs){
+        return;
+    }
+    const size_type n = size_ + rhs.size_;
+    size_type matched = 0;
+    piece a = take_nodes();
+    piece b = rhs.take_nodes();
+    try{
+        union_node(a, b, matched, &pool);
+    }catch(...){
+        adopt_after_throw(rhs, a, b);
+        throw;
+    }
+    rhs.size_ = 0;
+    adopt_nodes(a, n - matched);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename Pool>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::intersect_with(rb_tree& rhs, Pool& pool){
+    if(this == &rhs){
+        return;
+    }
+    size_type matched = 0;
+    piece a = take_nodes();
+    piece b = rhs.take_nodes();
+    try{
+        intersect_node(a, b, matched, &pool);
+    }catch(...){
+        adopt_after_throw(rhs, a, b);
+        throw;
+    }
+    rhs.size_ = 0;
+    adopt_nodes(a, matched);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename Pool>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::difference_with(rb_tree& rhs, Pool& pool){
+    if(this == &rhs){
+        clear();
+        return;
+    }
+    const size_type n = size_;
+    size_type matched = 0;
+    piece a = take_nodes();
+    piece b = rhs.take_nodes();
+    try{
+        difference_node(a, b, matched, &pool);
+    }catch(...){
+        adopt_after_throw(rhs, a, b);
+        throw;
+    }
+    rhs.size_ = 0;
+    adopt_nodes(a, n - matched);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::link_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::get_node(){
     return node_allocator::allocate();
 }
 
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::link_type rb_tree<T, Compare>::create_node(const value_type& value){
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename... Args>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::link_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::create_node(Args&&... args){
     link_type p = get_node();
     try{
-        hstl::construct(&(p->data), value);
-        p->parent = p->left = p->right = nullptr;
+        // placement new rather than hstl::construct, whose (ptr, const Ty2&) overload would
+        // build a Ty2 instead of converting to T
+        ::new(static_cast<void*>(&(p->data))) T(std::forward<Args>(args)...);
+        rb_tree_set_parent_color(p, nullptr, rb_tree_red);
+        p->left = p->right = nullptr;
+    }catch(...){
+        node_allocator::deallocate(p);
+        throw;
+    }
+    try{
+        construct_summary(p);
     }catch(...){
+        hstl::destroy(&(p->data));
         node_allocator::deallocate(p);
         throw;
     }
     return p;
 }
 
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::destroy_node(link_type p){
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::destroy_node(link_type p){
     hstl::destroy(&(p->data));
+    destroy_summary(p);
     node_allocator::deallocate(p);
 }
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::iterator rb_tree<T, Compare>::insert_node(base_ptr y_, const value_type& value){
+// link the detached node z as a child of y_, on the side its key belongs
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_node(base_ptr y_, link_type z){
+    return insert_node(y_, z, y_ == header_ || key_compare_(key(z), key(y_)));
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_node(base_ptr y_, link_type z, bool insert_left){
     link_type y = static_cast<link_type>(y_);
-    link_type z;
-    if(y == header_ || key_compare_(value, y->data)){
-        z = create_node(value);
+    if(insert_left){
         y->left = z;
         if(y == header_){
-            root() = z;
+            set_root(z);
             rightmost() = z;
         } else if(y == leftmost()){
             leftmost() = z;
         }
     }
     else{
-        z = create_node(value);
         y->right = z;
         if(y == rightmost()){
             rightmost() = z;
         }
     }
-    z->parent = y;
+    rb_tree_set_parent(z, y);
     z->left = z->right = nullptr;
-    rb_tree_insert_rebalance(z, header_->parent);
+    base_ptr top = root();
+    rb_tree_insert_rebalance(z, top, update_type());
+    set_root(top);
     ++size_;
     return iterator(z);
 }
 
+// equal keys go right, after the ones already there
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_equal_node(link_type z){
+    link_type y = header_;
+    link_type x = root();
+    while (x != nullptr){
+        y = x;
+        x = key_compare_(key(z), key(x)) ? link_type(x->left) : link_type(x->right);
+    }
+    return insert_node(y, z);
+}
+
+// z fits right before pos if it is not greater than *pos and not less than its predecessor;
+// it then goes under the predecessor if that has no right child, else under pos, whose left
+// subtree is empty in that case
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::insert_hint_node(base_ptr pos, link_type z){
+    if(pos == header_){
+        if(size_ > 0 && !key_compare_(key(z), key(rightmost()))){
+            return insert_node(rightmost(), z, false);
+        }
+        return insert_equal_node(z);
+    }
+    if(!key_compare_(key(pos), key(z))){
+        if(pos == leftmost()){
+            return insert_node(pos, z, true);
+        }
+        iterator before(static_cast<link_type>(pos));
+        --before;
+        if(!key_compare_(key(z), key(before.node))){
+            if(before.node->right == nullptr){
+                return insert_node(before.node, z, false);
+            }
+            return insert_node(pos, z, true);
+        }
+    }
+    return insert_equal_node(z);
+}
 
+// build n nodes from first on, in order, as a balanced subtree rooted at the given depth;
+// a failure frees what this call has built so far
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename ForwardIterator>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::link_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::build_sorted(ForwardIterator& first, size_type n, size_type depth, size_type red_depth){
+    if(n == 0){
+        return nullptr;
+    }
+    const size_type left_size = (n - 1) / 2;
+    link_type left = build_sorted(first, left_size, depth + 1, red_depth);
+    link_type x;
+    try{
+        x = create_node(*first);
+    }catch(...){
+        destroy_subtree(left);
+        throw;
+    }
+    ++first;
+    rb_tree_set_color(x, depth == red_depth ? rb_tree_red : rb_tree_black);
+    x->left = left;
+    if(left != nullptr){
+        rb_tree_set_parent(left, x);
+    }
+    try{
+        x->right = build_sorted(first, n - 1 - left_size, depth + 1, red_depth);
+    }catch(...){
+        destroy_subtree(x);
+        throw;
+    }
+    if(x->right != nullptr){
+        rb_tree_set_parent(x->right, x);
+    }
+    update_type()(x);
+    return x;
+}
+
+// free a detached subtree in post-order by following the parent links, no recursion and no
+// stack, so any height is fine; each node is unlinked from its parent before it is freed
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::destroy_subtree(link_type x) noexcept{
+    if(x == nullptr){
+        return;
+    }
+    link_type top = x;
+    for(;;){
+        if(x->left != nullptr){
+            x = link_type(x->left);
+        }else if(x->right != nullptr){
+            x = link_type(x->right);
+        }else{
+            if(x == top){
+                destroy_node(x);
+                return;
+            }
+            link_type p = link_type(rb_tree_parent(x));
+            if(p->left == x){
+                p->left = nullptr;
+            }else{
+                p->right = nullptr;
+            }
+            destroy_node(x);
+            x = p;
+        }
+    }
+}
+
+// walk down the left spine in a loop and recurse on right children only (as SGI does), the
+// recursion depth is bounded by the height of the source; on a throw the partial copy is
+// still a well linked tree and is freed whole
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::link_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::copy_subtree(link_type x, link_type p){
+    link_type top = create_node(x->data);
+    rb_tree_set_color(top, rb_tree_color(x));
+    copy_summary(top, x);
+    rb_tree_set_parent(top, p);
+    try{
+        if(x->right != nullptr){
+            top->right = copy_subtree(link_type(x->right), top);
+        }
+        p = top;
+        x = link_type(x->left);
+        while(x != nullptr){
+            link_type y = create_node(x->data);
+            rb_tree_set_color(y, rb_tree_color(x));
+            copy_summary(y, x);
+            p->left = y;
+            rb_tree_set_parent(y, p);
+            if(x->right != nullptr){
+                y->right = copy_subtree(link_type(x->right), y);
+            }
+            p = y;
+            x = link_type(x->left);
+        }
+    }catch(...){
+        destroy_subtree(top);
+        throw;
+    }
+    return top;
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::piece rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::take_nodes(){
+    link_type x = root();
+    size_type black_height = 0;
+    for(base_ptr y = x; y != nullptr; y = y->left){
+        black_height += rb_tree_is_black(y) ? 1 : 0;
+    }
+    if(x != nullptr){
+        rb_tree_set_parent(x, nullptr);
+    }
+    set_root(nullptr);
+    leftmost() = header_;
+    rightmost() = header_;
+    return piece{x, black_height};
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::adopt_nodes(piece p, size_type n){
+    size_ = n;
+    if(p.root == nullptr){
+        return;
+    }
+    rb_tree_set_black(p.root);
+    rb_tree_set_parent(p.root, header_);
+    set_root(p.root);
+    leftmost() = static_cast<link_type>(NodeBase::minimum(p.root));
+    rightmost() = static_cast<link_type>(NodeBase::maximum(p.root));
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::adopt_counted(piece p){
+    adopt_nodes(p, 0);
+    size_ = count_nodes(std::is_same<Augment, rb_tree_order_statistic>());
+}
+
+// the tree of l, then k, then r, for k detached and every key of l <= key(k) <= every key
+// of r; O(|black_height(l) - black_height(r)| + 1).
+//
+// with equal black heights k becomes a black root over both. Otherwise k goes down the
+// right spine of the taller l (left spine of a taller r) to the first black node c whose
+// black height is that of r, takes its place as a red node over c and r, and the insert
+// fixup repairs a red parent on the way back up, refreshing the summaries as it goes
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::piece rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::join_node(piece l, link_type k, piece r){
+    if(l.root != nullptr && rb_tree_is_red(l.root)){
+        rb_tree_set_black(l.root);
+        ++l.black_height;
+    }
+    if(r.root != nullptr && rb_tree_is_red(r.root)){
+        rb_tree_set_black(r.root);
+        ++r.black_height;
+    }
+    if(l.black_height == r.black_height){
+        rb_tree_set_parent(k, nullptr);
+        k->left = l.root;
+        k->right = r.root;
+        if(l.root != nullptr){
+            rb_tree_set_parent(l.root, k);
+        }
+        if(r.root != nullptr){
+            rb_tree_set_parent(r.root, k);
+        }
+        rb_tree_set_black(k);
+        rb_tree_update_path(k, nullptr, update_type());
+        return piece{k, l.black_height + 1};
+    }
+    const bool left_taller = l.black_height > r.black_height;
+    piece& tall = left_taller ? l : r;
+    const piece& low = left_taller ? r : l;
+    base_ptr c = tall.root;
+    base_ptr p = nullptr;
+    size_type h = tall.black_height;
+    while(h != low.black_height || (c != nullptr && rb_tree_is_red(c))){
+        h -= rb_tree_is_black(c) ? 1 : 0;
+        p = c;
+        c = left_taller ? c->right : c->left;
+    }
+    rb_tree_set_parent(k, p);
+    if(left_taller){
+        p->right = k;
+        k->left = c;
+        k->right = low.root;
+    }else{
+        p->left = k;
+        k->left = low.root;
+        k->right = c;
+    }
+    if(c != nullptr){
+        rb_tree_set_parent(c, k);
+    }
+    if(low.root != nullptr){
+        rb_tree_set_parent(low.root, k);
+    }
+    base_ptr root = tall.root;
+    const bool grew = rb_tree_insert_rebalance(k, root, update_type());
+    return piece{static_cast<link_type>(root), tall.black_height + (grew ? 1 : 0)};
+}
+
+// join without a middle key: the largest node of l is cut out to serve as one
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::piece rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::join_node(piece l, piece r){
+    if(l.root == nullptr){
+        return r;
+    }
+    if(r.root == nullptr){
+        return l;
+    }
+    std::pair<piece, link_type> last = split_last_node(l);
+    return join_node(last.first, last.second, r);
+}
+
+// detach both children of x, whose subtree has the given black height
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::split_children(link_type x, size_type black_height, piece& l, piece& r){
+    const size_type child_height = black_height - (rb_tree_is_black(x) ? 1 : 0);
+    l = piece{link_type(x->left), child_height};
+    r = piece{link_type(x->right), child_height};
+    if(l.root != nullptr){
+        rb_tree_set_parent(l.root, nullptr);
+    }
+    if(r.root != nullptr){
+        rb_tree_set_parent(r.root, nullptr);
+    }
+    rb_tree_set_parent(x, nullptr);
+    x->left = x->right = nullptr;
+}
+
+// (keys less than k, keys not less than k), one join per level of t
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+std::pair<typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::piece, typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::piece> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::split_node(piece& t, const key_type& k) const{
+    if(t.root == nullptr){
+        return std::pair<piece, piece>(t, t);
+    }
+    link_type x = t.root;
+    piece l, r;
+    split_children(x, t.black_height, l, r);
+    try{
+        if(key_compare_(key(x), k)){
+            std::pair<piece, piece> parts = split_node(r, k);
+            return std::pair<piece, piece>(join_node(l, x, parts.first), parts.second);
+        }
+        std::pair<piece, piece> parts = split_node(l, k);
+        return std::pair<piece, piece>(parts.first, join_node(parts.second, x, r));
+    }catch(...){
+        // the recursion has rebuilt l or r already, joins do not compare
+        t = join_node(l, x, r);
+        throw;
+    }
+}
+
+// for trees of unique keys, at most one node matches k
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::split_result rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::split3_node(piece& t, const key_type& k) const{
+    if(t.root == nullptr){
+        return split_result{t, nullptr, t};
+    }
+    link_type x = t.root;
+    piece l, r;
+    split_children(x, t.black_height, l, r);
+    try{
+        if(key_compare_(key(x), k)){
+            split_result parts = split3_node(r, k);
+            parts.left = join_node(l, x, parts.left);
+            return parts;
+        }
+        if(key_compare_(k, key(x))){
+            split_result parts = split3_node(l, k);
+            parts.right = join_node(parts.right, x, r);
+            return parts;
+        }
+    }catch(...){
+        t = join_node(l, x, r);
+        throw;
+    }
+    return split_result{l, x, r};
+}
+
+// (t without its largest node, that node detached)
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+std::pair<typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::piece, typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::link_type> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::split_last_node(piece t){
+    link_type x = t.root;
+    piece l, r;
+    split_children(x, t.black_height, l, r);
+    if(r.root == nullptr){
+        return std::pair<piece, link_type>(l, x);
+    }
+    std::pair<piece, link_type> last = split_last_node(r);
+    last.first = join_node(l, x, last.first);
+    return last;
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename Pool, typename F, typename G>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::fork(Pool* pool, bool parallel, F f, G g){
+    if(parallel){
+        pool->parallel_for(0, 2, 1, [&f, &g](int i){
+            if(i == 0){
+                f();
+            }else{
+                g();
+            }
+        });
+    }else{
+        f();
+        g();
+    }
+}
+
+// the halves work on disjoint nodes and count their matches apart, so they need no locks.
+// A half leaves its result, or after a throw what it still holds, in its own pieces; the
+// left ones have keys below k, the right ones above, so a throw anywhere is undone by
+// joining the a side around k and the b side around the match, neither compares
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename Pool>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::union_node(piece& a, piece& b, size_type& matched, Pool* pool){
+    if(a.root == nullptr){
+        a = b;
+        b = piece{nullptr, 0};
+        return;
+    }
+    if(b.root == nullptr){
+        return;
+    }
+    const bool parallel = !std::is_same<Pool, no_pool>::value
+        && a.black_height >= parallel_black_height && b.black_height >= parallel_black_height;
+    link_type k = a.root;
+    piece al, ar;
+    split_children(k, a.black_height, al, ar);
+    split_result parts;
+    try{
+        parts = split3_node(b, key(k));
+    }catch(...){
+        a = join_node(al, k, ar);
+        throw;
+    }
+    if(parts.match != nullptr){
+        destroy_node(parts.match);
+        ++matched;
+    }
+    size_type matched_left = 0, matched_right = 0;
+    try{
+        fork(pool, parallel,
+            [&]{ union_node(al, parts.left, matched_left, pool); },
+            [&]{ union_node(ar, parts.right, matched_right, pool); });
+    }catch(...){
+        a = join_node(al, k, ar);
+        b = join_node(parts.left, parts.right);
+        throw;
+    }
+    matched += matched_left + matched_right;
+    a = join_node(al, k, ar);
+    b = piece{nullptr, 0};
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename Pool>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::intersect_node(piece& a, piece& b, size_type& matched, Pool* pool){
+    if(a.root == nullptr || b.root == nullptr){
+        destroy_subtree(a.root);
+        destroy_subtree(b.root);
+        a = b = piece{nullptr, 0};
+        return;
+    }
+    const bool parallel = !std::is_same<Pool, no_pool>::value
+        && a.black_height >= parallel_black_height && b.black_height >= parallel_black_height;
+    link_type k = a.root;
+    piece al, ar;
+    split_children(k, a.black_height, al, ar);
+    split_result parts;
+    try{
+        parts = split3_node(b, key(k));
+    }catch(...){
+        a = join_node(al, k, ar);
+        throw;
+    }
+    size_type matched_left = 0, matched_right = 0;
+    try{
+        fork(pool, parallel,
+            [&]{ intersect_node(al, parts.left, matched_left, pool); },
+            [&]{ intersect_node(ar, parts.right, matched_right, pool); });
+    }catch(...){
+        a = join_node(al, k, ar);
+        b = parts.match != nullptr ? join_node(parts.left, parts.match, parts.right) : join_node(parts.left, parts.right);
+        throw;
+    }
+    matched += matched_left + matched_right;
+    b = piece{nullptr, 0};
+    if(parts.match != nullptr){
+        destroy_node(parts.match);
+        ++matched;
+        a = join_node(al, k, ar);
+        return;
+    }
+    destroy_node(k);
+    a = join_node(al, ar);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename Pool>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::difference_node(piece& a, piece& b, size_type& matched, Pool* pool){
+    if(a.root == nullptr || b.root == nullptr){
+        destroy_subtree(b.root);
+        b = piece{nullptr, 0};
+        return;
+    }
+    const bool parallel = !std::is_same<Pool, no_pool>::value
+        && a.black_height >= parallel_black_height && b.black_height >= parallel_black_height;
+    link_type k = a.root;
+    piece al, ar;
+    split_children(k, a.black_height, al, ar);
+    split_result parts;
+    try{
+        parts = split3_node(b, key(k));
+    }catch(...){
+        a = join_node(al, k, ar);
+        throw;
+    }
+    size_type matched_left = 0, matched_right = 0;
+    try{
+        fork(pool, parallel,
+            [&]{ difference_node(al, parts.left, matched_left, pool); },
+            [&]{ difference_node(ar, parts.right, matched_right, pool); });
+    }catch(...){
+        a = join_node(al, k, ar);
+        b = parts.match != nullptr ? join_node(parts.left, parts.match, parts.right) : join_node(parts.left, parts.right);
+        throw;
+    }
+    matched += matched_left + matched_right;
+    b = piece{nullptr, 0};
+    if(parts.match != nullptr){
+        destroy_node(parts.match);
+        destroy_node(k);
+        ++matched;
+        a = join_node(al, ar);
+        return;
+    }
+    a = join_node(al, k, ar);
+}
+
+// what a set operation held when Compare threw goes back to the two trees, counted anew
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+void rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::adopt_after_throw(rb_tree& rhs, piece a, piece b){
+    adopt_counted(a);
+    rhs.adopt_counted(b);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::size_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::count_nodes(std::false_type) const{
+    size_type n = 0;
+    for(const_iterator it = begin(); it != end(); ++it){
+        ++n;
+    }
+    return n;
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename K>
+std::pair<typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::base_ptr, typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::base_ptr> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::get_insert_unique_pos(const K& k) const{
+    link_type y = header_;
+    link_type x = root();
+    bool less = true;
+    while(x != nullptr){
+        y = x;
+        less = key_compare_(k, key(x));
+        x = less ? link_type(x->left) : link_type(x->right);
+    }
+    // k goes under y; an equal key, if any, is y or the predecessor of y
+    base_ptr j = y;
+    if(less){
+        if(y == leftmost()){
+            return std::pair<base_ptr, base_ptr>(nullptr, y);
+        }
+        iterator it(y);
+        --it;
+        j = it.node;
+    }
+    if(key_compare_(key(j), k)){
+        return std::pair<base_ptr, base_ptr>(nullptr, y);
+    }
+    return std::pair<base_ptr, base_ptr>(j, nullptr);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::iterator rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::select(size_type k) const{
+    if(k >= size_){
+        return end();
+    }
+    base_ptr x = root();
+    for(;;){
+        const size_type left = subtree_size(x->left);
+        if(k < left){
+            x = x->left;
+        }else if(k == left){
+            return iterator(static_cast<link_type>(x));
+        }else{
+            k -= left + 1;
+            x = x->right;
+        }
+    }
+}
+
+// the left subtree of it, plus every ancestor it is right of together with its left subtree
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::size_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::rank(const_iterator it) const{
+    base_ptr x = it.node;
+    if(x == header_){
+        return size_;
+    }
+    size_type r = subtree_size(x->left);
+    for(; x != root(); x = rb_tree_parent(x)){
+        if(x == rb_tree_parent(x)->right){
+            r += subtree_size(rb_tree_parent(x)->left) + 1;
+        }
+    }
+    return r;
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::difference_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::distance(const_iterator first, const_iterator last) const{
+    return static_cast<difference_type>(rank(last)) - static_cast<difference_type>(rank(first));
+}
+
+// descend to the first node inside [lo, hi); below it the range splits into a suffix of its
+// left subtree and a prefix of its right one, each folded along a single path with whole
+// subtrees taken from their summaries
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename A>
+typename A::summary_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::fold(const key_type& lo, const key_type& hi) const{
+    typedef typename A::summary_type summary_type;
+    typedef typename A::monoid_type monoid;
+    base_ptr x = root();
+    while(x != nullptr){
+        if(key_compare_(key(x), lo)){
+            x = x->right;
+        }else if(!key_compare_(key(x), hi)){
+            x = x->left;
+        }else{
+            break;
+        }
+    }
+    if(x == nullptr){
+        return A::template summary<node_type>(nullptr);
+    }
+    // the elements >= lo of the left subtree, gathered right to left
+    summary_type left = A::template summary<node_type>(nullptr);
+    for(base_ptr y = x->left; y != nullptr; ){
+        if(!key_compare_(key(y), lo)){
+            left = monoid::combine(monoid::combine(monoid::lift(static_cast<link_type>(y)->data), A::template summary<node_type>(y->right)), left);
+            y = y->left;
+        }else{
+            y = y->right;
+        }
+    }
+    // the elements < hi of the right subtree, gathered left to right
+    summary_type right = A::template summary<node_type>(nullptr);
+    for(base_ptr y = x->right; y != nullptr; ){
+        if(key_compare_(key(y), hi)){
+            right = monoid::combine(right, monoid::combine(A::template summary<node_type>(y->left), monoid::lift(static_cast<link_type>(y)->data)));
+            y = y->right;
+        }else{
+            y = y->left;
+        }
+    }
+    return monoid::combine(monoid::combine(left, monoid::lift(static_cast<link_type>(x)->data)), right);
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+bool rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::is_balanced() const{
+    if(root() == nullptr){
+        return size_ == 0 && leftmost() == header_ && rightmost() == header_;
+    }
+    if(!rb_tree_is_black(root()) || rb_tree_parent(root()) != header_ || is_balanced(root()) < 0){
+        return false;
+    }
+    if(leftmost() != NodeBase::minimum(root()) || rightmost() != NodeBase::maximum(root())){
+        return false;
+    }
+    size_type n = 0;
+    for(const_iterator it = begin(), prev = begin(); it != end(); prev = it, ++it, ++n){
+        if(n > 0 && key_compare_(key(it.node), key(prev.node))){
+            return false;
+        }
+    }
+    return n == size_;
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+int rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::is_balanced(link_type x) const{
+    if(x == nullptr){
+        return 0;
+    }
+    link_type l = link_type(x->left);
+    link_type r = link_type(x->right);
+    if((l != nullptr && rb_tree_parent(l) != x) || (r != nullptr && rb_tree_parent(r) != x)){
+        return -1;
+    }
+    if(rb_tree_is_red(x) && ((l != nullptr && rb_tree_is_red(l)) || (r != nullptr && rb_tree_is_red(r)))){
+        return -1;
+    }
+    if(!summary_ok(x)){
+        return -1;
+    }
+    int lh = is_balanced(l);
+    int rh = is_balanced(r);
+    if(lh < 0 || lh != rh){
+        return -1;
+    }
+    return lh + (rb_tree_is_black(x) ? 1 : 0);
+}
+
+// first node whose key is not less than k, header_ if none
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename K>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::link_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::lower_bound_node(const K& k) const{
+    link_type y = header_;
+    link_type x = root();
+    while(x != nullptr){
+        if(!key_compare_(key(x), k)){
+            y = x;
+            x = link_type(x->left);
+        }else{
+            x = link_type(x->right);
+        }
+    }
+    return y;
+}
+
+// first node whose key is greater than k, header_ if none
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename K>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::link_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::upper_bound_node(const K& k) const{
+    link_type y = header_;
+    link_type x = root();
+    while(x != nullptr){
+        if(key_compare_(k, key(x))){
+            y = x;
+            x = link_type(x->left);
+        }else{
+            x = link_type(x->right);
+        }
+    }
+    return y;
+}
+
+// one comparison per level, equality is checked once at the end
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename K>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::link_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::find_node(const K& k) const{
+    link_type y = lower_bound_node(k);
+    return (y == header_ || key_compare_(k, key(y))) ? header_ : y;
+}
+
+// descend together until the first node equal to k, then finish lower_bound in its left
+// subtree and upper_bound in its right one
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename Iterator, typename K>
+std::pair<Iterator, Iterator> rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::equal_range_node(const K& k) const{
+    link_type y = header_;
+    link_type x = root();
+    while(x != nullptr){
+        if(key_compare_(key(x), k)){
+            x = link_type(x->right);
+        }else if(key_compare_(k, key(x))){
+            y = x;
+            x = link_type(x->left);
+        }else{
+            link_type lo = x;
+            link_type l = link_type(x->left);
+            while(l != nullptr){
+                if(!key_compare_(key(l), k)){
+                    lo = l;
+                    l = link_type(l->left);
+                }else{
+                    l = link_type(l->right);
+                }
+            }
+            link_type r = link_type(x->right);
+            while(r != nullptr){
+                if(key_compare_(k, key(r))){
+                    y = r;
+                    r = link_type(r->left);
+                }else{
+                    r = link_type(r->right);
+                }
+            }
+            return std::pair<Iterator, Iterator>(Iterator(lo), Iterator(y));
+        }
+    }
+    return std::pair<Iterator, Iterator>(Iterator(y), Iterator(y));
+}
+
+template <typename T, typename Compare, typename KeyOfValue, typename Augment, typename NodeBase>
+template <typename K>
+typename rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::size_type rb_tree<T, Compare, KeyOfValue, Augment, NodeBase>::count_node(const K& k) const{
+    std::pair<const_iterator, const_iterator> range = equal_range_node<const_iterator>(k);
+    size_type n = 0;
+    for(; range.first != range.second; ++range.first){
+        ++n;
+    }
+    return n;
+}
 
- 
 } // namespace hstl
 #endif
\ No newline at end of file
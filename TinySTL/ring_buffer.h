@@ -0,0 +1,343 @@
+#ifndef TINYSTL_RING_BUFFER_H
+#define TINYSTL_RING_BUFFER_H
+
+#include <cstddef>
+#include <iterator>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+#include "allocator.h"
+#include "construct.h"
+#include "uninitialized.h"
+
+namespace hstl{
+
+// ring buffer iterator, stores the logical index so that end() is distinct from begin() when full
+template <typename T, typename Ref, typename Ptr>
+class ring_buffer_iterator{
+public:
+    typedef ring_buffer_iterator<T, T&, T*>             iterator;
+    typedef ring_buffer_iterator<T, const T&, const T*> const_iterator;
+    typedef ring_buffer_iterator                        self;
+
+    typedef std::random_access_iterator_tag             iterator_category;
+    typedef T                                           value_type;
+    typedef Ptr                                         pointer;
+    typedef Ref                                         reference;
+    typedef std::size_t                                 size_type;
+    typedef std::ptrdiff_t                              difference_type;
+
+    T*          buffer;
+    size_type   mask;
+    size_type   index;     // position counted from the start of the buffer, not wrapped
+
+    ring_buffer_iterator() noexcept : buffer(nullptr), mask(0), index(0){}
+    ring_buffer_iterator(T* b, size_type m, size_type i) noexcept : buffer(b), mask(m), index(i){}
+    ring_buffer_iterator(const iterator& rhs) noexcept : buffer(rhs.buffer), mask(rhs.mask), index(rhs.index){}
+
+    reference operator*() const { return buffer[index & mask]; }
+    pointer operator->() const { return &(operator*()); }
+    reference operator[](difference_type n) const { return buffer[(index + n) & mask]; }
+
+    self& operator++(){ ++index; return *this; }
+    self operator++(int){ self tmp = *this; ++index; return tmp; }
+    self& operator--(){ --index; return *this; }
+    self operator--(int){ self tmp = *this; --index; return tmp; }
+    self& operator+=(difference_type n){ index += n; return *this; }
+    self& operator-=(difference_type n){ index -= n; return *this; }
+    self operator+(difference_type n) const { return self(buffer, mask, index + n); }
+    self operator-(difference_type n) const { return self(buffer, mask, index - n); }
+    difference_type operator-(const self& rhs) const { return static_cast<difference_type>(index - rhs.index); }
+
+    bool operator==(const self& rhs) const { return index == rhs.index; }
+    bool operator!=(const self& rhs) const { return index != rhs.index; }
+    bool operator<(const self& rhs) const { return static_cast<difference_type>(index - rhs.index) < 0; }
+    bool operator>(const self& rhs) const { return rhs < *this; }
+    bool operator<=(const self& rhs) const { return !(rhs < *this); }
+    bool operator>=(const self& rhs) const { return !(*this < rhs); }
+};
+
+
+// fixed capacity FIFO; the capacity is rounded up to a power of two so that
+// positions wrap with a mask instead of a division. A moved-from buffer has
+// capacity 0: it is empty and full at once and rejects every push
+template <typename T>
+class ring_buffer{
+public:
+    typedef hstl::allocator<T>                          allocator_type;
+    typedef hstl::allocator<T>                          data_allocator;
+
+    typedef typename allocator_type::value_type         value_type;
+    typedef typename allocator_type::pointer            pointer;
+    typedef typename allocator_type::const_pointer      const_pointer;
+    typedef typename allocator_type::reference          reference;
+    typedef typename allocator_type::const_reference    const_reference;
+    typedef typename allocator_type::size_type          size_type;
+    typedef typename allocator_type::difference_type    difference_type;
+
+    typedef ring_buffer_iterator<T, T&, T*>             iterator;
+    typedef ring_buffer_iterator<T, const T&, const T*> const_iterator;
+
+    // a contiguous piece of the contents, e.g. one iovec for writev
+    typedef std::pair<pointer, size_type>               array_range;
+    typedef std::pair<const_pointer, size_type>         const_array_range;
+
+private:
+    pointer     buffer_;
+    size_type   mask_;      // capacity - 1, all ones for capacity 0
+    size_type   head_;      // index of the oldest element, not wrapped
+    size_type   tail_;      // one past the newest element, not wrapped
+    bool        overwrite_; // when full, push drops the oldest element instead of failing
+
+public:
+    explicit ring_buffer(size_type capacity, bool overwrite = false);
+    ring_buffer(const ring_buffer& rhs);
+    ring_buffer(ring_buffer&& rhs) noexcept;
+    ~ring_buffer();
+
+    ring_buffer& operator=(const ring_buffer& rhs);
+    ring_buffer& operator=(ring_buffer&& rhs) noexcept;
+
+public:
+    iterator begin() noexcept { return iterator(buffer_, mask_, head_); }
+    iterator end() noexcept { return iterator(buffer_, mask_, tail_); }
+    const_iterator begin() const noexcept { return const_iterator(buffer_, mask_, head_); }
+    const_iterator end() const noexcept { return const_iterator(buffer_, mask_, tail_); }
+
+    size_type size() const noexcept { return tail_ - head_; }
+    size_type capacity() const noexcept { return mask_ + 1; }
+    bool empty() const noexcept { return head_ == tail_; }
+    bool full() const noexcept { return size() == capacity(); }
+    bool overwrite() const noexcept { return overwrite_; }
+
+    reference operator[](size_type n);
+    const_reference operator[](size_type n) const;
+    reference front();
+    reference back();
+    const_reference front() const;
+    const_reference back() const;
+
+    // the contents as at most two contiguous ranges, oldest first
+    array_range array_one() noexcept;
+    array_range array_two() noexcept;
+    const_array_range array_one() const noexcept;
+    const_array_range array_two() const noexcept;
+
+    // return false if the buffer is full and not in overwrite mode
+    template <typename... Args>
+    bool emplace_back(Args&&... args);
+    bool push_back(const value_type& value);
+    bool push_back(value_type&& value);
+
+    void pop_front();
+    void clear() noexcept;
+    void swap(ring_buffer& rhs) noexcept;
+
+private:
+    static size_type round_up_capacity(size_type n) noexcept;
+    void destroy_all() noexcept;
+};
+
+
+template <typename T>
+ring_buffer<T>::ring_buffer(size_type capacity, bool overwrite)
+    : buffer_(nullptr), mask_(round_up_capacity(capacity) - 1), head_(0), tail_(0), overwrite_(overwrite){
+    buffer_ = data_allocator::allocate(mask_ + 1);
+}
+
+template <typename T>
+ring_buffer<T>::ring_buffer(const ring_buffer& rhs)
+    : buffer_(nullptr), mask_(rhs.mask_), head_(0), tail_(0), overwrite_(rhs.overwrite_){
+    buffer_ = data_allocator::allocate(mask_ + 1);
+    try{
+        const_array_range one = rhs.array_one();
+        const_array_range two = rhs.array_two();
+        pointer mid = hstl::uninitialized_copy(one.first, one.first + one.second, buffer_);
+        try{
+            hstl::uninitialized_copy(two.first, two.first + two.second, mid);
+        }catch(...){
+            data_allocator::destroy(buffer_, mid);
+            throw;
+        }
+    }catch(...){
+        data_allocator::deallocate(buffer_, mask_ + 1);
+        throw;
+    }
+    tail_ = rhs.size();
+}
+
+template <typename T>
+ring_buffer<T>::ring_buffer(ring_buffer&& rhs) noexcept
+    : buffer_(rhs.buffer_), mask_(rhs.mask_), head_(rhs.head_), tail_(rhs.tail_), overwrite_(rhs.overwrite_){
+    rhs.buffer_ = nullptr;
+    rhs.mask_ = static_cast<size_type>(-1);
+    rhs.head_ = rhs.tail_ = 0;
+}
+
+template <typename T>
+ring_buffer<T>::~ring_buffer(){
+    if(buffer_ != nullptr){
+        destroy_all();
+        data_allocator::deallocate(buffer_, mask_ + 1);
+        buffer_ = nullptr;
+    }
+}
+
+template <typename T>
+ring_buffer<T>& ring_buffer<T>::operator=(const ring_buffer& rhs){
+    if(this != &rhs){
+        ring_buffer tmp(rhs);
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <typename T>
+ring_buffer<T>& ring_buffer<T>::operator=(ring_buffer&& rhs) noexcept{
+    if(this != &rhs){
+        swap(rhs);
+    }
+    return *this;
+}
+
+template <typename T>
+typename ring_buffer<T>::reference ring_buffer<T>::operator[](size_type n){
+    assert(n < size());
+    return buffer_[(head_ + n) & mask_];
+}
+
+template <typename T>
+typename ring_buffer<T>::const_reference ring_buffer<T>::operator[](size_type n) const{
+    assert(n < size());
+    return buffer_[(head_ + n) & mask_];
+}
+
+template <typename T>
+typename ring_buffer<T>::reference ring_buffer<T>::front(){
+    assert(!empty());
+    return buffer_[head_ & mask_];
+}
+
+template <typename T>
+typename ring_buffer<T>::reference ring_buffer<T>::back(){
+    assert(!empty());
+    return buffer_[(tail_ - 1) & mask_];
+}
+
+template <typename T>
+typename ring_buffer<T>::const_reference ring_buffer<T>::front() const{
+    assert(!empty());
+    return buffer_[head_ & mask_];
+}
+
+template <typename T>
+typename ring_buffer<T>::const_reference ring_buffer<T>::back() const{
+    assert(!empty());
+    return buffer_[(tail_ - 1) & mask_];
+}
+
+template <typename T>
+typename ring_buffer<T>::array_range ring_buffer<T>::array_one() noexcept{
+    const size_type first = head_ & mask_;
+    const size_type len = std::min(size(), capacity() - first);
+    return array_range(buffer_ + first, len);
+}
+
+template <typename T>
+typename ring_buffer<T>::array_range ring_buffer<T>::array_two() noexcept{
+    const size_type first = head_ & mask_;
+    const size_type len = size() - std::min(size(), capacity() - first);
+    return array_range(buffer_, len);
+}
+
+template <typename T>
+typename ring_buffer<T>::const_array_range ring_buffer<T>::array_one() const noexcept{
+    const size_type first = head_ & mask_;
+    const size_type len = std::min(size(), capacity() - first);
+    return const_array_range(buffer_ + first, len);
+}
+
+template <typename T>
+typename ring_buffer<T>::const_array_range ring_buffer<T>::array_two() const noexcept{
+    const size_type first = head_ & mask_;
+    const size_type len = size() - std::min(size(), capacity() - first);
+    return const_array_range(buffer_, len);
+}
+
+template <typename T>
+template <typename... Args>
+bool ring_buffer<T>::emplace_back(Args&&... args){
+    if(full()){
+        if(!overwrite_ || empty()){
+            return false;
+        }
+        // the slot of the oldest element becomes the slot of the newest. The value is
+        // built first, as the arguments may refer to the element that is dropped; if
+        // building it throws the buffer is left as it was, if moving it in throws the
+        // buffer is left with one free slot
+        value_type value(std::forward<Args>(args)...);
+        data_allocator::destroy(buffer_ + (head_ & mask_));
+        ++head_;
+        data_allocator::construct(buffer_ + (tail_ & mask_), std::move(value));
+        ++tail_;
+        return true;
+    }
+    data_allocator::construct(buffer_ + (tail_ & mask_), std::forward<Args>(args)...);
+    ++tail_;
+    return true;
+}
+
+template <typename T>
+bool ring_buffer<T>::push_back(const value_type& value){
+    return emplace_back(value);
+}
+
+template <typename T>
+bool ring_buffer<T>::push_back(value_type&& value){
+    return emplace_back(std::move(value));
+}
+
+template <typename T>
+void ring_buffer<T>::pop_front(){
+    assert(!empty());
+    data_allocator::destroy(buffer_ + (head_ & mask_));
+    ++head_;
+}
+
+template <typename T>
+void ring_buffer<T>::clear() noexcept{
+    destroy_all();
+    head_ = tail_ = 0;
+}
+
+template <typename T>
+void ring_buffer<T>::swap(ring_buffer& rhs) noexcept{
+    if(this != &rhs){
+        std::swap(buffer_, rhs.buffer_);
+        std::swap(mask_, rhs.mask_);
+        std::swap(head_, rhs.head_);
+        std::swap(tail_, rhs.tail_);
+        std::swap(overwrite_, rhs.overwrite_);
+    }
+}
+
+template <typename T>
+typename ring_buffer<T>::size_type ring_buffer<T>::round_up_capacity(size_type n) noexcept{
+    size_type capacity = 1;
+    while(capacity < n){
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+template <typename T>
+void ring_buffer<T>::destroy_all() noexcept{
+    array_range one = array_one();
+    array_range two = array_two();
+    data_allocator::destroy(one.first, one.first + one.second);
+    data_allocator::destroy(two.first, two.first + two.second);
+}
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef TINYSTL_SET_H
+#define TINYSTL_SET_H
+
+#include <functional>
+#include <utility>
+#include "rb_tree.h"
+
+namespace hstl{
+
+// sorted unique keys, an rb_tree of the keys themselves; NodeBase picks the node layout,
+// see rb_tree_node_base
+template <typename Key, typename Compare = std::less<Key>, typename NodeBase = rb_tree_node_base>
+class set{
+public:
+    typedef Key                                         key_type;
+    typedef Key                                         value_type;
+    typedef Compare                                     key_compare;
+    typedef Compare                                     value_compare;
+
+private:
+    typedef hstl::rb_tree<value_type, Compare, hstl::identity<value_type>, rb_tree_no_augment, NodeBase> tree_type;
+
+    tree_type tree_;
+
+public:
+    typedef typename tree_type::const_reference         reference;
+    typedef typename tree_type::const_reference         const_reference;
+    typedef typename tree_type::size_type               size_type;
+    // elements are keys, they cannot be changed in place
+    typedef typename tree_type::const_iterator          iterator;
+    typedef typename tree_type::const_iterator          const_iterator;
+
+    set() : tree_(){}
+    explicit set(const Compare& comp) : tree_(comp){}
+    template <typename InputIterator>
+    set(InputIterator first, InputIterator last, const Compare& comp = Compare()) : tree_(comp){
+        insert(first, last);
+    }
+
+    key_compare key_comp() const{ return tree_.key_comp(); }
+    iterator begin() const{ return tree_.begin(); }
+    iterator end() const{ return tree_.end(); }
+    size_type size() const{ return tree_.size(); }
+    bool empty() const{ return tree_.empty(); }
+
+    std::pair<iterator, bool> insert(const value_type& value){ return tree_.insert_unique(value); }
+    std::pair<iterator, bool> insert(value_type&& value){ return tree_.insert_unique(std::move(value)); }
+    template <typename InputIterator>
+    void insert(InputIterator first, InputIterator last){
+        for(; first != last; ++first){
+            tree_.insert_unique(*first);
+        }
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args){ return tree_.emplace_unique(std::forward<Args>(args)...); }
+
+    iterator erase(iterator position){ return tree_.erase(typename tree_type::iterator(static_cast<typename tree_type::link_type>(position.node))); }
+    size_type erase(const key_type& k){ return tree_.erase(k); }
+
+    iterator find(const key_type& k) const{ return tree_.find(k); }
+    size_type count(const key_type& k) const{ return tree_.count(k); }
+    iterator lower_bound(const key_type& k) const{ return tree_.lower_bound(k); }
+    iterator upper_bound(const key_type& k) const{ return tree_.upper_bound(k); }
+    std::pair<iterator, iterator> equal_range(const key_type& k) const{ return tree_.equal_range(k); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& k) const{ return tree_.find(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K& k) const{ return tree_.count(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& k) const{ return tree_.lower_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& k) const{ return tree_.upper_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& k) const{ return tree_.equal_range(k); }
+};
+
+
+// sorted keys, equal keys allowed and kept in insertion order
+template <typename Key, typename Compare = std::less<Key>, typename NodeBase = rb_tree_node_base>
+class multiset{
+public:
+    typedef Key                                         key_type;
+    typedef Key                                         value_type;
+    typedef Compare                                     key_compare;
+    typedef Compare                                     value_compare;
+
+private:
+    typedef hstl::rb_tree<value_type, Compare, hstl::identity<value_type>, rb_tree_no_augment, NodeBase> tree_type;
+
+    tree_type tree_;
+
+public:
+    typedef typename tree_type::const_reference         reference;
+    typedef typename tree_type::const_reference         const_reference;
+    typedef typename tree_type::size_type               size_type;
+    // elements are keys, they cannot be changed in place
+    typedef typename tree_type::const_iterator          iterator;
+    typedef typename tree_type::const_iterator          const_iterator;
+
+    multiset() : tree_(){}
+    explicit multiset(const Compare& comp) : tree_(comp){}
+    template <typename InputIterator>
+    multiset(InputIterator first, InputIterator last, const Compare& comp = Compare()) : tree_(comp){
+        insert(first, last);
+    }
+
+    key_compare key_comp() const{ return tree_.key_comp(); }
+    iterator begin() const{ return tree_.begin(); }
+    iterator end() const{ return tree_.end(); }
+    size_type size() const{ return tree_.size(); }
+    bool empty() const{ return tree_.empty(); }
+
+    iterator insert(const value_type& value){ return tree_.insert_equal(value); }
+    iterator insert(value_type&& value){ return tree_.insert_equal(std::move(value)); }
+    template <typename InputIterator>
+    void insert(InputIterator first, InputIterator last){
+        for(; first != last; ++first){
+            tree_.insert_equal(*first);
+        }
+    }
+    template <typename... Args>
+    iterator emplace(Args&&... args){ return tree_.emplace_equal(std::forward<Args>(args)...); }
+
+    iterator erase(iterator position){ return tree_.erase(typename tree_type::iterator(static_cast<typename tree_type::link_type>(position.node))); }
+    size_type erase(const key_type& k){ return tree_.erase(k); }
+
+    iterator find(const key_type& k) const{ return tree_.find(k); }
+    size_type count(const key_type& k) const{ return tree_.count(k); }
+    iterator lower_bound(const key_type& k) const{ return tree_.lower_bound(k); }
+    iterator upper_bound(const key_type& k) const{ return tree_.upper_bound(k); }
+    std::pair<iterator, iterator> equal_range(const key_type& k) const{ return tree_.equal_range(k); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& k) const{ return tree_.find(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K& k) const{ return tree_.count(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& k) const{ return tree_.lower_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& k) const{ return tree_.upper_bound(k); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& k) const{ return tree_.equal_range(k); }
+};
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef TINYSTL_SPSC_QUEUE_H
+#define TINYSTL_SPSC_QUEUE_H
+
+#include <cstddef>
+#include <atomic>
+#include <utility>
+#include <iterator>
+#include "allocator.h"
+#include "construct.h"
+
+namespace hstl{
+
+#ifndef TINYSTL_CACHE_LINE_SIZE
+#define TINYSTL_CACHE_LINE_SIZE 64
+#endif
+
+// bounded lock-free queue for exactly one producer thread and one consumer thread
+//
+// head_ is written only by the consumer and tail_ only by the producer; each side
+// keeps a cached copy of the other side's index and only reloads it (one cross-core
+// cache miss) when the cached value says the queue looks full / empty
+template <typename T>
+class spsc_queue{
+public:
+    typedef hstl::allocator<T>                          allocator_type;
+    typedef hstl::allocator<T>                          data_allocator;
+
+    typedef typename allocator_type::value_type         value_type;
+    typedef typename allocator_type::pointer            pointer;
+    typedef typename allocator_type::reference          reference;
+    typedef typename allocator_type::size_type          size_type;
+
+    static constexpr size_type cache_line_size = TINYSTL_CACHE_LINE_SIZE;
+
+private:
+    // read-only after construction
+    alignas(cache_line_size) pointer buffer_;
+    size_type mask_;
+
+    // consumer side
+    alignas(cache_line_size) std::atomic<size_type> head_;
+    size_type cached_tail_;
+
+    // producer side
+    alignas(cache_line_size) std::atomic<size_type> tail_;
+    size_type cached_head_;
+
+public:
+    // capacity is rounded up to a power of two
+    explicit spsc_queue(size_type capacity);
+    ~spsc_queue();
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    size_type capacity() const noexcept { return mask_ + 1; }
+    // exact only when called from one of the two threads while the other is idle
+    size_type size_approx() const noexcept;
+    bool empty() const noexcept { return size_approx() == 0; }
+
+    // producer
+    template <typename... Args>
+    bool try_emplace(Args&&... args);
+    bool try_push(const value_type& value);
+    bool try_push(value_type&& value);
+    // push up to n elements from first, return how many were pushed
+    template <typename InputIterator>
+    size_type try_push_n(InputIterator first, size_type n);
+
+    // consumer
+    bool try_pop(value_type& value);
+    // the oldest element or nullptr if empty, it stays valid until pop()
+    pointer front();
+    void pop();
+    // move up to n elements to out, return how many were popped
+    template <typename OutputIterator>
+    size_type try_pop_n(OutputIterator out, size_type n);
+
+private:
+    static size_type round_up_capacity(size_type n) noexcept;
+    size_type free_slots(size_type tail);
+    size_type ready_slots(size_type head);
+};
+
+
+template <typename T>
+spsc_queue<T>::spsc_queue(size_type capacity)
+    : buffer_(nullptr), mask_(round_up_capacity(capacity) - 1), head_(0), cached_tail_(0), tail_(0), cached_head_(0){
+    buffer_ = data_allocator::allocate(mask_ + 1);
+}
+
+template <typename T>
+spsc_queue<T>::~spsc_queue(){
+    size_type head = head_.load(std::memory_order_relaxed);
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    for(; head != tail; ++head){
+        hstl::destroy(buffer_ + (head & mask_));
+    }
+    data_allocator::deallocate(buffer_, mask_ + 1);
+}
+
+template <typename T>
+typename spsc_queue<T>::size_type spsc_queue<T>::size_approx() const noexcept{
+    const size_type head = head_.load(std::memory_order_acquire);
+    const size_type tail = tail_.load(std::memory_order_acquire);
+    return tail - head;
+}
+
+template <typename T>
+template <typename... Args>
+bool spsc_queue<T>::try_emplace(Args&&... args){
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    if(tail - cached_head_ == capacity() && free_slots(tail) == 0){
+        return false;
+    }
+    // placement new rather than hstl::construct, whose (ptr, const Ty2&) overload would
+    // build a Ty2 instead of converting to T
+    ::new(static_cast<void*>(buffer_ + (tail & mask_))) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool spsc_queue<T>::try_push(const value_type& value){
+    return try_emplace(value);
+}
+
+template <typename T>
+bool spsc_queue<T>::try_push(value_type&& value){
+    return try_emplace(std::move(value));
+}
+
+template <typename T>
+template <typename InputIterator>
+typename spsc_queue<T>::size_type spsc_queue<T>::try_push_n(InputIterator first, size_type n){
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    size_type room = capacity() - (tail - cached_head_);
+    if(room < n){
+        room = free_slots(tail);
+    }
+    n = n < room ? n : room;
+    size_type i = 0;
+    try{
+        for(; i < n; ++i, ++first){
+            ::new(static_cast<void*>(buffer_ + ((tail + i) & mask_))) T(*first);
+        }
+    }catch(...){
+        // publish what was constructed
+        tail_.store(tail + i, std::memory_order_release);
+        throw;
+    }
+    tail_.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+template <typename T>
+bool spsc_queue<T>::try_pop(value_type& value){
+    pointer p = front();
+    if(p == nullptr){
+        return false;
+    }
+    value = std::move(*p);
+    pop();
+    return true;
+}
+
+template <typename T>
+typename spsc_queue<T>::pointer spsc_queue<T>::front(){
+    const size_type head = head_.load(std::memory_order_relaxed);
+    if(head == cached_tail_ && ready_slots(head) == 0){
+        return nullptr;
+    }
+    return buffer_ + (head & mask_);
+}
+
+template <typename T>
+void spsc_queue<T>::pop(){
+    const size_type head = head_.load(std::memory_order_relaxed);
+    hstl::destroy(buffer_ + (head & mask_));
+    head_.store(head + 1, std::memory_order_release);
+}
+
+template <typename T>
+template <typename OutputIterator>
+typename spsc_queue<T>::size_type spsc_queue<T>::try_pop_n(OutputIterator out, size_type n){
+    const size_type head = head_.load(std::memory_order_relaxed);
+    size_type ready = cached_tail_ - head;
+    if(ready < n){
+        ready = ready_slots(head);
+    }
+    n = n < ready ? n : ready;
+    size_type i = 0;
+    try{
+        for(; i < n; ++i, ++out){
+            pointer p = buffer_ + ((head + i) & mask_);
+            *out = std::move(*p);
+            hstl::destroy(p);
+        }
+    }catch(...){
+        // the element that failed to move stays in the queue
+        head_.store(head + i, std::memory_order_release);
+        throw;
+    }
+    head_.store(head + n, std::memory_order_release);
+    return n;
+}
+
+template <typename T>
+typename spsc_queue<T>::size_type spsc_queue<T>::round_up_capacity(size_type n) noexcept{
+    size_type capacity = 1;
+    while(capacity < n){
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// producer: refresh the cached head, return the number of free slots
+template <typename T>
+typename spsc_queue<T>::size_type spsc_queue<T>::free_slots(size_type tail){
+    cached_head_ = head_.load(std::memory_order_acquire);
+    return capacity() - (tail - cached_head_);
+}
+
+// consumer: refresh the cached tail, return the number of ready elements
+template <typename T>
+typename spsc_queue<T>::size_type spsc_queue<T>::ready_slots(size_type head){
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    return cached_tail_ - head;
+}
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,300 @@
+#ifndef TINYSTL_THREAD_POOL_H
+#define TINYSTL_THREAD_POOL_H
+
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "allocator.h"
+#include "deque.h"
+#include "vector.h"
+#include "ws_deque.h"
+
+namespace hstl{
+
+// fixed-size pool where every worker owns a ws_deque: tasks submitted from a worker go to
+// the bottom of its own deque (LIFO, cache warm), idle workers steal from the top of the
+// others'. Tasks submitted from outside the pool go through a locked injection queue.
+class thread_pool{
+public:
+    typedef std::function<void()>                       task_type;
+    typedef std::size_t                                 size_type;
+
+private:
+    typedef hstl::allocator<task_type>                  task_allocator;
+    typedef hstl::ws_deque<task_type*>                  worker_deque;
+    typedef hstl::allocator<worker_deque>               deque_allocator;
+
+    hstl::vector<worker_deque*>     queues_;
+    hstl::vector<std::thread*>      threads_;
+    hstl::deque<task_type*>         injected_;      // guarded by mutex_
+    std::mutex                      mutex_;
+    std::condition_variable         wakeup_;
+    std::atomic<size_type>          pending_;       // submitted but not yet finished
+    std::atomic<bool>               stop_;
+    std::exception_ptr              error_;         // first exception thrown by a submitted task, guarded by mutex_
+
+public:
+    // 0 threads means std::thread::hardware_concurrency()
+    explicit thread_pool(size_type threads = 0);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    size_type size() const noexcept { return threads_.size(); }
+
+    template <typename F>
+    void submit(F&& f);
+
+    // run pending tasks on the calling thread until every submitted task has finished,
+    // then rethrow the first exception a submitted task threw since the last wait_idle
+    void wait_idle();
+
+    // call f(i) for every i in [first, last), in chunks of grain, and return when all are done;
+    // the calling thread executes chunks too, so this may be nested inside pool tasks.
+    // If f throws, chunks not yet started are skipped and the first exception is rethrown
+    // once no chunk is running any more
+    template <typename Index, typename F>
+    void parallel_for(Index first, Index last, Index grain, F f);
+
+private:
+    void worker_loop(size_type index);
+    bool run_one(size_type self);
+    bool take_task(size_type self, task_type*& task);
+    void execute(task_type* task);
+    void help_until_zero(const std::atomic<size_type>& counter);
+
+    // the pool and deque index of the calling thread, so a worker of one pool
+    // submitting to another pool goes through that pool's injection queue
+    struct worker_slot{
+        const thread_pool*  pool;
+        size_type           index;
+    };
+    static worker_slot& current_worker();
+    size_type worker_index() const;
+};
+
+
+inline thread_pool::thread_pool(size_type threads) : pending_(0), stop_(false){
+    if(threads == 0){
+        threads = std::thread::hardware_concurrency();
+        threads = threads == 0 ? 1 : threads;
+    }
+    for(size_type i = 0; i < threads; ++i){
+        worker_deque* q = deque_allocator::allocate();
+        hstl::construct(q);
+        queues_.push_back(q);
+    }
+    // every queue exists before a worker may try to steal from it
+    for(size_type i = 0; i < threads; ++i){
+        threads_.push_back(new std::thread(&thread_pool::worker_loop, this, i));
+    }
+}
+
+inline thread_pool::~thread_pool(){
+    // nobody is left to report a task's exception to
+    help_until_zero(pending_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_.store(true);
+    }
+    wakeup_.notify_all();
+    for(auto it = threads_.begin(); it != threads_.end(); ++it){
+        (*it)->join();
+        delete *it;
+    }
+    for(auto it = queues_.begin(); it != queues_.end(); ++it){
+        hstl::destroy(*it);
+        deque_allocator::deallocate(*it);
+    }
+}
+
+template <typename F>
+void thread_pool::submit(F&& f){
+    task_type* task = task_allocator::allocate();
+    try{
+        hstl::construct(task, task_type(std::forward<F>(f)));
+    }catch(...){
+        task_allocator::deallocate(task);
+        throw;
+    }
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    const size_type self = worker_index();
+    if(self < queues_.size()){
+        queues_[self]->push(task);
+    }else{
+        std::lock_guard<std::mutex> lock(mutex_);
+        injected_.push_back(task);
+    }
+    wakeup_.notify_one();
+}
+
+inline void thread_pool::wait_idle(){
+    help_until_zero(pending_);
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error.swap(error_);
+    }
+    if(error){
+        std::rethrow_exception(error);
+    }
+}
+
+template <typename Index, typename F>
+void thread_pool::parallel_for(Index first, Index last, Index grain, F f){
+    if(!(first < last)){
+        return;
+    }
+    grain = grain < Index(1) ? Index(1) : grain;
+    const size_type chunks = static_cast<size_type>((last - first + grain - 1) / grain);
+    // the chunks refer to f and to these locals, so nothing returns or unwinds from here
+    // before remaining drops to zero
+    std::atomic<size_type> remaining(chunks);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;       // written by the first failing chunk only
+    struct chunk_guard{
+        std::atomic<size_type>& remaining;
+        ~chunk_guard(){ remaining.fetch_sub(1, std::memory_order_release); }
+    };
+    size_type submitted = 0;
+    try{
+        for(Index lo = first; lo < last; ++submitted){
+            Index hi = last - lo > grain ? lo + grain : last;
+            submit([&f, &remaining, &failed, &error, lo, hi]{
+                chunk_guard guard{remaining};
+                if(failed.load(std::memory_order_relaxed)){
+                    return;
+                }
+                try{
+                    for(Index i = lo; i < hi; ++i){
+                        f(i);
+                    }
+                }catch(...){
+                    if(!failed.exchange(true)){
+                        error = std::current_exception();
+                    }
+                }
+            });
+            lo = hi;
+        }
+    }catch(...){
+        // submit failed: settle the chunks that were queued, then let its exception through
+        failed.store(true);
+        remaining.fetch_sub(chunks - submitted, std::memory_order_release);
+        help_until_zero(remaining);
+        throw;
+    }
+    help_until_zero(remaining);
+    if(error){
+        std::rethrow_exception(error);
+    }
+}
+
+inline void thread_pool::worker_loop(size_type index){
+    current_worker().pool = this;
+    current_worker().index = index;
+    unsigned idle = 0;
+    for(;;){
+        if(run_one(index)){
+            idle = 0;
+            continue;
+        }
+        if(++idle < 64){
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        if(stop_.load() && pending_.load() == 0){
+            return;
+        }
+        if(injected_.empty()){
+            // timed so that work pushed onto another worker's deque is noticed as well
+            wakeup_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+}
+
+inline bool thread_pool::run_one(size_type self){
+    task_type* task = nullptr;
+    if(!take_task(self, task)){
+        return false;
+    }
+    execute(task);
+    return true;
+}
+
+// own deque first, then the injection queue, then steal starting after our own index
+inline bool thread_pool::take_task(size_type self, task_type*& task){
+    const size_type n = queues_.size();
+    if(self < n && queues_[self]->pop(task)){
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!injected_.empty()){
+            task = injected_.front();
+            injected_.pop_front();
+            return true;
+        }
+    }
+    const size_type start = self < n ? self + 1 : 0;
+    for(size_type k = 0; k < n; ++k){
+        const size_type victim = (start + k) % n;
+        if(victim != self && queues_[victim]->steal(task)){
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void thread_pool::execute(task_type* task){
+    struct finish_guard{
+        thread_pool* pool;
+        task_type* task;
+        ~finish_guard(){
+            hstl::destroy(task);
+            task_allocator::deallocate(task);
+            pool->pending_.fetch_sub(1, std::memory_order_release);
+        }
+    } guard{this, task};
+    // an exception must not escape a worker; keep the first for wait_idle
+    try{
+        (*task)();
+    }catch(...){
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!error_){
+            error_ = std::current_exception();
+        }
+    }
+}
+
+inline void thread_pool::help_until_zero(const std::atomic<size_type>& counter){
+    const size_type self = worker_index();
+    while(counter.load(std::memory_order_acquire) != 0){
+        if(!run_one(self)){
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline thread_pool::worker_slot& thread_pool::current_worker(){
+    static thread_local worker_slot slot = {nullptr, 0};
+    return slot;
+}
+
+// index of the calling thread's deque, or -1 for threads outside this pool
+inline thread_pool::size_type thread_pool::worker_index() const{
+    const worker_slot& slot = current_worker();
+    return slot.pool == this ? slot.index : static_cast<size_type>(-1);
+}
+
+} // namespace hstl
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef TINYSTL_TIMER_WHEEL_H
+#define TINYSTL_TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <utility>
+#include "allocator.h"
+#include "construct.h"
+
+namespace hstl{
+
+// the links of a timer node, also the sentinel of every slot
+struct timer_wheel_link{
+    timer_wheel_link* prev;
+    timer_wheel_link* next;
+};
+
+template <typename T>
+struct timer_wheel_node : timer_wheel_link{
+    std::uint64_t   expires;
+    std::size_t     level;
+    T               data;
+
+    template <typename... Args>
+    timer_wheel_node(std::uint64_t when, Args&&... args) : expires(when), level(0), data(std::forward<Args>(args)...){}
+};
+
+// hierarchical timing wheel (Varghese and Lauck): Levels wheels of 2^LevelBits slots, a
+// timer sits in the slot of the lowest level whose span covers its delay; each slot is a
+// circular doubly linked list, so schedule and cancel are O(1). When level 0 wraps the
+// next slot of level 1 is cascaded down, and so on upwards; a timer is moved at most
+// Levels - 1 times before it fires. Delays past the top level are clamped to its last
+// slot and re-filed when that slot cascades.
+//
+// time is in ticks; current_tick() is the next tick advance() will process, every timer
+// with an earlier expiry has already been returned
+template <typename T, std::size_t LevelBits = 6, std::size_t Levels = 4>
+class timer_wheel{
+    static_assert(LevelBits > 0 && Levels > 0 && LevelBits * Levels < 64, "timer_wheel span must fit in 64 bits");
+public:
+    typedef T                                           value_type;
+    typedef std::size_t                                 size_type;
+    typedef std::uint64_t                               tick_type;
+    typedef timer_wheel_node<T>                         node_type;
+    typedef hstl::allocator<node_type>                  node_allocator;
+    // identifies a scheduled timer until it fires or is cancelled
+    typedef node_type*                                  handle;
+
+    static constexpr size_type slots_per_level = size_type(1) << LevelBits;
+    static constexpr tick_type slot_mask = slots_per_level - 1;
+
+private:
+    timer_wheel_link    slots_[Levels][slots_per_level];
+    size_type           level_size_[Levels];
+    size_type           size_;
+    tick_type           current_;
+    timer_wheel_link*   free_;      // recycled nodes, singly linked through next
+
+public:
+    explicit timer_wheel(tick_type start = 0);
+    ~timer_wheel();
+
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    tick_type current_tick() const noexcept { return current_; }
+
+    // a timer expiring at tick expires; one already in the past fires at current_tick()
+    template <typename... Args>
+    handle schedule(tick_type expires, Args&&... args);
+    void cancel(handle h);
+    // move a pending timer to a new expiry, e.g. to refresh an idle timeout
+    void reschedule(handle h, tick_type expires);
+
+    static tick_type expires(handle h) noexcept { return h->expires; }
+    static value_type& value(handle h) noexcept { return h->data; }
+
+    // process every tick up to and including now, moving the values of the timers that
+    // expire to out in expiry order; return how many expired
+    template <typename OutputIterator>
+    size_type advance(tick_type now, OutputIterator out);
+
+    void clear();
+    // release the nodes kept for reuse
+    void shrink_to_fit() noexcept;
+
+private:
+    void link(node_type* node);
+    void unlink(node_type* node) noexcept;
+    void cascade(size_type level);
+    node_type* get_node();
+    void put_node(node_type* node) noexcept;
+};
+
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+timer_wheel<T, LevelBits, Levels>::timer_wheel(tick_type start) : size_(0), current_(start), free_(nullptr){
+    for(size_type l = 0; l < Levels; ++l){
+        level_size_[l] = 0;
+        for(size_type s = 0; s < slots_per_level; ++s){
+            slots_[l][s].prev = slots_[l][s].next = &slots_[l][s];
+        }
+    }
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+timer_wheel<T, LevelBits, Levels>::~timer_wheel(){
+    clear();
+    shrink_to_fit();
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+template <typename... Args>
+typename timer_wheel<T, LevelBits, Levels>::handle
+timer_wheel<T, LevelBits, Levels>::schedule(tick_type expires, Args&&... args){
+    node_type* node = get_node();
+    try{
+        hstl::construct(node, expires, std::forward<Args>(args)...);
+    }catch(...){
+        put_node(node);
+        throw;
+    }
+    link(node);
+    ++size_;
+    return node;
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+void timer_wheel<T, LevelBits, Levels>::cancel(handle h){
+    assert(h != nullptr);
+    unlink(h);
+    --size_;
+    hstl::destroy(h);
+    put_node(h);
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+void timer_wheel<T, LevelBits, Levels>::reschedule(handle h, tick_type expires){
+    assert(h != nullptr);
+    unlink(h);
+    h->expires = expires;
+    link(h);
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+template <typename OutputIterator>
+typename timer_wheel<T, LevelBits, Levels>::size_type
+timer_wheel<T, LevelBits, Levels>::advance(tick_type now, OutputIterator out){
+    size_type fired = 0;
+    while(current_ <= now){
+        if(size_ == 0){
+            current_ = now + 1;
+            break;
+        }
+        const size_type index = static_cast<size_type>(current_ & slot_mask);
+        if(index == 0){
+            cascade(1);
+        }
+        if(level_size_[0] == 0){
+            // nothing can fire before the lowest non-empty level cascades again, jump to
+            // that boundary instead of walking the empty ticks
+            size_type level = 1;
+            while(level_size_[level] == 0){
+                ++level;
+            }
+            const tick_type next = (current_ | ((tick_type(1) << (LevelBits * level)) - 1)) + 1;
+            current_ = next <= now ? next : now + 1;
+            continue;
+        }
+        timer_wheel_link* head = &slots_[0][index];
+        while(head->next != head){
+            node_type* node = static_cast<node_type*>(head->next);
+            unlink(node);
+            if(node->expires > current_){
+                // clamped past the span of a single level wheel, file it again
+                link(node);
+                continue;
+            }
+            --size_;
+            *out = std::move(node->data);
+            ++out;
+            ++fired;
+            hstl::destroy(node);
+            put_node(node);
+        }
+        ++current_;
+    }
+    return fired;
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+void timer_wheel<T, LevelBits, Levels>::clear(){
+    for(size_type l = 0; l < Levels; ++l){
+        for(size_type s = 0; s < slots_per_level; ++s){
+            timer_wheel_link* head = &slots_[l][s];
+            while(head->next != head){
+                node_type* node = static_cast<node_type*>(head->next);
+                unlink(node);
+                hstl::destroy(node);
+                put_node(node);
+            }
+        }
+        level_size_[l] = 0;
+    }
+    size_ = 0;
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+void timer_wheel<T, LevelBits, Levels>::shrink_to_fit() noexcept{
+    while(free_ != nullptr){
+        node_type* node = static_cast<node_type*>(free_);
+        free_ = free_->next;
+        node_allocator::deallocate(node);
+    }
+}
+
+// file the node under the lowest level whose span covers its delay from current_
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+void timer_wheel<T, LevelBits, Levels>::link(node_type* node){
+    tick_type when = node->expires < current_ ? current_ : node->expires;
+    const tick_type max_delay = (tick_type(1) << (LevelBits * Levels)) - 1;
+    if(when - current_ > max_delay){
+        when = current_ + max_delay;
+    }
+    const tick_type delay = when - current_;
+    size_type level = 0;
+    while(level + 1 < Levels && delay >= (tick_type(1) << (LevelBits * (level + 1)))){
+        ++level;
+    }
+    timer_wheel_link* head = &slots_[level][(when >> (LevelBits * level)) & slot_mask];
+    node->level = level;
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+    ++level_size_[level];
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+void timer_wheel<T, LevelBits, Levels>::unlink(node_type* node) noexcept{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    --level_size_[node->level];
+}
+
+// level - 1 has just wrapped: re-file the timers of the current slot of level, after
+// cascading level + 1 first if level wrapped too
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+void timer_wheel<T, LevelBits, Levels>::cascade(size_type level){
+    if(level >= Levels){
+        return;
+    }
+    const size_type index = static_cast<size_type>((current_ >> (LevelBits * level)) & slot_mask);
+    if(index == 0){
+        cascade(level + 1);
+    }
+    timer_wheel_link* head = &slots_[level][index];
+    if(head->next == head){
+        return;
+    }
+    // detach the whole slot first, re-filing may put timers back into it (clamped delays)
+    timer_wheel_link* first = head->next;
+    timer_wheel_link* last = head->prev;
+    head->prev = head->next = head;
+    last->next = nullptr;
+    while(first != nullptr){
+        node_type* node = static_cast<node_type*>(first);
+        first = first->next;
+        --level_size_[level];
+        link(node);
+    }
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+typename timer_wheel<T, LevelBits, Levels>::node_type* timer_wheel<T, LevelBits, Levels>::get_node(){
+    if(free_ != nullptr){
+        node_type* node = static_cast<node_type*>(free_);
+        free_ = free_->next;
+        return node;
+    }
+    return node_allocator::allocate();
+}
+
+template <typename T, std::size_t LevelBits, std::size_t Levels>
+void timer_wheel<T, LevelBits, Levels>::put_node(node_type* node) noexcept{
+    timer_wheel_link* link = node;
+    link->next = free_;
+    free_ = link;
+}
+
+} // namespace hstl
+
+#endif
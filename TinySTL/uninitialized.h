@@ -1,3 +1,6 @@
+#ifndef TINYSTL_UNINITIALIZED_H
+#define TINYSTL_UNINITIALIZED_H
+
 #include <iterator>
 #include <type_traits>
 #include <memory>
@@ -42,6 +45,14 @@ ForwardIterator uninitialized_fill_n(ForwardIterator first, Size n, const T& x){
     return __uninitialized_fill_n(first, n, x);
 }
 
+/**
+ *  uninitialized_fill
+ */
+template <typename ForwardIterator, typename T>
+void uninitialized_fill(ForwardIterator first, ForwardIterator last, const T& x){
+    hstl::uninitialized_fill_n(first, std::distance(first, last), x);
+}
+
 /**
  * uninitialized_copy
  */
@@ -121,4 +132,6 @@ ForwardIterator uninitialized_move(InputIterator first, InputIterator last, Forw
 
 
 
-}
\ No newline at end of file
+}
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef TINYSTL_WS_DEQUE_H
+#define TINYSTL_WS_DEQUE_H
+
+#include <cstddef>
+#include <atomic>
+#include <type_traits>
+#include "allocator.h"
+#include "vector.h"
+
+namespace hstl{
+
+#ifndef TINYSTL_CACHE_LINE_SIZE
+#define TINYSTL_CACHE_LINE_SIZE 64
+#endif
+
+// circular array of a ws_deque, indexed by the unwrapped bottom / top positions
+template <typename T>
+struct ws_deque_array{
+    typedef hstl::allocator<std::atomic<T>>             slot_allocator;
+
+    std::ptrdiff_t      capacity;
+    std::ptrdiff_t      mask;
+    std::atomic<T>*     slots;
+
+    explicit ws_deque_array(std::ptrdiff_t cap) : capacity(cap), mask(cap - 1), slots(slot_allocator::allocate(cap)){
+        for(std::ptrdiff_t i = 0; i < cap; ++i){
+            ::new(static_cast<void*>(slots + i)) std::atomic<T>();
+        }
+    }
+
+    ~ws_deque_array(){
+        slot_allocator::deallocate(slots, capacity);
+    }
+
+    ws_deque_array(const ws_deque_array&) = delete;
+    ws_deque_array& operator=(const ws_deque_array&) = delete;
+
+    T get(std::ptrdiff_t i) const noexcept { return slots[i & mask].load(std::memory_order_relaxed); }
+    void put(std::ptrdiff_t i, T value) noexcept { slots[i & mask].store(value, std::memory_order_relaxed); }
+};
+
+// Chase-Lev work-stealing deque (with the C11 memory orders of Le et al., PPoPP'13)
+//
+// the owner thread pushes and pops at the bottom without atomic read-modify-writes,
+// other threads steal from the top with a CAS; only the last element is contended.
+// T is copied in and out of the array while other threads may race on the slot, so it
+// must be trivially copyable, typically a pointer to a task
+//
+// the array grows when full; thieves may still be reading the old one, so it is
+// retired and only freed together with the deque
+template <typename T>
+class ws_deque{
+    static_assert(std::is_trivially_copyable<T>::value, "ws_deque elements must be trivially copyable");
+public:
+    typedef T                                           value_type;
+    typedef std::size_t                                 size_type;
+    typedef ws_deque_array<T>                           array_type;
+    typedef hstl::allocator<array_type>                 array_allocator;
+
+    static constexpr size_type cache_line_size = TINYSTL_CACHE_LINE_SIZE;
+
+private:
+    alignas(cache_line_size) std::atomic<std::ptrdiff_t> top_;
+    alignas(cache_line_size) std::atomic<std::ptrdiff_t> bottom_;
+    std::atomic<array_type*> array_;
+    hstl::vector<array_type*> retired_;    // owner only
+
+public:
+    // capacity is rounded up to a power of two
+    explicit ws_deque(size_type capacity = 64);
+    ~ws_deque();
+
+    ws_deque(const ws_deque&) = delete;
+    ws_deque& operator=(const ws_deque&) = delete;
+
+    size_type size_approx() const noexcept;
+    bool empty() const noexcept { return size_approx() == 0; }
+
+    // owner thread only
+    void push(T value);
+    bool pop(T& value);
+
+    // any thread; false if the deque was empty or another thread won the race
+    bool steal(T& value);
+
+private:
+    array_type* grow(array_type* old, std::ptrdiff_t bottom, std::ptrdiff_t top);
+};
+
+
+template <typename T>
+ws_deque<T>::ws_deque(size_type capacity) : top_(0), bottom_(0), array_(nullptr){
+    std::ptrdiff_t cap = 2;
+    while(cap < static_cast<std::ptrdiff_t>(capacity)){
+        cap <<= 1;
+    }
+    array_type* a = array_allocator::allocate();
+    try{
+        hstl::construct(a, cap);
+    }catch(...){
+        array_allocator::deallocate(a);
+        throw;
+    }
+    array_.store(a, std::memory_order_relaxed);
+}
+
+template <typename T>
+ws_deque<T>::~ws_deque(){
+    array_type* a = array_.load(std::memory_order_relaxed);
+    hstl::destroy(a);
+    array_allocator::deallocate(a);
+    for(auto it = retired_.begin(); it != retired_.end(); ++it){
+        hstl::destroy(*it);
+        array_allocator::deallocate(*it);
+    }
+}
+
+template <typename T>
+typename ws_deque<T>::size_type ws_deque<T>::size_approx() const noexcept{
+    const std::ptrdiff_t b = bottom_.load(std::memory_order_relaxed);
+    const std::ptrdiff_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_type>(b - t) : 0;
+}
+
+template <typename T>
+void ws_deque<T>::push(T value){
+    const std::ptrdiff_t b = bottom_.load(std::memory_order_relaxed);
+    const std::ptrdiff_t t = top_.load(std::memory_order_acquire);
+    array_type* a = array_.load(std::memory_order_relaxed);
+    if(b - t > a->capacity - 1){
+        a = grow(a, b, t);
+    }
+    a->put(b, value);
+    bottom_.store(b + 1, std::memory_order_release);
+}
+
+template <typename T>
+bool ws_deque<T>::pop(T& value){
+    const std::ptrdiff_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    array_type* a = array_.load(std::memory_order_relaxed);
+    // the reservation of slot b must be visible before top is read (store-load order)
+    bottom_.store(b, std::memory_order_seq_cst);
+    std::ptrdiff_t t = top_.load(std::memory_order_seq_cst);
+    if(t > b){
+        // empty
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+    value = a->get(b);
+    if(t == b){
+        // last element, race the thieves for it
+        const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+template <typename T>
+bool ws_deque<T>::steal(T& value){
+    std::ptrdiff_t t = top_.load(std::memory_order_seq_cst);
+    const std::ptrdiff_t b = bottom_.load(std::memory_order_seq_cst);
+    if(t >= b){
+        return false;
+    }
+    array_type* a = array_.load(std::memory_order_acquire);
+    T x = a->get(t);
+    if(!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+        return false;
+    }
+    value = x;
+    return true;
+}
+
+template <typename T>
+typename ws_deque<T>::array_type* ws_deque<T>::grow(array_type* old, std::ptrdiff_t bottom, std::ptrdiff_t top){
+    array_type* a = array_allocator::allocate();
+    try{
+        hstl::construct(a, old->capacity * 2);
+    }catch(...){
+        array_allocator::deallocate(a);
+        throw;
+    }
+    try{
+        retired_.push_back(old);
+    }catch(...){
+        hstl::destroy(a);
+        array_allocator::deallocate(a);
+        throw;
+    }
+    for(std::ptrdiff_t i = top; i < bottom; ++i){
+        a->put(i, old->get(i));
+    }
+    array_.store(a, std::memory_order_release);
+    return a;
+}
+
+} // namespace hstl
+
+#endif